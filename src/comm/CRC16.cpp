@@ -1,28 +1,339 @@
 #include "CRC16.h"
+#include <array>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define RCMS_CRC16_CLMUL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define RCMS_TARGET_CLMUL
+#else
+#define RCMS_TARGET_CLMUL __attribute__((target("pclmul,sse2")))
+#endif
+#elif defined(__aarch64__) && defined(__linux__) && !defined(_MSC_VER)
+#define RCMS_CRC16_CLMUL_ARM 1
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#define RCMS_TARGET_CLMUL __attribute__((target("+crypto")))
+#endif
 
 namespace rcms {
 
-uint16_t CRC16::calculate(const uint8_t* data, size_t length) {
-    uint16_t crc = INITIAL_VALUE;
+namespace {
+
+using CrcTables = std::array<std::array<uint16_t, 256>, 8>;
+
+/**
+ * @brief Build slicing tables at compile time
+ *
+ * tables[0] is the classic byte table; tables[k][b] is the CRC contribution
+ * of byte b followed by k zero bytes.
+ */
+constexpr CrcTables makeTables() {
+    CrcTables tables{};
+
+    for (uint16_t i = 0; i < 256; ++i) {
+        uint16_t crc = i;
+        for (int j = 0; j < 8; ++j) {
+            crc = (crc & 0x0001) ? static_cast<uint16_t>((crc >> 1) ^ CRC16::POLYNOMIAL)
+                                 : static_cast<uint16_t>(crc >> 1);
+        }
+        tables[0][i] = crc;
+    }
+
+    for (size_t k = 1; k < tables.size(); ++k) {
+        for (size_t i = 0; i < 256; ++i) {
+            uint16_t prev = tables[k - 1][i];
+            tables[k][i] = static_cast<uint16_t>((prev >> 8) ^ tables[0][prev & 0xFF]);
+        }
+    }
+
+    return tables;
+}
+
+constexpr CrcTables TABLES = makeTables();
+
+static_assert(TABLES[0][1] == 0xC0C1, "CRC-16/MODBUS table mismatch");
+static_assert(TABLES[0][255] == 0x4040, "CRC-16/MODBUS table mismatch");
 
+uint16_t updateBitwise(uint16_t crc, const uint8_t* data, size_t length) {
     for (size_t i = 0; i < length; i++) {
         crc ^= data[i];
         for (int j = 0; j < 8; j++) {
             if (crc & 0x0001) {
-                crc = (crc >> 1) ^ POLYNOMIAL;
+                crc = (crc >> 1) ^ CRC16::POLYNOMIAL;
             } else {
                 crc >>= 1;
             }
         }
     }
+    return crc;
+}
 
+inline uint16_t updateTable(uint16_t crc, const uint8_t* data, size_t length) {
+    const auto& t = TABLES[0];
+    for (size_t i = 0; i < length; ++i) {
+        crc = static_cast<uint16_t>((crc >> 8) ^ t[(crc ^ data[i]) & 0xFF]);
+    }
     return crc;
 }
 
+uint16_t updateSlice4(uint16_t crc, const uint8_t* data, size_t length) {
+    while (length >= 4) {
+        crc ^= static_cast<uint16_t>(data[0] | (data[1] << 8));
+        crc = TABLES[3][crc & 0xFF] ^ TABLES[2][crc >> 8] ^
+              TABLES[1][data[2]] ^ TABLES[0][data[3]];
+        data += 4;
+        length -= 4;
+    }
+    return updateTable(crc, data, length);
+}
+
+uint16_t updateSlice8(uint16_t crc, const uint8_t* data, size_t length) {
+    while (length >= 8) {
+        crc ^= static_cast<uint16_t>(data[0] | (data[1] << 8));
+        crc = TABLES[7][crc & 0xFF] ^ TABLES[6][crc >> 8] ^
+              TABLES[5][data[2]] ^ TABLES[4][data[3]] ^
+              TABLES[3][data[4]] ^ TABLES[2][data[5]] ^
+              TABLES[1][data[6]] ^ TABLES[0][data[7]];
+        data += 8;
+        length -= 8;
+    }
+    return updateTable(crc, data, length);
+}
+
+// ========== Carry-less multiply folding ==========
+//
+// The reflected message is folded 128 bits at a time: a lane with
+// polynomial H(x)*x^64 + L(x) is moved D bits forward as
+// H*(x^(D+64) mod P) + L*(x^D mod P), which stays below 80 bits and is
+// XORed into the lane D bits later. Reflected operands make PCLMULQDQ /
+// PMULL return the product multiplied by x, hence the x^(n-1) constants.
+// The last 128-bit remainder is finished with the slice-by-8 kernel.
+
+#if defined(RCMS_CRC16_CLMUL_X86) || defined(RCMS_CRC16_CLMUL_ARM)
+
+// x^n mod P(x), P = x^16 + x^15 + x^2 + 1 (normal bit order)
+constexpr uint16_t xPowModP(unsigned n) {
+    uint32_t r = 1;
+    for (unsigned i = 0; i < n; ++i) {
+        r <<= 1;
+        if (r & 0x10000) {
+            r ^= 0x18005;
+        }
+    }
+    return static_cast<uint16_t>(r);
+}
+
+// Bit-reflect a degree < 16 remainder into a 64-bit PCLMUL operand
+constexpr uint64_t reflect64(uint16_t value) {
+    uint64_t r = 0;
+    for (unsigned i = 0; i < 16; ++i) {
+        if (value & (1u << i)) {
+            r |= uint64_t(1) << (63 - i);
+        }
+    }
+    return r;
+}
+
+constexpr uint64_t K_FOLD1_HI = reflect64(xPowModP(128 + 64 - 1));
+constexpr uint64_t K_FOLD1_LO = reflect64(xPowModP(128 - 1));
+constexpr uint64_t K_FOLD4_HI = reflect64(xPowModP(512 + 64 - 1));
+constexpr uint64_t K_FOLD4_LO = reflect64(xPowModP(512 - 1));
+
+constexpr size_t CLMUL_MIN_LENGTH = 64;
+
+#endif
+
+#if defined(RCMS_CRC16_CLMUL_X86)
+
+RCMS_TARGET_CLMUL
+inline __m128i foldLane(__m128i lane, __m128i k, __m128i next) {
+    __m128i hi = _mm_clmulepi64_si128(lane, k, 0x00);
+    __m128i lo = _mm_clmulepi64_si128(lane, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+}
+
+RCMS_TARGET_CLMUL
+uint16_t updateClmul(uint16_t crc, const uint8_t* data, size_t length) {
+    if (length < CLMUL_MIN_LENGTH) {
+        return updateSlice8(crc, data, length);
+    }
+
+    auto load = [](const uint8_t* p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    };
+
+    const __m128i k4 = _mm_set_epi64x(static_cast<long long>(K_FOLD4_LO),
+                                      static_cast<long long>(K_FOLD4_HI));
+    const __m128i k1 = _mm_set_epi64x(static_cast<long long>(K_FOLD1_LO),
+                                      static_cast<long long>(K_FOLD1_HI));
+
+    __m128i x0 = _mm_xor_si128(load(data), _mm_cvtsi32_si128(crc));
+    __m128i x1 = load(data + 16);
+    __m128i x2 = load(data + 32);
+    __m128i x3 = load(data + 48);
+    data += 64;
+    length -= 64;
+
+    while (length >= 64) {
+        x0 = foldLane(x0, k4, load(data));
+        x1 = foldLane(x1, k4, load(data + 16));
+        x2 = foldLane(x2, k4, load(data + 32));
+        x3 = foldLane(x3, k4, load(data + 48));
+        data += 64;
+        length -= 64;
+    }
+
+    __m128i x = foldLane(x0, k1, x1);
+    x = foldLane(x, k1, x2);
+    x = foldLane(x, k1, x3);
+
+    while (length >= 16) {
+        x = foldLane(x, k1, load(data));
+        data += 16;
+        length -= 16;
+    }
+
+    alignas(16) uint8_t remainder[16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(remainder), x);
+    crc = updateSlice8(0, remainder, sizeof(remainder));
+    return updateSlice8(crc, data, length);
+}
+
+bool clmulSupported() {
+#if defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid(info, 1);
+    return (info[2] & (1 << 1)) != 0;   // ECX bit 1: PCLMULQDQ
+#else
+    return __builtin_cpu_supports("pclmul");
+#endif
+}
+
+#elif defined(RCMS_CRC16_CLMUL_ARM)
+
+RCMS_TARGET_CLMUL
+inline uint64x2_t foldLane(uint64x2_t lane, uint64x2_t k, uint64x2_t next) {
+    uint64x2_t hi = vreinterpretq_u64_p128(
+        vmull_p64(static_cast<poly64_t>(vgetq_lane_u64(lane, 0)),
+                  static_cast<poly64_t>(vgetq_lane_u64(k, 0))));
+    uint64x2_t lo = vreinterpretq_u64_p128(
+        vmull_p64(static_cast<poly64_t>(vgetq_lane_u64(lane, 1)),
+                  static_cast<poly64_t>(vgetq_lane_u64(k, 1))));
+    return veorq_u64(veorq_u64(hi, lo), next);
+}
+
+RCMS_TARGET_CLMUL
+uint16_t updateClmul(uint16_t crc, const uint8_t* data, size_t length) {
+    if (length < CLMUL_MIN_LENGTH) {
+        return updateSlice8(crc, data, length);
+    }
+
+    auto load = [](const uint8_t* p) {
+        return vreinterpretq_u64_u8(vld1q_u8(p));
+    };
+
+    const uint64x2_t k4 = vcombine_u64(vcreate_u64(K_FOLD4_HI), vcreate_u64(K_FOLD4_LO));
+    const uint64x2_t k1 = vcombine_u64(vcreate_u64(K_FOLD1_HI), vcreate_u64(K_FOLD1_LO));
+
+    uint64x2_t x0 = veorq_u64(load(data), vcombine_u64(vcreate_u64(crc), vcreate_u64(0)));
+    uint64x2_t x1 = load(data + 16);
+    uint64x2_t x2 = load(data + 32);
+    uint64x2_t x3 = load(data + 48);
+    data += 64;
+    length -= 64;
+
+    while (length >= 64) {
+        x0 = foldLane(x0, k4, load(data));
+        x1 = foldLane(x1, k4, load(data + 16));
+        x2 = foldLane(x2, k4, load(data + 32));
+        x3 = foldLane(x3, k4, load(data + 48));
+        data += 64;
+        length -= 64;
+    }
+
+    uint64x2_t x = foldLane(x0, k1, x1);
+    x = foldLane(x, k1, x2);
+    x = foldLane(x, k1, x3);
+
+    while (length >= 16) {
+        x = foldLane(x, k1, load(data));
+        data += 16;
+        length -= 16;
+    }
+
+    uint8_t remainder[16];
+    vst1q_u8(remainder, vreinterpretq_u8_u64(x));
+    crc = updateSlice8(0, remainder, sizeof(remainder));
+    return updateSlice8(crc, data, length);
+}
+
+bool clmulSupported() {
+    return (getauxval(AT_HWCAP) & HWCAP_PMULL) != 0;
+}
+
+#else
+
+uint16_t updateClmul(uint16_t crc, const uint8_t* data, size_t length) {
+    return updateSlice8(crc, data, length);
+}
+
+bool clmulSupported() {
+    return false;
+}
+
+#endif
+
+using UpdateFn = uint16_t (*)(uint16_t, const uint8_t*, size_t);
+
+UpdateFn kernelFunction(CRC16::Kernel kernel) {
+    switch (kernel) {
+        case CRC16::Kernel::Bitwise: return updateBitwise;
+        case CRC16::Kernel::Table: return updateTable;
+        case CRC16::Kernel::Slice4: return updateSlice4;
+        case CRC16::Kernel::Slice8: return updateSlice8;
+        case CRC16::Kernel::Clmul: return clmulSupported() ? updateClmul : updateSlice8;
+    }
+    return updateBitwise;
+}
+
+uint16_t resolveAndUpdate(uint16_t crc, const uint8_t* data, size_t length);
+
+// Constant-initialized so CRC16 is usable from other static initializers;
+// the first call picks the best kernel for this machine.
+std::atomic<CRC16::Kernel> g_kernel{CRC16::Kernel::Bitwise};
+std::atomic<UpdateFn> g_update{resolveAndUpdate};
+
+uint16_t resolveAndUpdate(uint16_t crc, const uint8_t* data, size_t length) {
+    CRC16::setKernel(CRC16::bestKernel());
+    return g_update.load(std::memory_order_relaxed)(crc, data, length);
+}
+
+} // anonymous namespace
+
+uint16_t CRC16::calculate(const uint8_t* data, size_t length) {
+    return update(INITIAL_VALUE, data, length);
+}
+
 uint16_t CRC16::calculate(const std::vector<uint8_t>& data) {
     return calculate(data.data(), data.size());
 }
 
+uint16_t CRC16::calculate(Kernel kernel, const uint8_t* data, size_t length) {
+    return kernelFunction(kernel)(INITIAL_VALUE, data, length);
+}
+
+uint16_t CRC16::calculateBitwise(const uint8_t* data, size_t length) {
+    return updateBitwise(INITIAL_VALUE, data, length);
+}
+
+uint16_t CRC16::update(uint16_t state, const uint8_t* data, size_t length) {
+    return g_update.load(std::memory_order_relaxed)(state, data, length);
+}
+
 bool CRC16::verify(const uint8_t* data, size_t length) {
     if (length < 3) {
         return false; // Minimum: 1 byte data + 2 bytes CRC
@@ -46,4 +357,38 @@ void CRC16::append(std::vector<uint8_t>& data) {
     data.push_back(static_cast<uint8_t>((crc >> 8) & 0xFF)); // High byte
 }
 
+void CRC16::setKernel(Kernel kernel) {
+    if (!isSupported(kernel)) {
+        kernel = Kernel::Slice8;
+    }
+    g_kernel.store(kernel, std::memory_order_relaxed);
+    g_update.store(kernelFunction(kernel), std::memory_order_relaxed);
+}
+
+CRC16::Kernel CRC16::activeKernel() {
+    if (g_update.load(std::memory_order_relaxed) == resolveAndUpdate) {
+        setKernel(bestKernel());
+    }
+    return g_kernel.load(std::memory_order_relaxed);
+}
+
+CRC16::Kernel CRC16::bestKernel() {
+    return clmulSupported() ? Kernel::Clmul : Kernel::Slice8;
+}
+
+bool CRC16::isSupported(Kernel kernel) {
+    return kernel != Kernel::Clmul || clmulSupported();
+}
+
+const char* CRC16::kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Bitwise: return "bitwise";
+        case Kernel::Table: return "table";
+        case Kernel::Slice4: return "slice4";
+        case Kernel::Slice8: return "slice8";
+        case Kernel::Clmul: return "clmul";
+    }
+    return "unknown";
+}
+
 } // namespace rcms
@@ -12,9 +12,31 @@ namespace rcms {
  * Polynomial: 0x8005 (reflected: 0xA001)
  * Initial value: 0xFFFF
  * Result: Little Endian in Modbus packets
+ *
+ * Several interchangeable kernels are provided. The bitwise loop is the
+ * reference implementation; the table-driven kernels use 256-entry tables
+ * generated at compile time; the carry-less multiply kernel folds 64-byte
+ * blocks with PCLMULQDQ (x86-64) or PMULL (AArch64) when the CPU has it.
+ * calculate() dispatches to the kernel selected at runtime (the fastest
+ * supported one by default). With Clmul selected, buffers shorter than one
+ * 64-byte fold block go straight to slice-by-8.
  */
 class CRC16 {
 public:
+    static constexpr uint16_t POLYNOMIAL = 0xA001;
+    static constexpr uint16_t INITIAL_VALUE = 0xFFFF;
+
+    /**
+     * @brief CRC computation kernel
+     */
+    enum class Kernel {
+        Bitwise,    // Reference: 8 shift/xor steps per byte
+        Table,      // One 256-entry table lookup per byte
+        Slice4,     // Slice-by-4: 4 bytes per iteration
+        Slice8,     // Slice-by-8: 8 bytes per iteration
+        Clmul       // Carry-less multiply folding (PCLMULQDQ / PMULL)
+    };
+
     /**
      * @brief Calculate CRC-16 Modbus checksum
      * @param data Pointer to data buffer
@@ -30,6 +52,32 @@ public:
      */
     static uint16_t calculate(const std::vector<uint8_t>& data);
 
+    /**
+     * @brief Calculate CRC-16 with an explicit kernel (tests, benchmarks)
+     */
+    static uint16_t calculate(Kernel kernel, const uint8_t* data, size_t length);
+
+    /**
+     * @brief Reference bit-at-a-time implementation
+     */
+    static uint16_t calculateBitwise(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Feed a chunk into a running CRC
+     *
+     * Start with INITIAL_VALUE; the state after the last chunk is the CRC
+     * of the concatenated data:
+     *   uint16_t crc = CRC16::INITIAL_VALUE;
+     *   crc = CRC16::update(crc, part1, len1);
+     *   crc = CRC16::update(crc, part2, len2);
+     *
+     * @param state Running CRC (INITIAL_VALUE for the first chunk)
+     * @param data Chunk of bytes
+     * @param length Chunk length
+     * @return Updated CRC state
+     */
+    static uint16_t update(uint16_t state, const uint8_t* data, size_t length);
+
     /**
      * @brief Verify CRC-16 in Modbus packet
      * @param data Pointer to data buffer (including CRC at end)
@@ -44,9 +92,35 @@ public:
      */
     static void append(std::vector<uint8_t>& data);
 
-private:
-    static constexpr uint16_t POLYNOMIAL = 0xA001;
-    static constexpr uint16_t INITIAL_VALUE = 0xFFFF;
+    // ========== Kernel selection ==========
+
+    /**
+     * @brief Select the kernel used by calculate()/update()/verify()
+     */
+    static void setKernel(Kernel kernel);
+
+    /**
+     * @brief Currently selected kernel
+     */
+    static Kernel activeKernel();
+
+    /**
+     * @brief Fastest kernel supported on this machine
+     */
+    static Kernel bestKernel();
+
+    /**
+     * @brief Check whether a kernel can run on this CPU
+     *
+     * Unsupported kernels passed to calculate(Kernel, ...) or setKernel()
+     * fall back to Slice8.
+     */
+    static bool isSupported(Kernel kernel);
+
+    /**
+     * @brief Kernel name for logs and benchmark output
+     */
+    static const char* kernelName(Kernel kernel);
 };
 
 } // namespace rcms
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QByteArray>
+#include <QIODevice>
 #include <QString>
 #include <cstdint>
 
@@ -51,6 +52,12 @@ public:
      */
     virtual void flush() = 0;
 
+    /**
+     * @brief Underlying I/O device for event-driven (readyRead) access
+     * @return Serial port or socket, owned by the transport
+     */
+    virtual QIODevice* device() = 0;
+
     /**
      * @brief Get last error message
      */
@@ -30,6 +30,7 @@ public:
     qint64 write(const QByteArray& data) override;
     QByteArray read(int maxSize, int timeoutMs = 1000) override;
     void flush() override;
+    QIODevice* device() override { return m_socket.get(); }
 
     QString lastError() const override { return m_lastError; }
     QString transportType() const override { return "TCP-Serial"; }
@@ -0,0 +1,390 @@
+#include "AlarmJournal.h"
+#include <sqlite3.h>
+#include <chrono>
+#include <iterator>
+
+namespace rcms {
+
+namespace {
+const char* const SCHEMA =
+    "CREATE TABLE IF NOT EXISTS alarms ("
+    "  id INTEGER PRIMARY KEY,"
+    "  raised_ms INTEGER NOT NULL,"
+    "  device TEXT NOT NULL,"
+    "  group_id TEXT NOT NULL,"
+    "  address INTEGER NOT NULL,"
+    "  code INTEGER NOT NULL,"
+    "  severity INTEGER NOT NULL,"
+    "  ack_ms INTEGER,"
+    "  cleared_ms INTEGER"
+    ");"
+    // Outstanding alarms are few; keep only them in the index
+    "CREATE INDEX IF NOT EXISTS alarms_outstanding ON alarms(id)"
+    "  WHERE ack_ms IS NULL OR cleared_ms IS NULL;";
+
+const char* const SELECT_OUTSTANDING =
+    "SELECT id, raised_ms, ack_ms, cleared_ms, device, group_id, code, address, severity"
+    "  FROM alarms WHERE ack_ms IS NULL OR cleared_ms IS NULL ORDER BY id";
+
+std::string columnText(sqlite3_stmt* stmt, int column) {
+    const unsigned char* text = sqlite3_column_text(stmt, column);
+    return text ? std::string(reinterpret_cast<const char*>(text)) : std::string();
+}
+}
+
+AlarmJournal::AlarmJournal() = default;
+
+AlarmJournal::~AlarmJournal() {
+    close();
+}
+
+bool AlarmJournal::open(const std::string& path) {
+    close();
+
+    if (sqlite3_open(path.c_str(), &m_db) != SQLITE_OK) {
+        setError("open: " + std::string(sqlite3_errmsg(m_db)));
+        sqlite3_close(m_db);
+        m_db = nullptr;
+        return false;
+    }
+
+    // WAL: readers don't block the writer; NORMAL sync is durable across
+    // application crashes, which is what NF-012 asks for
+    if (!exec("PRAGMA journal_mode=WAL;") || !exec("PRAGMA synchronous=NORMAL;") ||
+        !exec(SCHEMA)) {
+        sqlite3_close(m_db);
+        m_db = nullptr;
+        return false;
+    }
+
+    bool prepared =
+        sqlite3_prepare_v2(m_db,
+                           "INSERT OR REPLACE INTO alarms"
+                           " (id, raised_ms, device, group_id, address, code, severity)"
+                           " VALUES (?, ?, ?, ?, ?, ?, ?)", -1, &m_insert, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_db, "UPDATE alarms SET ack_ms = ? WHERE id = ?",
+                           -1, &m_ack, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_db, "UPDATE alarms SET cleared_ms = ? WHERE id = ?",
+                           -1, &m_clear, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_db,
+                           "UPDATE alarms SET ack_ms = COALESCE(ack_ms, ?1),"
+                           " cleared_ms = COALESCE(cleared_ms, ?1)"
+                           " WHERE ack_ms IS NULL OR cleared_ms IS NULL",
+                           -1, &m_clearAll, nullptr) == SQLITE_OK;
+    if (!prepared) {
+        setError("prepare: " + std::string(sqlite3_errmsg(m_db)));
+        sqlite3_finalize(m_insert);
+        sqlite3_finalize(m_ack);
+        sqlite3_finalize(m_clear);
+        sqlite3_finalize(m_clearAll);
+        m_insert = m_ack = m_clear = m_clearAll = nullptr;
+        sqlite3_close(m_db);
+        m_db = nullptr;
+        return false;
+    }
+
+    m_path = path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = false;
+        m_enqueued = m_written = m_dropped = m_writeFailures = 0;
+    }
+    m_writer = std::thread(&AlarmJournal::writerLoop, this);
+    return true;
+}
+
+void AlarmJournal::close() {
+    if (m_writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_writer.join();
+    }
+
+    if (m_db) {
+        sqlite3_finalize(m_insert);
+        sqlite3_finalize(m_ack);
+        sqlite3_finalize(m_clear);
+        sqlite3_finalize(m_clearAll);
+        m_insert = m_ack = m_clear = m_clearAll = nullptr;
+        sqlite3_close(m_db);
+        m_db = nullptr;
+    }
+}
+
+std::string AlarmJournal::lastError() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastError;
+}
+
+uint64_t AlarmJournal::writeFailures() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_writeFailures;
+}
+
+uint64_t AlarmJournal::entriesDropped() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dropped;
+}
+
+void AlarmJournal::setError(const std::string& what) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastError = what;
+}
+
+bool AlarmJournal::exec(const char* sql) {
+    char* message = nullptr;
+    if (sqlite3_exec(m_db, sql, nullptr, nullptr, &message) != SQLITE_OK) {
+        setError(message ? message : "sqlite3_exec failed");
+        sqlite3_free(message);
+        return false;
+    }
+    return true;
+}
+
+void AlarmJournal::recordRaised(const Record& record) {
+    enqueue(Op{OpKind::Raise, record});
+}
+
+void AlarmJournal::recordAcknowledged(uint64_t id, int64_t atMs) {
+    Op op{OpKind::Acknowledge, Record()};
+    op.record.id = id;
+    op.record.ackMs = atMs;
+    enqueue(std::move(op));
+}
+
+void AlarmJournal::recordCleared(uint64_t id, int64_t atMs) {
+    Op op{OpKind::Clear, Record()};
+    op.record.id = id;
+    op.record.clearedMs = atMs;
+    enqueue(std::move(op));
+}
+
+void AlarmJournal::recordClearedAll(int64_t atMs) {
+    Op op{OpKind::ClearAll, Record()};
+    op.record.ackMs = atMs;
+    op.record.clearedMs = atMs;
+    enqueue(std::move(op));
+}
+
+void AlarmJournal::enqueue(Op op) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_writer.joinable() || m_stop) {
+            return; // Not open: nothing to persist to
+        }
+        m_queue.push_back(std::move(op));
+        ++m_enqueued;
+    }
+    m_wake.notify_one();
+}
+
+void AlarmJournal::flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_writer.joinable()) {
+        return;
+    }
+    const uint64_t target = m_enqueued;
+    const uint64_t failures = m_writeFailures;
+    ++m_flushWaiters;
+    m_wake.notify_one();
+    m_drained.wait(lock, [this, target, failures]() {
+        return m_written + m_dropped >= target || m_writeFailures != failures || m_stop;
+    });
+    --m_flushWaiters;
+}
+
+void AlarmJournal::writerLoop() {
+    std::vector<Op> batch;
+
+    // After a failed write the next attempt waits RETRY_DELAY_MS
+    bool retrying = false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        if (retrying) {
+            m_wake.wait_for(lock, std::chrono::milliseconds(RETRY_DELAY_MS),
+                            [this]() { return m_stop; });
+        } else {
+            m_wake.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+        }
+
+        // Give a burst (e.g. one fault on many radios) time to pile up,
+        // unless someone is waiting for it
+        if (!retrying && !m_stop && m_flushWaiters == 0) {
+            const uint64_t target = m_enqueued;
+            m_wake.wait_for(lock, std::chrono::milliseconds(BATCH_WINDOW_MS),
+                            [this, target]() {
+                return m_stop || m_flushWaiters > 0 || m_enqueued - target >= MAX_BATCH;
+            });
+        }
+
+        batch.clear();
+        batch.swap(m_queue);
+        const bool stop = m_stop;
+        if (batch.empty() && stop) {
+            break;
+        }
+
+        lock.unlock();
+        const bool ok = writeBatch(batch);
+        lock.lock();
+
+        if (ok) {
+            m_written += batch.size();
+        } else {
+            ++m_writeFailures;
+            if (stop) {
+                m_dropped += batch.size();  // Last attempt before closing
+            } else {
+                retainFailed(batch);
+            }
+        }
+        retrying = !ok;
+        m_drained.notify_all();
+
+        if (stop && m_queue.empty()) {
+            break;
+        }
+    }
+}
+
+void AlarmJournal::retainFailed(std::vector<Op>& batch) {
+    // Failed ops go back ahead of anything queued during the attempt, so
+    // transitions of one alarm stay in order
+    batch.insert(batch.end(), std::make_move_iterator(m_queue.begin()),
+                 std::make_move_iterator(m_queue.end()));
+    batch.swap(m_queue);
+    batch.clear();
+
+    if (m_queue.size() > MAX_RETAINED) {
+        const size_t excess = m_queue.size() - MAX_RETAINED;
+        m_queue.erase(m_queue.begin(), m_queue.begin() + static_cast<std::ptrdiff_t>(excess));
+        m_dropped += excess;
+    }
+}
+
+bool AlarmJournal::writeBatch(const std::vector<Op>& batch) {
+    if (batch.empty()) {
+        return true;
+    }
+
+    if (!exec("BEGIN")) {
+        return false;
+    }
+
+    for (const Op& op : batch) {
+        const Record& r = op.record;
+        sqlite3_stmt* stmt = nullptr;
+
+        switch (op.kind) {
+        case OpKind::Raise:
+            stmt = m_insert;
+            sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(r.id));
+            sqlite3_bind_int64(stmt, 2, r.raisedMs);
+            sqlite3_bind_text(stmt, 3, r.deviceName.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 4, r.groupId.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(stmt, 5, r.deviceAddress);
+            sqlite3_bind_int(stmt, 6, r.code);
+            sqlite3_bind_int(stmt, 7, r.severity);
+            break;
+        case OpKind::Acknowledge:
+            stmt = m_ack;
+            sqlite3_bind_int64(stmt, 1, r.ackMs);
+            sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(r.id));
+            break;
+        case OpKind::Clear:
+            stmt = m_clear;
+            sqlite3_bind_int64(stmt, 1, r.clearedMs);
+            sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(r.id));
+            break;
+        case OpKind::ClearAll:
+            stmt = m_clearAll;
+            sqlite3_bind_int64(stmt, 1, r.clearedMs);
+            break;
+        }
+
+        const bool stepped = sqlite3_step(stmt) == SQLITE_DONE;
+        if (!stepped) {
+            setError("write: " + std::string(sqlite3_errmsg(m_db)));
+        }
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+
+        // All or nothing: a half-written batch would lose the failed
+        // transitions for good
+        if (!stepped) {
+            exec("ROLLBACK");
+            return false;
+        }
+    }
+
+    if (!exec("COMMIT")) {
+        exec("ROLLBACK");
+        return false;
+    }
+    return true;
+}
+
+sqlite3* AlarmJournal::openReader() const {
+    sqlite3* db = nullptr;
+    if (m_path.empty() ||
+        sqlite3_open_v2(m_path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        sqlite3_close(db);
+        return nullptr;
+    }
+    return db;
+}
+
+std::vector<AlarmJournal::Record> AlarmJournal::loadOutstanding() const {
+    std::vector<Record> records;
+
+    sqlite3* db = openReader();
+    if (!db) {
+        return records;
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, SELECT_OUTSTANDING, -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            Record r;
+            r.id = static_cast<uint64_t>(sqlite3_column_int64(stmt, 0));
+            r.raisedMs = sqlite3_column_int64(stmt, 1);
+            r.ackMs = sqlite3_column_int64(stmt, 2);        // NULL reads as 0
+            r.clearedMs = sqlite3_column_int64(stmt, 3);
+            r.deviceName = columnText(stmt, 4);
+            r.groupId = columnText(stmt, 5);
+            r.code = static_cast<uint16_t>(sqlite3_column_int(stmt, 6));
+            r.deviceAddress = static_cast<uint8_t>(sqlite3_column_int(stmt, 7));
+            r.severity = static_cast<uint8_t>(sqlite3_column_int(stmt, 8));
+            records.push_back(std::move(r));
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return records;
+}
+
+uint64_t AlarmJournal::maxId() const {
+    uint64_t id = 0;
+
+    sqlite3* db = openReader();
+    if (!db) {
+        return id;
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT MAX(id) FROM alarms", -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        id = static_cast<uint64_t>(sqlite3_column_int64(stmt, 0));
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return id;
+}
+
+} // namespace rcms
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace rcms {
+
+/**
+ * @brief Persistent alarm journal (SQLite, WAL)
+ *
+ * Records raise, acknowledge and clear transitions so that alarms survive
+ * a restart (NF-012). Callers only append to an in-memory queue; a writer
+ * thread drains it in batches, one transaction per batch, through
+ * prepared statements. The database runs in WAL mode, so startup reads on
+ * a separate connection never wait for the writer.
+ *
+ * A batch is all or nothing: when any statement fails the transaction is
+ * rolled back and the batch goes back to the front of the queue, to be
+ * retried after RETRY_DELAY_MS. At most MAX_RETAINED entries are kept
+ * while writes fail; beyond that the oldest are dropped and counted.
+ *
+ * Thread-safe: record*() may be called from any thread.
+ */
+class AlarmJournal {
+public:
+    /**
+     * @brief One journalled alarm
+     */
+    struct Record {
+        uint64_t id = 0;
+        int64_t raisedMs = 0;           // Epoch ms
+        int64_t ackMs = 0;              // 0 = not acknowledged
+        int64_t clearedMs = 0;          // 0 = still active
+        std::string deviceName;         // UTF-8
+        std::string groupId;
+        uint16_t code = 0;
+        uint8_t deviceAddress = 0;
+        uint8_t severity = 0;
+
+        bool acknowledged() const { return ackMs != 0; }
+        bool active() const { return clearedMs == 0; }
+    };
+
+    // Writer waits this long after the first queued entry to batch more
+    static constexpr int BATCH_WINDOW_MS = 50;
+    static constexpr uint64_t MAX_BATCH = 512;
+    static constexpr int RETRY_DELAY_MS = 1000;
+    static constexpr size_t MAX_RETAINED = 65536;
+
+    AlarmJournal();
+    ~AlarmJournal();
+
+    AlarmJournal(const AlarmJournal&) = delete;
+    AlarmJournal& operator=(const AlarmJournal&) = delete;
+
+    /**
+     * @brief Open (create) the database and start the writer thread
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Write out everything queued and stop the writer
+     */
+    void close();
+
+    bool isOpen() const { return m_db != nullptr; }
+    std::string lastError() const;
+
+    // ========== Transitions (non-blocking) ==========
+
+    void recordRaised(const Record& record);
+    void recordAcknowledged(uint64_t id, int64_t atMs);
+    void recordCleared(uint64_t id, int64_t atMs);
+
+    /**
+     * @brief Every alarm journalled so far acknowledged and cleared
+     *
+     * The operator cleared the event log: nothing recorded before this
+     * call is reloaded as outstanding.
+     */
+    void recordClearedAll(int64_t atMs);
+
+    /**
+     * @brief Block until everything queued so far is committed or
+     *        dropped, or a write attempt fails
+     */
+    void flush();
+
+    // ========== Startup reads ==========
+
+    /**
+     * @brief Alarms still active or not yet acknowledged, oldest first
+     *
+     * Served by a partial index, so the cost follows the number of
+     * outstanding alarms rather than the journal size.
+     */
+    std::vector<Record> loadOutstanding() const;
+
+    /**
+     * @brief Highest journalled id (0 if empty); new ids continue after it
+     */
+    uint64_t maxId() const;
+
+    /**
+     * @brief Failed batch transactions since open()
+     */
+    uint64_t writeFailures() const;
+
+    /**
+     * @brief Entries given up on since open(): beyond MAX_RETAINED, or
+     *        still failing when closed
+     */
+    uint64_t entriesDropped() const;
+
+private:
+    enum class OpKind : uint8_t {
+        Raise,
+        Acknowledge,
+        Clear,
+        ClearAll
+    };
+
+    struct Op {
+        OpKind kind;
+        Record record;      // Raise: full record; otherwise id and time only
+    };
+
+    void enqueue(Op op);
+    void writerLoop();
+    void retainFailed(std::vector<Op>& batch);
+    bool writeBatch(const std::vector<Op>& batch);
+    bool exec(const char* sql);
+    void setError(const std::string& what);
+    sqlite3* openReader() const;
+
+    std::string m_path;
+    sqlite3* m_db = nullptr;            // Owned by the writer thread once started
+    sqlite3_stmt* m_insert = nullptr;
+    sqlite3_stmt* m_ack = nullptr;
+    sqlite3_stmt* m_clear = nullptr;
+    sqlite3_stmt* m_clearAll = nullptr;
+
+    std::thread m_writer;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_drained;
+    std::vector<Op> m_queue;
+    uint64_t m_enqueued = 0;            // Ops queued since open
+    uint64_t m_written = 0;             // Ops committed
+    uint64_t m_dropped = 0;             // Ops given up on
+    uint64_t m_writeFailures = 0;       // Failed transactions
+    int m_flushWaiters = 0;
+    bool m_stop = false;
+    std::string m_lastError;
+};
+
+} // namespace rcms
@@ -1,11 +1,36 @@
 #include "AlarmManager.h"
 #include "Logger.h"
+#include "protocol/AlarmCatalog.h"
 #include <QUuid>
+#include <algorithm>
 
 namespace rcms {
 
+namespace {
+// UUIDv5 namespace of exported alarm ids; never change it, or external
+// systems see every alarm as new
+const QUuid ALARM_EXPORT_NAMESPACE(0xf5ee803d, 0x4970, 0x482a,
+                                   0x8a, 0x5a, 0xe6, 0x35, 0xf2, 0xbc, 0x87, 0x76);
+
+// Remove an event from a per-key index, dropping the key once its set is
+// empty so the hashes stay as small as the outstanding alarms
+template <typename Index, typename Key, typename Seq>
+void removeFromIndex(Index& index, const Key& key, Seq seq) {
+    auto it = index.find(key);
+    if (it == index.end()) {
+        return;
+    }
+    it->remove(seq);
+    if (it->isEmpty()) {
+        index.erase(it);
+    }
+}
+}
+
 AlarmManager::AlarmManager(QObject* parent)
     : QObject(parent)
+    , m_ring(DEFAULT_CAPACITY)
+    , m_idOffset(static_cast<uint64_t>(QDateTime::currentMSecsSinceEpoch()) << 20)
     , m_repeatTimer(new QTimer(this))
 {
     connect(m_repeatTimer, &QTimer::timeout, this, &AlarmManager::onRepeatTimer);
@@ -15,28 +40,231 @@ AlarmManager::~AlarmManager() {
     stopSound();
 }
 
-QString AlarmManager::generateAlarmId() const {
-    return QUuid::createUuid().toString(QUuid::WithoutBraces);
+void AlarmManager::setCapacity(int capacity) {
+    capacity = qMax(1, capacity);
+    if (capacity == this->capacity()) {
+        return;
+    }
+
+    // Keep the newest events; sequence numbers (and ids) don't change
+    const Seq first = qMax(m_firstSeq, m_nextSeq > static_cast<Seq>(capacity)
+                                           ? m_nextSeq - static_cast<Seq>(capacity) : 0);
+    for (Seq seq = m_firstSeq; seq < first; ++seq) {
+        forgetId(seq);
+    }
+    std::vector<AlarmRecord> ring(capacity);
+    for (Seq seq = first; seq < m_nextSeq; ++seq) {
+        ring[seq % ring.size()] = slot(seq);
+    }
+
+    m_ring = std::move(ring);
+    m_firstSeq = first;
+
+    resetIndexes();
+    for (Seq seq = m_firstSeq; seq < m_nextSeq; ++seq) {
+        indexEvent(seq);
+    }
+}
+
+bool AlarmManager::seqOf(uint64_t alarmId, Seq& seq) const {
+    if (alarmId == 0) {
+        return false;
+    }
+
+    auto restored = m_restoredIds.constFind(alarmId);
+    if (restored != m_restoredIds.constEnd()) {
+        seq = *restored;
+        return true;
+    }
+
+    seq = alarmId - m_idOffset;
+    return seq >= m_firstSeq && seq < m_nextSeq && slot(seq).id == alarmId;
+}
+
+void AlarmManager::forgetId(Seq seq) {
+    if (!m_restoredIds.isEmpty()) {
+        m_restoredIds.remove(slot(seq).id);
+    }
+}
+
+void AlarmManager::attachJournal(AlarmJournal* journal) {
+    m_journal = journal;
+    if (!m_journal || !m_journal->isOpen()) {
+        return;
+    }
+
+    const auto records = m_journal->loadOutstanding();
+    for (const AlarmJournal::Record& r : records) {
+        if (m_nextSeq - m_firstSeq >= m_ring.size()) {
+            break; // More outstanding than capacity: keep the oldest
+        }
+
+        const Seq seq = m_nextSeq++;
+        AlarmRecord& record = slot(seq);
+        record = AlarmRecord();
+        record.id = r.id;
+        record.timestampMs = r.raisedMs;
+        record.ackTimestampMs = r.ackMs;
+        record.deviceName = m_strings.intern(QString::fromStdString(r.deviceName));
+        record.groupId = m_strings.intern(QString::fromStdString(r.groupId));
+        record.code = r.code;
+        record.deviceAddress = r.deviceAddress;
+        record.severity = static_cast<AlarmSeverity>(r.severity);
+        record.acknowledged = r.acknowledged();
+        record.isActive = r.active();
+        indexEvent(seq);
+
+        m_restoredIds.insert(record.id, seq);
+        emit alarmAdded(expand(record));
+    }
+
+    // Next new alarm gets maxId + 1
+    m_idOffset = m_journal->maxId() + 1 - m_nextSeq;
+
+    Logger::info("Restored {} outstanding alarms from journal", records.size());
+    emit unacknowledgedCountChanged(m_unackedCount);
+    updateRepeatTimer();
+}
+
+void AlarmManager::indexEvent(Seq seq) {
+    const AlarmRecord& record = slot(seq);
+
+    if (!record.acknowledged) {
+        ++m_unackedCount;
+        m_unackedByDevice[record.deviceAddress].insert(seq);
+        m_unackedByGroup[record.groupId].insert(seq);
+    }
+    if (record.isActive) {
+        m_active.insert(seq);
+        m_activeByDevice[record.deviceAddress].insert(seq);
+        m_activeByCode[codeKey(record.deviceAddress, record.code)].insert(seq);
+        if (!record.acknowledged) {
+            ++m_activeUnackedCount;
+        }
+    }
+}
+
+void AlarmManager::unindexEvent(Seq seq) {
+    const AlarmRecord& record = slot(seq);
+
+    // Leaves the event acknowledged and inactive as far as indexes go
+    if (!record.acknowledged) {
+        --m_unackedCount;
+        removeFromIndex(m_unackedByDevice, record.deviceAddress, seq);
+        removeFromIndex(m_unackedByGroup, record.groupId, seq);
+    }
+    if (record.isActive) {
+        m_active.remove(seq);
+        removeFromIndex(m_activeByDevice, record.deviceAddress, seq);
+        removeFromIndex(m_activeByCode, codeKey(record.deviceAddress, record.code), seq);
+        if (!record.acknowledged) {
+            --m_activeUnackedCount;
+        }
+    }
+}
+
+void AlarmManager::markAcknowledged(Seq seq) {
+    AlarmRecord& record = slot(seq);
+    if (record.acknowledged) {
+        return;
+    }
+
+    record.acknowledged = true;
+    record.ackTimestampMs = QDateTime::currentMSecsSinceEpoch();
+    if (m_journal) {
+        m_journal->recordAcknowledged(record.id, record.ackTimestampMs);
+    }
+
+    --m_unackedCount;
+    removeFromIndex(m_unackedByDevice, record.deviceAddress, seq);
+    removeFromIndex(m_unackedByGroup, record.groupId, seq);
+    if (record.isActive) {
+        --m_activeUnackedCount;
+    }
+
+    emit alarmAcknowledged(positionOf(seq));
+}
+
+void AlarmManager::markCleared(Seq seq) {
+    AlarmRecord& record = slot(seq);
+    if (!record.isActive) {
+        return;
+    }
+
+    record.isActive = false;
+    if (m_journal) {
+        m_journal->recordCleared(record.id, QDateTime::currentMSecsSinceEpoch());
+    }
+
+    m_active.remove(seq);
+    removeFromIndex(m_activeByDevice, record.deviceAddress, seq);
+    removeFromIndex(m_activeByCode, codeKey(record.deviceAddress, record.code), seq);
+    if (!record.acknowledged) {
+        --m_activeUnackedCount;
+    }
+
+    emit alarmCleared(record.id);
+}
+
+void AlarmManager::acknowledgeSet(const SeqSet& seqs) {
+    // Copy: markAcknowledged() edits the index being walked
+    const SeqSet pending = seqs;
+    for (Seq seq : pending) {
+        markAcknowledged(seq);
+    }
+    emit unacknowledgedCountChanged(m_unackedCount);
+    updateRepeatTimer();
+}
+
+void AlarmManager::resetIndexes() {
+    m_unackedByDevice.clear();
+    m_activeByDevice.clear();
+    m_unackedByGroup.clear();
+    m_activeByCode.clear();
+    m_active.clear();
+    m_unackedCount = 0;
+    m_activeUnackedCount = 0;
 }
 
 void AlarmManager::addAlarm(const QString& deviceName, uint8_t address,
                             const AlarmInfo& alarm, const QString& groupId) {
-    AlarmEvent event;
-    event.id = generateAlarmId();
-    event.timestamp = QDateTime::currentDateTime();
-    event.deviceName = deviceName;
-    event.deviceAddress = address;
-    event.groupId = groupId;
-    event.alarm = alarm;
-    event.acknowledged = false;
-    event.isActive = true;
+    // One active event per (device, code), restored ones included
+    if (m_activeByCode.contains(codeKey(address, alarm.code))) {
+        Logger::debug("Alarm {} on [{}] already active", alarm.code, address);
+        return;
+    }
 
-    // Limit stored alarms
-    if (m_alarms.size() >= MAX_ALARMS) {
-        m_alarms.removeFirst();
+    // Ring full: evict the oldest
+    if (m_nextSeq - m_firstSeq >= m_ring.size()) {
+        unindexEvent(m_firstSeq);
+        forgetId(m_firstSeq);
+        ++m_firstSeq;
     }
 
-    m_alarms.append(event);
+    const Seq seq = m_nextSeq++;
+    AlarmRecord& record = slot(seq);
+    record = AlarmRecord();
+    record.id = seq + m_idOffset;
+    record.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    record.deviceName = m_strings.intern(deviceName);
+    record.groupId = m_strings.intern(groupId);
+    record.code = alarm.code;
+    record.deviceAddress = address;
+    record.severity = alarm.severity;
+    record.isActive = true;
+    indexEvent(seq);
+
+    if (m_journal) {
+        AlarmJournal::Record entry;
+        entry.id = record.id;
+        entry.raisedMs = record.timestampMs;
+        entry.deviceName = deviceName.toStdString();
+        entry.groupId = groupId.toStdString();
+        entry.code = record.code;
+        entry.deviceAddress = record.deviceAddress;
+        entry.severity = static_cast<uint8_t>(record.severity);
+        m_journal->recordRaised(entry);
+    }
 
     Logger::warn("Alarm from {} [{}]: {} (code: {})",
                  deviceName.toStdString(),
@@ -49,118 +277,136 @@ void AlarmManager::addAlarm(const QString& deviceName, uint8_t address,
         updateRepeatTimer();
     }
 
-    emit alarmAdded(event);
-    emit unacknowledgedCountChanged(unacknowledgedCount());
+    emit alarmAdded(expand(record));
+    emit unacknowledgedCountChanged(m_unackedCount);
 }
 
-void AlarmManager::clearAlarm(const QString& alarmId) {
-    for (auto& alarm : m_alarms) {
-        if (alarm.id == alarmId) {
-            alarm.isActive = false;
-            emit alarmCleared(alarmId);
-            updateRepeatTimer();
-            break;
-        }
+const AlarmRecord* AlarmManager::find(uint64_t alarmId) const {
+    Seq seq;
+    return seqOf(alarmId, seq) ? &slot(seq) : nullptr;
+}
+
+AlarmEvent AlarmManager::expand(const AlarmRecord& record) const {
+    AlarmEvent event;
+    event.id = record.id;
+    event.timestamp = QDateTime::fromMSecsSinceEpoch(record.timestampMs);
+    event.deviceName = m_strings.str(record.deviceName);
+    event.deviceAddress = record.deviceAddress;
+    event.groupId = m_strings.str(record.groupId);
+    event.alarm.timestamp = event.timestamp;
+    event.alarm.deviceAddress = record.deviceAddress;
+    event.alarm.deviceName = event.deviceName;
+    event.alarm.code = record.code;
+    event.alarm.severity = record.severity;
+    event.alarm.message = alarm_catalog::message(record.code);
+    event.alarm.acknowledged = record.acknowledged;
+    event.acknowledged = record.acknowledged;
+    if (record.ackTimestampMs != 0) {
+        event.ackTimestamp = QDateTime::fromMSecsSinceEpoch(record.ackTimestampMs);
     }
+    event.isActive = record.isActive;
+    return event;
 }
 
-void AlarmManager::clearDeviceAlarms(uint8_t deviceAddress) {
-    for (auto& alarm : m_alarms) {
-        if (alarm.deviceAddress == deviceAddress && alarm.isActive) {
-            alarm.isActive = false;
-            emit alarmCleared(alarm.id);
-        }
+QString AlarmManager::exportUuid(uint64_t alarmId) const {
+    return QUuid::createUuidV5(ALARM_EXPORT_NAMESPACE, QString::number(alarmId))
+        .toString(QUuid::WithoutBraces);
+}
+
+void AlarmManager::clearAlarm(uint64_t alarmId) {
+    Seq seq;
+    if (seqOf(alarmId, seq)) {
+        markCleared(seq);
+        updateRepeatTimer();
     }
-    updateRepeatTimer();
 }
 
-QVector<AlarmEvent> AlarmManager::activeAlarms() const {
-    QVector<AlarmEvent> result;
-    for (const auto& alarm : m_alarms) {
-        if (alarm.isActive) {
-            result.append(alarm);
-        }
+void AlarmManager::clearAlarm(uint8_t deviceAddress, uint16_t code) {
+    auto it = m_activeByCode.find(codeKey(deviceAddress, code));
+    if (it == m_activeByCode.end()) {
+        return;
     }
-    return result;
+
+    const SeqSet pending = *it;
+    for (Seq seq : pending) {
+        Logger::info("Alarm cleared on [{}]: {} (code: {})",
+                     deviceAddress, alarm_catalog::message(code).toStdString(), code);
+        markCleared(seq);
+    }
+    updateRepeatTimer();
 }
 
-int AlarmManager::unacknowledgedCount() const {
-    int count = 0;
-    for (const auto& alarm : m_alarms) {
-        if (!alarm.acknowledged) {
-            ++count;
+void AlarmManager::clearDeviceAlarms(uint8_t deviceAddress) {
+    auto it = m_activeByDevice.find(deviceAddress);
+    if (it != m_activeByDevice.end()) {
+        const SeqSet pending = *it;
+        for (Seq seq : pending) {
+            markCleared(seq);
         }
     }
-    return count;
+    updateRepeatTimer();
 }
 
-int AlarmManager::activeUnacknowledgedCount() const {
-    int count = 0;
-    for (const auto& alarm : m_alarms) {
-        if (alarm.isActive && !alarm.acknowledged) {
-            ++count;
-        }
+QVector<AlarmEvent> AlarmManager::activeAlarms() const {
+    QVector<Seq> seqs(m_active.begin(), m_active.end());
+    std::sort(seqs.begin(), seqs.end());
+
+    QVector<AlarmEvent> result;
+    result.reserve(seqs.size());
+    for (Seq seq : seqs) {
+        result.append(expand(slot(seq)));
     }
-    return count;
+    return result;
 }
 
 void AlarmManager::acknowledge(int index) {
-    if (index >= 0 && index < m_alarms.size()) {
-        m_alarms[index].acknowledged = true;
-        m_alarms[index].ackTimestamp = QDateTime::currentDateTime();
-        emit alarmAcknowledged(index);
-        emit unacknowledgedCountChanged(unacknowledgedCount());
-        updateRepeatTimer();
+    if (index >= 0 && index < size()) {
+        const Seq seq = m_firstSeq + static_cast<Seq>(index);
+        if (!slot(seq).acknowledged) {
+            markAcknowledged(seq);
+            emit unacknowledgedCountChanged(m_unackedCount);
+            updateRepeatTimer();
+        }
     }
 }
 
-void AlarmManager::acknowledgeById(const QString& alarmId) {
-    for (int i = 0; i < m_alarms.size(); ++i) {
-        if (m_alarms[i].id == alarmId) {
-            acknowledge(i);
-            break;
-        }
+void AlarmManager::acknowledgeById(uint64_t alarmId) {
+    Seq seq;
+    if (seqOf(alarmId, seq)) {
+        acknowledge(positionOf(seq));
     }
 }
 
 void AlarmManager::acknowledgeDevice(uint8_t deviceAddress) {
-    for (int i = 0; i < m_alarms.size(); ++i) {
-        if (m_alarms[i].deviceAddress == deviceAddress && !m_alarms[i].acknowledged) {
-            m_alarms[i].acknowledged = true;
-            m_alarms[i].ackTimestamp = QDateTime::currentDateTime();
-            emit alarmAcknowledged(i);
-        }
-    }
-    emit unacknowledgedCountChanged(unacknowledgedCount());
-    updateRepeatTimer();
+    acknowledgeSet(m_unackedByDevice.value(deviceAddress));
 }
 
 void AlarmManager::acknowledgeGroup(const QString& groupId) {
-    for (int i = 0; i < m_alarms.size(); ++i) {
-        if (m_alarms[i].groupId == groupId && !m_alarms[i].acknowledged) {
-            m_alarms[i].acknowledged = true;
-            m_alarms[i].ackTimestamp = QDateTime::currentDateTime();
-            emit alarmAcknowledged(i);
-        }
+    const StringPool::Handle group = m_strings.find(groupId);
+    if (group == 0 && !groupId.isEmpty()) {
+        return; // No alarm ever carried this group
     }
-    emit unacknowledgedCountChanged(unacknowledgedCount());
-    updateRepeatTimer();
+    acknowledgeSet(m_unackedByGroup.value(group));
 }
 
 void AlarmManager::acknowledgeAll() {
-    for (int i = 0; i < m_alarms.size(); ++i) {
-        if (!m_alarms[i].acknowledged) {
-            m_alarms[i].acknowledged = true;
-            m_alarms[i].ackTimestamp = QDateTime::currentDateTime();
-            emit alarmAcknowledged(i);
-        }
+    // Walk the unacknowledged index, not the whole history
+    SeqSet pending;
+    for (const SeqSet& seqs : qAsConst(m_unackedByDevice)) {
+        pending.unite(seqs);
     }
-    emit unacknowledgedCountChanged(0);
-    updateRepeatTimer();
+    acknowledgeSet(pending);
 }
 
 void AlarmManager::clear() {
-    m_alarms.clear();
+    // Ids keep counting so exported UUIDs stay unique
+    m_firstSeq = m_nextSeq;
+    m_restoredIds.clear();
+    resetIndexes();
+    if (m_journal) {
+        m_journal->recordClearedAll(QDateTime::currentMSecsSinceEpoch());
+    }
+
     stopSound();
     emit alarmsCleared();
     emit unacknowledgedCountChanged(0);
@@ -4,7 +4,12 @@
 #include <QVector>
 #include <QDateTime>
 #include <QTimer>
+#include <QHash>
+#include <QSet>
+#include <vector>
 #include "protocol/IRadioDevice.h"
+#include "StringPool.h"
+#include "AlarmJournal.h"
 
 namespace rcms {
 
@@ -18,10 +23,30 @@ enum class AlarmSoundMode {
 };
 
 /**
- * @brief Alarm event with metadata
+ * @brief Stored alarm: fixed-size, no per-event heap allocations
+ *
+ * Names are interned, message and severity come from the alarm catalog
+ * by code, times are epoch milliseconds.
+ */
+struct AlarmRecord {
+    uint64_t id = 0;                // Monotonic, 1-based
+    int64_t timestampMs = 0;
+    int64_t ackTimestampMs = 0;     // 0 = not acknowledged
+    StringPool::Handle deviceName = 0;
+    StringPool::Handle groupId = 0;
+    uint16_t code = 0;
+    uint8_t deviceAddress = 0;
+    AlarmSeverity severity = AlarmSeverity::Info;
+    bool acknowledged = false;
+    bool isActive = false;
+};
+
+/**
+ * @brief Alarm event with metadata, expanded from an AlarmRecord for
+ *        signals and views
  */
 struct AlarmEvent {
-    QString id;                     // Unique alarm ID
+    uint64_t id = 0;                // Unique alarm ID (exportUuid() for a UUID)
     QDateTime timestamp;
     QString deviceName;
     uint8_t deviceAddress;
@@ -39,16 +64,45 @@ struct AlarmEvent {
 
 /**
  * @brief Manages alarm events and notifications
+ *
+ * Events are kept in a fixed-capacity ring (oldest evicted first) and
+ * addressed by a monotonically increasing sequence number; ids are the
+ * sequence number plus a fixed offset, so lookup by id is arithmetic.
+ * Hash indexes by device, group and (device, code) plus incrementally
+ * maintained counters keep add, acknowledge, clear and count queries
+ * independent of the history size. Positional indexes (0 = oldest) are
+ * used by at(), acknowledge() and alarmAcknowledged().
  */
 class AlarmManager : public QObject {
     Q_OBJECT
 
 public:
+    static constexpr int DEFAULT_CAPACITY = 1000;
+
     explicit AlarmManager(QObject* parent = nullptr);
     ~AlarmManager();
 
+    /**
+     * @brief Change history capacity, keeping the newest events
+     */
+    void setCapacity(int capacity);
+    int capacity() const { return static_cast<int>(m_ring.size()); }
+
+    /**
+     * @brief Persist transitions to a journal and restore its outstanding
+     *        (active or unacknowledged) alarms
+     *
+     * Call once at startup, before any alarm is added. New ids continue
+     * after the journal's highest id; if the journal is null or not open,
+     * the per-run ids seeded at construction are kept. The journal must
+     * outlive this object.
+     */
+    void attachJournal(AlarmJournal* journal);
+
     /**
      * @brief Add new alarm event
+     *
+     * Ignored while an event for the same (address, code) is still active.
      */
     void addAlarm(const QString& deviceName, uint8_t address,
                   const AlarmInfo& alarm, const QString& groupId = QString());
@@ -56,7 +110,12 @@ public:
     /**
      * @brief Mark alarm as cleared (device recovered)
      */
-    void clearAlarm(const QString& alarmId);
+    void clearAlarm(uint64_t alarmId);
+
+    /**
+     * @brief Mark the active alarm with this code as cleared (fault gone)
+     */
+    void clearAlarm(uint8_t deviceAddress, uint16_t code);
 
     /**
      * @brief Mark alarm as cleared by device address
@@ -64,24 +123,53 @@ public:
     void clearDeviceAlarms(uint8_t deviceAddress);
 
     /**
-     * @brief Get all alarm events
+     * @brief Number of stored events
      */
-    const QVector<AlarmEvent>& alarms() const { return m_alarms; }
+    int size() const { return static_cast<int>(m_nextSeq - m_firstSeq); }
 
     /**
-     * @brief Get active (non-cleared) alarms
+     * @brief Record by position, 0 = oldest
+     */
+    const AlarmRecord& at(int index) const { return slot(m_firstSeq + index); }
+
+    /**
+     * @brief Expanded event by position, 0 = oldest
+     */
+    AlarmEvent event(int index) const { return expand(at(index)); }
+
+    /**
+     * @brief Record by ID, nullptr if unknown or evicted
+     */
+    const AlarmRecord* find(uint64_t alarmId) const;
+
+    /**
+     * @brief Resolve interned names, catalog text and times
+     */
+    AlarmEvent expand(const AlarmRecord& record) const;
+
+    /**
+     * @brief Stable UUID for an alarm ID, for export to external systems
+     *
+     * Name-based (v5) in a fixed application namespace: the same alarm
+     * exports the same UUID after a restart (ids continue from the
+     * journal).
+     */
+    QString exportUuid(uint64_t alarmId) const;
+
+    /**
+     * @brief Get active (non-cleared) alarms, oldest first
      */
     QVector<AlarmEvent> activeAlarms() const;
 
     /**
      * @brief Get unacknowledged alarms count
      */
-    int unacknowledgedCount() const;
+    int unacknowledgedCount() const { return m_unackedCount; }
 
     /**
      * @brief Get active unacknowledged alarms count
      */
-    int activeUnacknowledgedCount() const;
+    int activeUnacknowledgedCount() const { return m_activeUnackedCount; }
 
     /**
      * @brief Acknowledge alarm by index
@@ -91,7 +179,7 @@ public:
     /**
      * @brief Acknowledge alarm by ID
      */
-    void acknowledgeById(const QString& alarmId);
+    void acknowledgeById(uint64_t alarmId);
 
     /**
      * @brief Acknowledge all alarms for a device
@@ -141,7 +229,7 @@ public:
 
 signals:
     void alarmAdded(const AlarmEvent& event);
-    void alarmCleared(const QString& alarmId);
+    void alarmCleared(uint64_t alarmId);
     void alarmAcknowledged(int index);
     void alarmsCleared();
     void unacknowledgedCountChanged(int count);
@@ -150,19 +238,59 @@ private slots:
     void onRepeatTimer();
 
 private:
+    using Seq = uint64_t;
+    using SeqSet = QSet<Seq>;
+
     void playAlarmSound();
     void updateRepeatTimer();
-    QString generateAlarmId() const;
 
-    QVector<AlarmEvent> m_alarms;
+    AlarmRecord& slot(Seq seq) { return m_ring[seq % m_ring.size()]; }
+    const AlarmRecord& slot(Seq seq) const { return m_ring[seq % m_ring.size()]; }
+    int positionOf(Seq seq) const { return static_cast<int>(seq - m_firstSeq); }
+    bool seqOf(uint64_t alarmId, Seq& seq) const;
+
+    // Index maintenance
+    void indexEvent(Seq seq);
+    void unindexEvent(Seq seq);
+    void markAcknowledged(Seq seq);
+    void markCleared(Seq seq);
+    void acknowledgeSet(const SeqSet& seqs);
+    void resetIndexes();
+    void forgetId(Seq seq);
+
+    static uint32_t codeKey(uint8_t address, uint16_t code) {
+        return (static_cast<uint32_t>(address) << 16) | code;
+    }
+
+    // Ring storage: live events are [m_firstSeq, m_nextSeq)
+    std::vector<AlarmRecord> m_ring;
+    Seq m_firstSeq = 0;
+    Seq m_nextSeq = 0;
+
+    StringPool m_strings;       // Device names and group ids
+
+    // id = seq + m_idOffset (mod 2^64); restored alarms keep journal ids.
+    // Without a journal the offset is the start time in ms << 20, so ids
+    // (and exported UUIDs) do not repeat across runs.
+    uint64_t m_idOffset;
+    QHash<uint64_t, Seq> m_restoredIds;
+    AlarmJournal* m_journal = nullptr;
+
+    // Indexes (values are sequence numbers)
+    QHash<uint8_t, SeqSet> m_unackedByDevice;
+    QHash<uint8_t, SeqSet> m_activeByDevice;
+    QHash<StringPool::Handle, SeqSet> m_unackedByGroup;
+    QHash<uint32_t, SeqSet> m_activeByCode;
+    SeqSet m_active;
+    int m_unackedCount = 0;
+    int m_activeUnackedCount = 0;
+
     bool m_soundEnabled = true;
     AlarmSoundMode m_soundMode = AlarmSoundMode::Once;
     int m_repeatIntervalSec = 30;
     int m_volume = 80;
     QString m_soundFile = ":/sounds/alarm.wav";
     QTimer* m_repeatTimer = nullptr;
-
-    static constexpr int MAX_ALARMS = 1000;
 };
 
 } // namespace rcms
@@ -0,0 +1,122 @@
+#include "AlarmTracker.h"
+#include <algorithm>
+
+namespace rcms {
+
+AlarmTracker::AlarmTracker()
+    : AlarmTracker(Config())
+{
+}
+
+AlarmTracker::AlarmTracker(const Config& config)
+    : m_config(config)
+{
+}
+
+size_t AlarmTracker::observe(Key device, const std::vector<uint16_t>& activeCodes,
+                             std::vector<Transition>& out) {
+    // Healthy devices have no entry: don't create one just to erase it
+    auto found = m_devices.find(device);
+    if (found == m_devices.end()) {
+        if (activeCodes.empty()) {
+            return 0;
+        }
+        found = m_devices.emplace(device, std::vector<CodeState>()).first;
+    }
+    std::vector<CodeState>& states = found->second;
+    const size_t before = out.size();
+
+    auto isActive = [&activeCodes](uint16_t code) {
+        return std::find(activeCodes.begin(), activeCodes.end(), code) != activeCodes.end();
+    };
+
+    // Codes already tracked
+    for (auto it = states.begin(); it != states.end();) {
+        const bool active = isActive(it->code);
+
+        if (it->raised) {
+            it->count = active ? 0 : it->count + 1;
+            if (it->count >= m_config.clearCount) {
+                out.push_back(Transition{device, it->code, Edge::Cleared});
+                it = states.erase(it);
+                continue;
+            }
+        } else if (active) {
+            if (++it->count >= m_config.raiseCount) {
+                it->raised = true;
+                it->count = 0;
+                out.push_back(Transition{device, it->code, Edge::Raised});
+            }
+        } else {
+            // Bounced before raising
+            it = states.erase(it);
+            continue;
+        }
+        ++it;
+    }
+
+    // Newly seen codes
+    for (uint16_t code : activeCodes) {
+        auto known = std::find_if(states.begin(), states.end(),
+                                  [code](const CodeState& s) { return s.code == code; });
+        if (known != states.end()) {
+            continue;
+        }
+
+        CodeState state;
+        state.code = code;
+        state.count = 1;
+        if (state.count >= m_config.raiseCount) {
+            state.raised = true;
+            state.count = 0;
+            out.push_back(Transition{device, code, Edge::Raised});
+        }
+        states.push_back(state);
+    }
+
+    if (states.empty()) {
+        m_devices.erase(found);
+    }
+
+    return out.size() - before;
+}
+
+void AlarmTracker::seed(Key device, uint16_t code) {
+    std::vector<CodeState>& states = m_devices[device];
+    auto it = std::find_if(states.begin(), states.end(),
+                           [code](const CodeState& s) { return s.code == code; });
+    if (it == states.end()) {
+        it = states.insert(states.end(), CodeState());
+        it->code = code;
+    }
+    it->raised = true;
+    it->count = 0;
+}
+
+void AlarmTracker::remove(Key device) {
+    m_devices.erase(device);
+}
+
+bool AlarmTracker::isRaised(Key device, uint16_t code) const {
+    auto it = m_devices.find(device);
+    if (it == m_devices.end()) {
+        return false;
+    }
+    for (const CodeState& state : it->second) {
+        if (state.code == code) {
+            return state.raised;
+        }
+    }
+    return false;
+}
+
+size_t AlarmTracker::raisedCount(Key device) const {
+    auto it = m_devices.find(device);
+    if (it == m_devices.end()) {
+        return 0;
+    }
+    return static_cast<size_t>(std::count_if(it->second.begin(), it->second.end(),
+                                             [](const CodeState& s) { return s.raised; }));
+}
+
+} // namespace rcms
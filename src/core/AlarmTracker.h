@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace rcms {
+
+/**
+ * @brief Per-(device, code) alarm state machine with debounce
+ *
+ * Devices report the set of active fault codes on every poll. The tracker
+ * turns that level signal into raise/clear edges, so a fault that stays
+ * active produces one event instead of one per poll. A code must be seen
+ * on raiseCount consecutive polls to raise and be absent on clearCount
+ * consecutive polls to clear; clearCount > raiseCount gives hysteresis
+ * against a fault bit that flickers near its threshold.
+ *
+ * Failed polls carry no information and should simply not be observed.
+ */
+class AlarmTracker {
+public:
+    using Key = const void*;
+
+    struct Config {
+        int raiseCount = 2;     // Consecutive active polls to raise
+        int clearCount = 3;     // Consecutive inactive polls to clear
+    };
+
+    enum class Edge {
+        Raised,
+        Cleared
+    };
+
+    struct Transition {
+        Key device;
+        uint16_t code;
+        Edge edge;
+    };
+
+    AlarmTracker();
+    explicit AlarmTracker(const Config& config);
+
+    /**
+     * @brief Feed the codes active in one successful poll of a device
+     * @return Number of transitions appended to out
+     */
+    size_t observe(Key device, const std::vector<uint16_t>& activeCodes,
+                   std::vector<Transition>& out);
+
+    /**
+     * @brief Mark a code raised without an edge
+     *
+     * For alarms restored as active from the journal: the fault is not
+     * raised a second time if polls still report it, and clears through
+     * the usual hysteresis if they don't.
+     */
+    void seed(Key device, uint16_t code);
+
+    /**
+     * @brief Forget a device without producing edges
+     */
+    void remove(Key device);
+
+    bool isRaised(Key device, uint16_t code) const;
+    size_t raisedCount(Key device) const;
+
+    const Config& config() const { return m_config; }
+
+private:
+    struct CodeState {
+        uint16_t code = 0;
+        bool raised = false;
+        int count = 0;          // Consecutive polls disagreeing with raised
+    };
+
+    Config m_config;
+
+    // Few codes per device: a flat vector beats a nested map
+    std::unordered_map<Key, std::vector<CodeState>> m_devices;
+};
+
+} // namespace rcms
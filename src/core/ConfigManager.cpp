@@ -16,6 +16,17 @@ bool ConfigManager::load(const std::string& filename) {
         file >> config;
 
         m_pollingInterval = config.value("pollingInterval", 1000);
+        m_guiRefreshRate = config.value("guiRefreshRate", 10);
+
+        m_traceEnabled = true;
+        m_trace = Trace::Config{};
+        if (config.contains("trace")) {
+            const auto& trace = config["trace"];
+            m_traceEnabled = trace.value("enabled", true);
+            m_trace.file = trace.value("file", m_trace.file);
+            m_trace.maxFileSize = trace.value("maxSize", m_trace.maxFileSize);
+            m_trace.maxFiles = trace.value("maxFiles", m_trace.maxFiles);
+        }
 
         m_devices.clear();
         if (config.contains("devices")) {
@@ -44,6 +55,7 @@ bool ConfigManager::save(const std::string& filename) const {
     try {
         nlohmann::json config;
         config["pollingInterval"] = m_pollingInterval;
+        config["guiRefreshRate"] = m_guiRefreshRate;
 
         nlohmann::json devices = nlohmann::json::array();
         for (const auto& dev : m_devices) {
@@ -58,6 +70,13 @@ bool ConfigManager::save(const std::string& filename) const {
         }
         config["devices"] = devices;
 
+        nlohmann::json trace;
+        trace["enabled"] = m_traceEnabled;
+        trace["file"] = m_trace.file;
+        trace["maxSize"] = m_trace.maxFileSize;
+        trace["maxFiles"] = m_trace.maxFiles;
+        config["trace"] = trace;
+
         std::ofstream file(filename);
         if (!file.is_open()) {
             Logger::error("Cannot write config file: {}", filename);
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <nlohmann/json.hpp>
+#include "Trace.h"
 
 namespace rcms {
 
@@ -66,9 +67,30 @@ public:
      */
     void setPollingInterval(int ms) { m_pollingInterval = ms; }
 
+    /**
+     * @brief Get GUI refresh rate for device status (Hz)
+     */
+    int guiRefreshRate() const { return m_guiRefreshRate; }
+
+    /**
+     * @brief Set GUI refresh rate for device status (Hz)
+     */
+    void setGuiRefreshRate(int hz) { m_guiRefreshRate = hz; }
+
+    /**
+     * @brief Binary frame trace ("trace" section): file, size cap, rotation
+     */
+    bool traceEnabled() const { return m_traceEnabled; }
+    const Trace::Config& traceConfig() const { return m_trace; }
+    void setTraceEnabled(bool enabled) { m_traceEnabled = enabled; }
+    void setTraceConfig(const Trace::Config& config) { m_trace = config; }
+
 private:
     std::vector<DeviceConfig> m_devices;
     int m_pollingInterval = 1000;
+    int m_guiRefreshRate = 10;
+    bool m_traceEnabled = true;
+    Trace::Config m_trace;
 };
 
 } // namespace rcms
@@ -3,6 +3,7 @@
 #include <QString>
 #include <memory>
 #include "comm/ITransport.h"
+#include "protocol/RtuTiming.h"
 
 namespace rcms {
 
@@ -51,6 +52,26 @@ struct ConnectionProfile {
      */
     std::unique_ptr<ITransport> createTransport() const;
 
+    /**
+     * @brief RTU line timing for the serial frame format
+     *
+     * For TCP-Serial the bridge's serial side is assumed to use the
+     * same settings.
+     */
+    RtuTiming rtuTiming() const {
+        return RtuTiming{baudRate, dataBits, parity != 'N', stopBits};
+    }
+
+    /**
+     * @brief Line silence that may occur inside a response, ms
+     *
+     * USB-RS485 adapters hand data over in latency-timer chunks (16 ms by
+     * default); a TCP bridge adds packetization and network jitter.
+     */
+    int silenceToleranceMs() const {
+        return type == ConnectionType::COM ? 20 : 50;
+    }
+
     /**
      * @brief Get connection string for display
      */
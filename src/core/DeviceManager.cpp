@@ -1,5 +1,9 @@
 #include "DeviceManager.h"
 #include "Logger.h"
+#include "protocol/AlarmCatalog.h"
+#include <QPointer>
+#include <algorithm>
+#include <limits>
 
 namespace rcms {
 
@@ -7,18 +11,52 @@ DeviceManager::DeviceManager(QObject* parent)
     : QObject(parent)
     , m_pollTimer(new QTimer(this))
 {
+    // Armed for the next device deadline, not a fixed cadence
+    m_pollTimer->setSingleShot(true);
     connect(m_pollTimer, &QTimer::timeout, this, &DeviceManager::pollDevices);
+    m_clock.start();
 }
 
 DeviceManager::~DeviceManager() {
     stopPolling();
 }
 
-void DeviceManager::addDevice(std::shared_ptr<IRadioDevice> device) {
+void DeviceManager::addDevice(std::shared_ptr<IRadioDevice> device, int pollingIntervalMs) {
     m_devices.push_back(device);
+    m_scheduler.add(device.get(), pollingIntervalMs, m_clock.elapsed());
+    m_pollState[device.get()].telemetryName = device->deviceId().toStdString();
+
+    const uint8_t address = device->modbusAddress();
+    auto restored = std::remove_if(m_restoredAlarms.begin(), m_restoredAlarms.end(),
+                                   [&](const std::pair<uint8_t, uint16_t>& alarm) {
+        if (alarm.first != address) {
+            return false;
+        }
+        m_alarmTracker.seed(device.get(), alarm.second);
+        return true;
+    });
+    m_restoredAlarms.erase(restored, m_restoredAlarms.end());
+
     Logger::info("Added device: {} (addr: {})",
                  device->deviceId().toStdString(),
                  device->modbusAddress());
+
+    if (m_polling) {
+        armTimer();
+    }
+}
+
+void DeviceManager::restoreAlarm(uint8_t address, uint16_t code) {
+    bool seeded = false;
+    for (const auto& dev : m_devices) {
+        if (dev->modbusAddress() == address) {
+            m_alarmTracker.seed(dev.get(), code);
+            seeded = true;
+        }
+    }
+    if (!seeded) {
+        m_restoredAlarms.emplace_back(address, code);
+    }
 }
 
 void DeviceManager::removeDevice(size_t index) {
@@ -26,10 +64,71 @@ void DeviceManager::removeDevice(size_t index) {
         auto& dev = m_devices[index];
         Logger::info("Removing device: {}", dev->deviceId().toStdString());
         dev->close();
+        if (m_focused == dev.get()) {
+            m_focused = nullptr;
+        }
+        m_scheduler.remove(dev.get());
+        m_alarmTracker.remove(dev.get());
+        m_pollState.remove(dev.get());
         m_devices.erase(m_devices.begin() + index);
     }
 }
 
+bool DeviceManager::openDevice(size_t index, const QString& portName, int baudRate) {
+    if (index >= m_devices.size()) {
+        return false;
+    }
+    IRadioDevice* dev = m_devices[index].get();
+    const bool ok = dev->open(portName, baudRate);
+    resetSchedule(dev);
+    return ok;
+}
+
+void DeviceManager::closeDevice(size_t index) {
+    if (index < m_devices.size()) {
+        IRadioDevice* dev = m_devices[index].get();
+        dev->close();
+        resetSchedule(dev);
+    }
+}
+
+void DeviceManager::resetSchedule(IRadioDevice* dev) {
+    // Bus attachment changed: a request in flight will never complete
+    m_scheduler.reset(dev, m_clock.elapsed());
+    armTimer();
+}
+
+void DeviceManager::setPollingInterval(size_t index, int intervalMs) {
+    if (index < m_devices.size()) {
+        m_scheduler.setInterval(m_devices[index].get(), intervalMs);
+    }
+}
+
+void DeviceManager::setFocusedDevice(int index) {
+    IRadioDevice* focused = nullptr;
+    if (index >= 0 && static_cast<size_t>(index) < m_devices.size()) {
+        focused = m_devices[index].get();
+    }
+
+    if (focused != m_focused) {
+        if (m_focused) {
+            m_focused->setTelemetryPromoted(false);
+        }
+        if (focused) {
+            focused->setTelemetryPromoted(true);
+        }
+        m_focused = focused;
+    }
+
+    // Newly shown device: views need every field once, not a delta
+    if (focused) {
+        auto it = m_pollState.constFind(focused);
+        if (it != m_pollState.constEnd() && it->hasStatus) {
+            emit deviceStatusChanged(static_cast<size_t>(index), StatusDelta::full(it->status));
+        }
+    }
+}
+
 std::shared_ptr<IRadioDevice> DeviceManager::device(size_t index) const {
     if (index < m_devices.size()) {
         return m_devices[index];
@@ -39,9 +138,10 @@ std::shared_ptr<IRadioDevice> DeviceManager::device(size_t index) const {
 
 void DeviceManager::startPolling(int intervalMs) {
     if (!m_polling) {
-        m_pollTimer->start(intervalMs);
+        m_scheduler.setDefaultInterval(intervalMs);
         m_polling = true;
-        Logger::info("Started polling with {}ms interval", intervalMs);
+        armTimer();
+        Logger::info("Started polling with {}ms default interval", intervalMs);
     }
 }
 
@@ -53,36 +153,162 @@ void DeviceManager::stopPolling() {
     }
 }
 
+void DeviceManager::armTimer() {
+    if (!m_polling) {
+        return;
+    }
+
+    const int64_t next = m_scheduler.nextDeadline();
+    if (next == std::numeric_limits<int64_t>::max()) {
+        m_pollTimer->stop();
+        return;
+    }
+
+    const int64_t wait = next - m_clock.elapsed();
+    m_pollTimer->start(static_cast<int>(std::max<int64_t>(0, wait)));
+}
+
 void DeviceManager::pollDevices() {
-    for (size_t i = 0; i < m_devices.size(); ++i) {
-        auto& dev = m_devices[i];
+    m_due.clear();
+    m_scheduler.takeDue(m_clock.elapsed(), m_due);
+
+    QPointer<DeviceManager> self(this);
+
+    for (const auto& task : m_due) {
+        auto* dev = static_cast<IRadioDevice*>(const_cast<void*>(task.key));
 
         if (!dev->isOpen()) {
+            completePoll(dev, false);
             continue;
         }
 
-        DeviceStatus status;
-        bool wasOnline = status.online;
+        if (task.action == PollScheduler::Action::Probe) {
+            dev->probe(PROBE_TIMEOUT_MS, [self, dev](bool ok) {
+                if (self) {
+                    self->onProbeResult(dev, ok);
+                }
+            });
+            continue;
+        }
 
-        if (dev->readStatus(status)) {
-            if (!wasOnline && status.online) {
-                emit deviceOnlineChanged(i, true);
+        // Status and alarms from a single transaction
+        dev->poll([self, dev](bool ok, const PollSnapshot& snapshot) {
+            if (self) {
+                self->onPolled(dev, ok, snapshot);
             }
-            emit deviceStatusChanged(i, status);
+        });
+    }
 
-            // Check for alarms
-            QVector<AlarmInfo> alarms;
-            if (dev->readAlarms(alarms)) {
-                for (const auto& alarm : alarms) {
-                    emit alarmDetected(i, alarm);
-                }
+    armTimer();
+}
+
+void DeviceManager::completePoll(IRadioDevice* dev, bool ok) {
+    m_scheduler.complete(dev, ok, m_clock.elapsed());
+    armTimer();
+}
+
+void DeviceManager::setOnline(IRadioDevice* dev, int index, bool online) {
+    PollState& state = m_pollState[dev];
+    if (state.online != online) {
+        state.online = online;
+        emit deviceOnlineChanged(static_cast<size_t>(index), online);
+    }
+}
+
+void DeviceManager::onProbeResult(IRadioDevice* dev, bool ok) {
+    if (indexOf(dev) < 0) {
+        return; // Removed while the probe was in flight
+    }
+
+    if (ok) {
+        Logger::info("Device {} answered probe", dev->deviceId().toStdString());
+    }
+
+    // Online state is confirmed by the full poll that follows
+    completePoll(dev, ok);
+}
+
+void DeviceManager::onPolled(IRadioDevice* dev, bool ok, const PollSnapshot& snapshot) {
+    int index = indexOf(dev);
+    if (index < 0) {
+        return; // Removed while the read was in flight
+    }
+
+    setOnline(dev, index, ok);
+
+    PollState& state = m_pollState[dev];
+    if (ok) {
+        // Only changed fields reach the views; unchanged devices cost nothing
+        StatusDelta delta;
+        delta.changed = state.hasStatus ? diffStatus(state.status, snapshot.status)
+                                        : status_fields::All;
+        delta.status = snapshot.status;
+        state.status = snapshot.status;
+        state.hasStatus = true;
+
+        if (dev == m_focused) {
+            delta.changed |= status_fields::LastUpdate;
+        }
+        if (delta.changed) {
+            emit deviceStatusChanged(static_cast<size_t>(index), delta);
+        }
+
+        if (m_telemetry || m_archive) {
+            const DeviceSnapshot& s = snapshot.status;
+            TelemetryStore::Sample sample;
+            sample.timestampMs = s.timestampNs ? snapshot_clock::toEpochMs(s.timestampNs)
+                                               : QDateTime::currentMSecsSinceEpoch();
+            sample.voltage = s.voltage24V();
+            sample.temperature = s.temperature();
+            sample.frequencyMHz = s.frequencyMHz();
+            sample.signalLevel = s.signalLevel;
+            sample.transmitting = s.isTransmitting;
+            if (m_telemetry) {
+                m_telemetry->ingest(state.telemetryName, sample);
             }
-        } else {
-            if (wasOnline) {
-                emit deviceOnlineChanged(i, false);
+            if (m_archive) {
+                m_archive->append(state.telemetryName, sample);
             }
         }
+
+        // Level -> edges: only raise/clear transitions leave the manager
+        m_activeCodes.assign(snapshot.alarmCodes, snapshot.alarmCodes + snapshot.alarmCount);
+        m_alarmEdges.clear();
+        m_alarmTracker.observe(dev, m_activeCodes, m_alarmEdges);
+
+        for (const auto& edge : m_alarmEdges) {
+            if (edge.edge == AlarmTracker::Edge::Cleared) {
+                emit alarmCleared(static_cast<size_t>(index), edge.code);
+                continue;
+            }
+            // Text and time only for the rare raise edge
+            emit alarmDetected(static_cast<size_t>(index), alarm_catalog::describe(edge.code));
+        }
+    } else if (state.hasStatus && state.status.online) {
+        state.status.online = false;
+        emit deviceStatusChanged(static_cast<size_t>(index),
+                                 StatusDelta{status_fields::Online, state.status});
+    }
+
+    completePoll(dev, ok);
+}
+
+int DeviceManager::indexOf(const QString& deviceId) const {
+    for (size_t i = 0; i < m_devices.size(); ++i) {
+        if (m_devices[i]->deviceId() == deviceId) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+int DeviceManager::indexOf(const IRadioDevice* dev) const {
+    for (size_t i = 0; i < m_devices.size(); ++i) {
+        if (m_devices[i].get() == dev) {
+            return static_cast<int>(i);
+        }
     }
+    return -1;
 }
 
 } // namespace rcms
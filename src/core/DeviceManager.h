@@ -2,16 +2,33 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QHash>
+#include <QElapsedTimer>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 #include "protocol/IRadioDevice.h"
+#include "PollScheduler.h"
+#include "AlarmTracker.h"
+#include "StatusDelta.h"
+#include "TelemetryStore.h"
+#include "TelemetryArchive.h"
 
 namespace rcms {
 
 /**
  * @brief Manages all radio devices
  *
- * Handles device polling, status aggregation, and device lifecycle
+ * Handles device polling, status aggregation, and device lifecycle.
+ * Polling is asynchronous and deadline-based: PollScheduler decides when
+ * each device is due (per-device interval, backoff with a short-timeout
+ * probe for unreachable radios) and a single-shot timer is armed for the
+ * next deadline. Each poll is one bus transaction (IRadioDevice::poll)
+ * that yields both status and active alarms. Results arrive via callbacks.
+ * Every bus runs on its own worker thread (see BusMaster), so devices on
+ * different ports are polled in parallel and the cycle time is bounded
+ * by the slowest bus. Results are queued back to this object's thread.
  */
 class DeviceManager : public QObject {
     Q_OBJECT
@@ -22,8 +39,60 @@ public:
 
     /**
      * @brief Add a device to management
+     * @param pollingIntervalMs Poll interval for this device, 0 for the
+     *        default passed to startPolling()
      */
-    void addDevice(std::shared_ptr<IRadioDevice> device);
+    void addDevice(std::shared_ptr<IRadioDevice> device, int pollingIntervalMs = 0);
+
+    /**
+     * @brief Change the poll interval of one device (0 = default)
+     */
+    void setPollingInterval(size_t index, int intervalMs);
+
+    /**
+     * @brief Device the operator is looking at; its slow telemetry is
+     *        polled every cycle until focus moves (-1 = none)
+     *
+     * Re-emits the device's last known status with every field marked
+     * changed, so a freshly selected view can draw it in full.
+     */
+    void setFocusedDevice(int index);
+
+    /**
+     * @brief Record every successful poll in a telemetry store (nullptr = off)
+     *
+     * The store must outlive this object or be detached first.
+     */
+    void setTelemetryStore(TelemetryStore* store) { m_telemetry = store; }
+
+    /**
+     * @brief Also append every successful poll to a long-term archive
+     *        (nullptr = off); same lifetime rule as the store
+     */
+    void setTelemetryArchive(TelemetryArchive* archive) { m_archive = archive; }
+
+    /**
+     * @brief Alarm restored as active from the journal
+     *
+     * Seeded into the alarm tracker of the device(s) at this address, now
+     * or when such a device is added: polls then clear it if the fault is
+     * gone, and don't raise it a second time if it is still there.
+     */
+    void restoreAlarm(uint8_t address, uint16_t code);
+
+    /**
+     * @brief Open (or reopen) a device's connection
+     *
+     * Reopening detaches the device from its bus, which drops a poll or
+     * probe still queued there; the device's schedule is reset so it is
+     * polled again right away instead of waiting for that lost result.
+     */
+    bool openDevice(size_t index, const QString& portName, int baudRate = 9600);
+
+    /**
+     * @brief Close a device's connection; polls fail until it is reopened
+     */
+    void closeDevice(size_t index);
 
     /**
      * @brief Remove device by index
@@ -40,8 +109,14 @@ public:
      */
     std::shared_ptr<IRadioDevice> device(size_t index) const;
 
+    /**
+     * @brief Index of the device with this deviceId, -1 if none
+     */
+    int indexOf(const QString& deviceId) const;
+
     /**
      * @brief Start polling all devices
+     * @param intervalMs Default interval for devices without their own
      */
     void startPolling(int intervalMs = 1000);
 
@@ -58,8 +133,11 @@ public:
 signals:
     /**
      * @brief Emitted when device status changes
+     *
+     * Not emitted for polls that changed nothing, except for the focused
+     * device (LastUpdate only). delta.changed lists the changed fields.
      */
-    void deviceStatusChanged(size_t index, const DeviceStatus& status);
+    void deviceStatusChanged(size_t index, const StatusDelta& delta);
 
     /**
      * @brief Emitted when device goes online/offline
@@ -67,15 +145,53 @@ signals:
     void deviceOnlineChanged(size_t index, bool online);
 
     /**
-     * @brief Emitted when alarm is detected
+     * @brief Emitted when an alarm is raised (once per occurrence, after
+     *        debounce; a fault that stays active is not re-emitted)
      */
     void alarmDetected(size_t index, const AlarmInfo& alarm);
 
+    /**
+     * @brief Emitted when a raised alarm is no longer reported by the device
+     */
+    void alarmCleared(size_t index, uint16_t code);
+
 private slots:
     void pollDevices();
 
 private:
+    /**
+     * @brief Per-device polling state
+     */
+    struct PollState {
+        bool online = false;        // Last poll succeeded
+        bool hasStatus = false;     // status holds a decoded poll
+        DeviceSnapshot status;      // Last values sent to the views
+        std::string telemetryName;  // deviceId as the telemetry key, converted once
+    };
+
+    // Probe timeout for unreachable devices
+    static constexpr int PROBE_TIMEOUT_MS = 200;
+
+    void onPolled(IRadioDevice* dev, bool ok, const PollSnapshot& snapshot);
+    void onProbeResult(IRadioDevice* dev, bool ok);
+    void setOnline(IRadioDevice* dev, int index, bool online);
+    void completePoll(IRadioDevice* dev, bool ok);
+    void resetSchedule(IRadioDevice* dev);
+    void armTimer();
+    int indexOf(const IRadioDevice* dev) const;
+
     std::vector<std::shared_ptr<IRadioDevice>> m_devices;
+    QHash<IRadioDevice*, PollState> m_pollState;
+    PollScheduler m_scheduler;
+    AlarmTracker m_alarmTracker;
+    std::vector<PollScheduler::Task> m_due;               // Scratch for pollDevices
+    std::vector<uint16_t> m_activeCodes;                  // Scratch for onPolled
+    std::vector<AlarmTracker::Transition> m_alarmEdges;   // Scratch for onPolled
+    std::vector<std::pair<uint8_t, uint16_t>> m_restoredAlarms;   // Awaiting their device
+    IRadioDevice* m_focused = nullptr;
+    TelemetryStore* m_telemetry = nullptr;
+    TelemetryArchive* m_archive = nullptr;
+    QElapsedTimer m_clock;
     QTimer* m_pollTimer;
     bool m_polling = false;
 };
@@ -0,0 +1,75 @@
+#include "LatencyStats.h"
+#include <algorithm>
+#include <cmath>
+
+namespace rcms {
+
+LatencyStats::LatencyStats(size_t window)
+    : m_samples(window > 0 ? window : 1, 0)
+{
+}
+
+void LatencyStats::record(int64_t value) {
+    m_samples[m_next] = value;
+    m_next = (m_next + 1) % m_samples.size();
+
+    if (m_count == 0 || value > m_max) {
+        m_max = value;
+    }
+    ++m_count;
+}
+
+size_t LatencyStats::filled() const {
+    return m_count < m_samples.size() ? static_cast<size_t>(m_count) : m_samples.size();
+}
+
+int64_t LatencyStats::percentile(double p) const {
+    const size_t n = filled();
+    if (n == 0) {
+        return 0;
+    }
+
+    p = std::min(100.0, std::max(0.0, p));
+
+    // Nearest rank: ceil(p/100 * n), 1-based
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(n)));
+    size_t k = rank > 0 ? rank - 1 : 0;
+
+    std::vector<int64_t> sorted(m_samples.begin(), m_samples.begin() + n);
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    return sorted[k];
+}
+
+LatencyStats::Summary LatencyStats::summary() const {
+    Summary s;
+    s.count = m_count;
+    s.max = m_max;
+
+    const size_t n = filled();
+    if (n == 0) {
+        return s;
+    }
+
+    // One sorted copy for all percentiles
+    std::vector<int64_t> sorted(m_samples.begin(), m_samples.begin() + n);
+    std::sort(sorted.begin(), sorted.end());
+
+    auto rank = [&sorted, n](double p) {
+        size_t r = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(n)));
+        return sorted[r > 0 ? r - 1 : 0];
+    };
+
+    s.p50 = rank(50.0);
+    s.p90 = rank(90.0);
+    s.p99 = rank(99.0);
+    return s;
+}
+
+void LatencyStats::reset() {
+    std::fill(m_samples.begin(), m_samples.end(), 0);
+    m_next = 0;
+    m_count = 0;
+    m_max = 0;
+}
+
+} // namespace rcms
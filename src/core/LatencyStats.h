@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rcms {
+
+/**
+ * @brief Latency percentiles over a sliding window of samples
+ *
+ * Keeps the most recent samples in a fixed ring (allocated once), so
+ * recording is O(1) and percentiles reflect current bus conditions.
+ * Percentiles use the nearest-rank method.
+ */
+class LatencyStats {
+public:
+    struct Summary {
+        uint64_t count = 0;     // Samples recorded since reset
+        int64_t p50 = 0;
+        int64_t p90 = 0;
+        int64_t p99 = 0;
+        int64_t max = 0;        // Maximum since reset
+    };
+
+    explicit LatencyStats(size_t window = 1024);
+
+    /**
+     * @brief Record one sample (any unit, typically microseconds)
+     */
+    void record(int64_t value);
+
+    /**
+     * @brief Percentile over the window
+     * @param p Percentile in [0, 100]
+     * @return Sample value, 0 if no samples
+     */
+    int64_t percentile(double p) const;
+
+    Summary summary() const;
+
+    uint64_t count() const { return m_count; }
+    size_t windowSize() const { return m_samples.size(); }
+    void reset();
+
+private:
+    size_t filled() const;
+
+    std::vector<int64_t> m_samples;
+    size_t m_next = 0;
+    uint64_t m_count = 0;
+    int64_t m_max = 0;
+};
+
+} // namespace rcms
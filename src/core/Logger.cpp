@@ -1,28 +1,67 @@
 #include "Logger.h"
+#include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 
 namespace rcms {
 
+namespace {
+spdlog::async_overflow_policy toSpdlog(Logger::OverflowPolicy policy) {
+    switch (policy) {
+    case Logger::OverflowPolicy::Block:
+        return spdlog::async_overflow_policy::block;
+    case Logger::OverflowPolicy::DropNewest:
+#if SPDLOG_VERSION >= 11200
+        return spdlog::async_overflow_policy::discard_new;
+#else
+        return spdlog::async_overflow_policy::overrun_oldest;
+#endif
+    case Logger::OverflowPolicy::DropOldest:
+        break;
+    }
+    return spdlog::async_overflow_policy::overrun_oldest;
+}
+}
+
 void Logger::init(const std::string& logFile) {
+    Config config;
+    config.file = logFile;
+    init(config);
+}
+
+void Logger::init(const Config& config) {
     try {
+        std::vector<spdlog::sink_ptr> sinks;
+
         // Create console sink
-        auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-        console_sink->set_level(spdlog::level::debug);
+        if (config.console) {
+            auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+            console_sink->set_level(spdlog::level::debug);
+            sinks.push_back(console_sink);
+        }
 
-        // Create file sink (5 MB max, 3 rotated files)
+        // Create file sink (rotated by size)
         auto file_sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
-            logFile, 5 * 1024 * 1024, 3);
+            config.file, config.maxFileSize, config.maxFiles);
         file_sink->set_level(spdlog::level::debug);
+        sinks.push_back(file_sink);
 
-        // Create logger with both sinks
-        std::vector<spdlog::sink_ptr> sinks{console_sink, file_sink};
-        auto logger = std::make_shared<spdlog::logger>("rcms", sinks.begin(), sinks.end());
+        // Async: callers only enqueue; a single worker keeps sink order
+        std::shared_ptr<spdlog::logger> logger;
+        if (config.async) {
+            spdlog::init_thread_pool(config.queueSize, 1);
+            logger = std::make_shared<spdlog::async_logger>(
+                "rcms", sinks.begin(), sinks.end(), spdlog::thread_pool(),
+                toSpdlog(config.overflow));
+        } else {
+            logger = std::make_shared<spdlog::logger>("rcms", sinks.begin(), sinks.end());
+        }
         logger->set_level(spdlog::level::debug);
         logger->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] %v");
+        logger->flush_on(spdlog::level::err);
 
         spdlog::set_default_logger(logger);
-        spdlog::flush_every(std::chrono::seconds(3));
+        spdlog::flush_every(std::chrono::seconds(config.flushIntervalSec));
 
     } catch (const spdlog::spdlog_ex& ex) {
         // Fallback to console only
@@ -34,4 +73,16 @@ void Logger::shutdown() {
     spdlog::shutdown();
 }
 
+uint64_t Logger::droppedMessages() {
+    auto pool = spdlog::thread_pool();
+    if (!pool) {
+        return 0;
+    }
+#if SPDLOG_VERSION >= 11200
+    return pool->overrun_counter() + pool->discard_counter();
+#else
+    return pool->overrun_counter();
+#endif
+}
+
 } // namespace rcms
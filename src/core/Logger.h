@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <spdlog/spdlog.h>
 
@@ -8,10 +10,37 @@ namespace rcms {
 /**
  * @brief Application logger wrapper
  *
- * Provides unified logging interface using spdlog
+ * Provides unified logging interface using spdlog. Format strings are
+ * checked and parsed at compile time (spdlog::format_string_t), so a
+ * literal costs no std::string and no runtime parsing; arguments are only
+ * formatted when the level is enabled.
+ *
+ * In async mode (default) a call formats the message and hands it to a
+ * bounded queue; one worker thread writes the sinks and another flushes
+ * them periodically, so polling and bus threads never wait on file I/O.
  */
 class Logger {
 public:
+    /**
+     * @brief What to do when the async queue is full
+     */
+    enum class OverflowPolicy {
+        Block,          // Caller waits for space (nothing lost)
+        DropOldest,     // Overwrite the oldest queued message
+        DropNewest      // Discard the new message (spdlog >= 1.12, else DropOldest)
+    };
+
+    struct Config {
+        std::string file = "rcms-ga.log";
+        size_t maxFileSize = 5 * 1024 * 1024;
+        size_t maxFiles = 3;
+        bool console = true;
+        bool async = true;
+        size_t queueSize = 8192;                // Messages
+        OverflowPolicy overflow = OverflowPolicy::DropOldest;
+        int flushIntervalSec = 3;
+    };
+
     /**
      * @brief Initialize logging system
      * @param logFile Optional log file path
@@ -19,15 +48,25 @@ public:
     static void init(const std::string& logFile = "rcms-ga.log");
 
     /**
-     * @brief Shutdown logging system
+     * @brief Initialize logging system with explicit settings
+     */
+    static void init(const Config& config);
+
+    /**
+     * @brief Shutdown logging system (drains the async queue)
      */
     static void shutdown();
 
+    /**
+     * @brief Messages lost to a full async queue since init()
+     */
+    static uint64_t droppedMessages();
+
     /**
      * @brief Log debug message
      */
     template<typename... Args>
-    static void debug(const std::string& fmt, Args&&... args) {
+    static void debug(spdlog::format_string_t<Args...> fmt, Args&&... args) {
         spdlog::debug(fmt, std::forward<Args>(args)...);
     }
 
@@ -35,7 +74,7 @@ public:
      * @brief Log info message
      */
     template<typename... Args>
-    static void info(const std::string& fmt, Args&&... args) {
+    static void info(spdlog::format_string_t<Args...> fmt, Args&&... args) {
         spdlog::info(fmt, std::forward<Args>(args)...);
     }
 
@@ -43,7 +82,7 @@ public:
      * @brief Log warning message
      */
     template<typename... Args>
-    static void warn(const std::string& fmt, Args&&... args) {
+    static void warn(spdlog::format_string_t<Args...> fmt, Args&&... args) {
         spdlog::warn(fmt, std::forward<Args>(args)...);
     }
 
@@ -51,7 +90,7 @@ public:
      * @brief Log error message
      */
     template<typename... Args>
-    static void error(const std::string& fmt, Args&&... args) {
+    static void error(spdlog::format_string_t<Args...> fmt, Args&&... args) {
         spdlog::error(fmt, std::forward<Args>(args)...);
     }
 
@@ -59,7 +98,7 @@ public:
      * @brief Log critical message
      */
     template<typename... Args>
-    static void critical(const std::string& fmt, Args&&... args) {
+    static void critical(spdlog::format_string_t<Args...> fmt, Args&&... args) {
         spdlog::critical(fmt, std::forward<Args>(args)...);
     }
 };
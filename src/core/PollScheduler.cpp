@@ -0,0 +1,145 @@
+#include "PollScheduler.h"
+#include <algorithm>
+#include <limits>
+
+namespace rcms {
+
+PollScheduler::PollScheduler()
+    : PollScheduler(Config())
+{
+}
+
+PollScheduler::PollScheduler(const Config& config, uint32_t seed)
+    : m_config(config)
+    , m_rng(seed)
+{
+}
+
+void PollScheduler::add(Key key, int64_t intervalMs, int64_t nowMs) {
+    Entry entry;
+    entry.intervalMs = intervalMs > 0 ? intervalMs : 0;
+    entry.deadlineMs = nowMs;
+    m_entries[key] = entry;
+}
+
+void PollScheduler::remove(Key key) {
+    m_entries.erase(key);
+}
+
+void PollScheduler::setInterval(Key key, int64_t intervalMs) {
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        it->second.intervalMs = intervalMs > 0 ? intervalMs : 0;
+    }
+}
+
+size_t PollScheduler::takeDue(int64_t nowMs, std::vector<Task>& out) {
+    size_t taken = 0;
+    for (auto& kv : m_entries) {
+        Entry& entry = kv.second;
+        if (entry.inFlight || entry.deadlineMs > nowMs) {
+            continue;
+        }
+        entry.inFlight = true;
+        out.push_back(Task{kv.first, entry.backedOff ? Action::Probe : Action::Poll});
+        ++taken;
+    }
+    return taken;
+}
+
+void PollScheduler::complete(Key key, bool ok, int64_t nowMs) {
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    Entry& entry = it->second;
+    entry.inFlight = false;
+    const int64_t interval = intervalOf(entry);
+
+    if (ok) {
+        if (entry.backedOff) {
+            // Probe answered: full poll right away
+            entry.deadlineMs = nowMs;
+        } else {
+            // Steady cadence; skip missed slots instead of bursting
+            entry.deadlineMs += interval;
+            if (entry.deadlineMs <= nowMs) {
+                entry.deadlineMs = nowMs + interval;
+            }
+        }
+        entry.failures = 0;
+        entry.backedOff = false;
+        return;
+    }
+
+    ++entry.failures;
+    if (entry.failures < m_config.failuresBeforeBackoff) {
+        entry.deadlineMs = nowMs + interval;
+        return;
+    }
+
+    entry.backedOff = true;
+    entry.deadlineMs = nowMs + backoffDelay(entry);
+}
+
+void PollScheduler::reset(Key key, int64_t nowMs) {
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    Entry& entry = it->second;
+    entry.inFlight = false;
+    entry.failures = 0;
+    entry.backedOff = false;
+    entry.deadlineMs = nowMs;
+}
+
+int64_t PollScheduler::nextDeadline() const {
+    int64_t next = std::numeric_limits<int64_t>::max();
+    for (const auto& kv : m_entries) {
+        if (!kv.second.inFlight) {
+            next = std::min(next, kv.second.deadlineMs);
+        }
+    }
+    return next;
+}
+
+int64_t PollScheduler::deadline(Key key) const {
+    auto it = m_entries.find(key);
+    return it != m_entries.end() ? it->second.deadlineMs : 0;
+}
+
+int PollScheduler::failures(Key key) const {
+    auto it = m_entries.find(key);
+    return it != m_entries.end() ? it->second.failures : 0;
+}
+
+bool PollScheduler::isBackedOff(Key key) const {
+    auto it = m_entries.find(key);
+    return it != m_entries.end() && it->second.backedOff;
+}
+
+int64_t PollScheduler::intervalOf(const Entry& entry) const {
+    return entry.intervalMs > 0 ? entry.intervalMs : std::max<int64_t>(1, m_config.defaultIntervalMs);
+}
+
+int64_t PollScheduler::backoffDelay(const Entry& entry) {
+    // interval * 2^k, k counted from the first backed-off failure
+    const int64_t interval = intervalOf(entry);
+    int shift = std::min(entry.failures - m_config.failuresBeforeBackoff + 1, 20);
+    int64_t delay = interval;
+    for (int i = 0; i < shift && delay < m_config.maxBackoffMs; ++i) {
+        delay *= 2;
+    }
+    delay = std::min(delay, m_config.maxBackoffMs);
+
+    if (m_config.jitter > 0.0) {
+        std::uniform_real_distribution<double> dist(1.0 - m_config.jitter, 1.0 + m_config.jitter);
+        delay = static_cast<int64_t>(static_cast<double>(delay) * dist(m_rng));
+    }
+    return std::max<int64_t>(delay, 1);
+}
+
+} // namespace rcms
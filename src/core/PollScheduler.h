@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace rcms {
+
+/**
+ * @brief Deadline-based per-device poll scheduler
+ *
+ * Each device has its own interval and next deadline. Healthy devices
+ * keep a steady cadence anchored to their previous deadline; devices
+ * that stop answering are backed off exponentially (with jitter, so dead
+ * radios on one bus don't retry in lockstep) and come back through a
+ * cheap short-timeout probe instead of a full poll. Dead devices never
+ * delay the cadence of live ones.
+ *
+ * Time is passed in by the caller (monotonic milliseconds), so the
+ * scheduler has no clock or timer of its own.
+ */
+class PollScheduler {
+public:
+    using Key = const void*;
+
+    struct Config {
+        int64_t defaultIntervalMs = 1000;   // For devices added with interval 0
+        int64_t maxBackoffMs = 60000;       // Backoff ceiling
+        int failuresBeforeBackoff = 2;      // Plain retries before backing off
+        double jitter = 0.2;                // Backoff randomization, +/- fraction
+    };
+
+    enum class Action {
+        Poll,       // Full status poll
+        Probe       // Short-timeout reachability check
+    };
+
+    struct Task {
+        Key key;
+        Action action;
+    };
+
+    PollScheduler();
+    explicit PollScheduler(const Config& config, uint32_t seed = std::random_device{}());
+
+    /**
+     * @brief Register a device; first poll is due immediately
+     * @param intervalMs Poll interval, 0 for the default
+     */
+    void add(Key key, int64_t intervalMs, int64_t nowMs);
+    void remove(Key key);
+    bool contains(Key key) const { return m_entries.count(key) != 0; }
+
+    void setInterval(Key key, int64_t intervalMs);
+    void setDefaultInterval(int64_t intervalMs) { m_config.defaultIntervalMs = intervalMs; }
+    const Config& config() const { return m_config; }
+
+    /**
+     * @brief Collect devices whose deadline has passed
+     *
+     * Returned devices are marked in flight and are not returned again
+     * until complete() is called for them.
+     * @return Number of tasks appended to out
+     */
+    size_t takeDue(int64_t nowMs, std::vector<Task>& out);
+
+    /**
+     * @brief Report the outcome of a poll or probe
+     */
+    void complete(Key key, bool ok, int64_t nowMs);
+
+    /**
+     * @brief Start a device over: not in flight, no failures, due now
+     *
+     * For a device whose connection was closed or reopened: a request
+     * queued on the old connection is dropped with it and its complete()
+     * never comes.
+     */
+    void reset(Key key, int64_t nowMs);
+
+    /**
+     * @brief Earliest deadline among idle devices, INT64_MAX if none
+     */
+    int64_t nextDeadline() const;
+
+    // ========== State queries ==========
+
+    int64_t deadline(Key key) const;
+    int failures(Key key) const;
+    bool isBackedOff(Key key) const;
+
+private:
+    struct Entry {
+        int64_t intervalMs = 0;     // 0 = default
+        int64_t deadlineMs = 0;
+        int failures = 0;
+        bool inFlight = false;
+        bool backedOff = false;
+    };
+
+    int64_t intervalOf(const Entry& entry) const;
+    int64_t backoffDelay(const Entry& entry);
+
+    Config m_config;
+    std::unordered_map<Key, Entry> m_entries;
+    std::mt19937 m_rng;
+};
+
+} // namespace rcms
@@ -0,0 +1,50 @@
+#include "StatusDelta.h"
+
+namespace rcms {
+
+uint32_t diffStatus(const DeviceSnapshot& previous, const DeviceSnapshot& current) {
+    using namespace status_fields;
+    uint32_t changed = 0;
+
+    // All integers and enums: plain comparisons
+    if (previous.online != current.online) {
+        changed |= Online;
+    }
+    if (previous.frequencyHz != current.frequencyHz) {
+        changed |= Frequency;
+    }
+    if (previous.isTransmitting != current.isTransmitting) {
+        changed |= Transmitting;
+    }
+    if (previous.isReceiving != current.isReceiving) {
+        changed |= Receiving;
+    }
+    if (previous.squelchEnabled != current.squelchEnabled ||
+        previous.squelchLevel != current.squelchLevel) {
+        changed |= Squelch;
+    }
+    if (previous.signalLevel != current.signalLevel) {
+        changed |= SignalLevel;
+    }
+    if (previous.voltage24dV != current.voltage24dV ||
+        previous.batterydV != current.batterydV) {
+        changed |= Voltage;
+    }
+    if (previous.temperaturedC != current.temperaturedC) {
+        changed |= Temperature;
+    }
+    if (previous.operatingHours != current.operatingHours) {
+        changed |= OperatingHours;
+    }
+    if (previous.controlMode != current.controlMode || previous.workMode != current.workMode ||
+        previous.lineType != current.lineType) {
+        changed |= Mode;
+    }
+    if (previous.diagMask != current.diagMask) {
+        changed |= ErrorCodes;
+    }
+
+    return changed;
+}
+
+} // namespace rcms
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "protocol/DeviceSnapshot.h"
+#include <cstdint>
+
+namespace rcms {
+
+/**
+ * @brief DeviceSnapshot fields, one bit each, for change masks
+ */
+namespace status_fields {
+constexpr uint32_t Online = 1u << 0;
+constexpr uint32_t Frequency = 1u << 1;
+constexpr uint32_t Transmitting = 1u << 2;
+constexpr uint32_t Receiving = 1u << 3;
+constexpr uint32_t Squelch = 1u << 4;           // Enabled flag and level
+constexpr uint32_t SignalLevel = 1u << 5;
+constexpr uint32_t Voltage = 1u << 6;           // 24 V and battery
+constexpr uint32_t Temperature = 1u << 7;
+constexpr uint32_t OperatingHours = 1u << 8;
+constexpr uint32_t Mode = 1u << 9;              // Control, work mode, line type
+constexpr uint32_t ErrorCodes = 1u << 10;       // DiagVUU words
+constexpr uint32_t LastUpdate = 1u << 11;       // Never set by diffStatus()
+
+constexpr uint32_t All = (1u << 12) - 1;
+}
+
+/**
+ * @brief Status update with the fields changed since the previous one
+ *
+ * status always holds the complete current values; changed tells
+ * widgets which of them need redrawing.
+ */
+struct StatusDelta {
+    uint32_t changed = 0;
+    DeviceSnapshot status;
+
+    bool has(uint32_t fields) const { return (changed & fields) != 0; }
+
+    /**
+     * @brief Fold a newer update into this one (changes accumulate)
+     */
+    void merge(const StatusDelta& newer) {
+        changed |= newer.changed;
+        status = newer.status;
+    }
+
+    static StatusDelta full(const DeviceSnapshot& status) {
+        return StatusDelta{status_fields::All, status};
+    }
+};
+
+/**
+ * @brief Field-level change mask between two snapshots
+ *
+ * timestampNs is not compared: it changes on every successful poll.
+ */
+uint32_t diffStatus(const DeviceSnapshot& previous, const DeviceSnapshot& current);
+
+} // namespace rcms
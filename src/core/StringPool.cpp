@@ -0,0 +1,31 @@
+#include "StringPool.h"
+
+namespace rcms {
+
+StringPool::StringPool()
+    : m_strings(1)      // Handle 0 = empty string
+{
+    m_index.insert(QString(), 0);
+}
+
+StringPool::Handle StringPool::intern(const QString& str) {
+    if (str.isEmpty()) {
+        return 0;
+    }
+
+    auto it = m_index.constFind(str);
+    if (it != m_index.constEnd()) {
+        return *it;
+    }
+
+    const Handle handle = static_cast<Handle>(m_strings.size());
+    m_strings.append(str);
+    m_index.insert(str, handle);
+    return handle;
+}
+
+const QString& StringPool::str(Handle handle) const {
+    return handle < static_cast<Handle>(m_strings.size()) ? m_strings[handle] : m_strings[0];
+}
+
+} // namespace rcms
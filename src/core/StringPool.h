@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <cstdint>
+
+namespace rcms {
+
+/**
+ * @brief Interns strings into small integer handles
+ *
+ * Each distinct string is stored once; records keep the 32-bit handle.
+ * Handle 0 is always the empty string. Strings are never released, which
+ * suits bounded vocabularies such as device names and group ids.
+ */
+class StringPool {
+public:
+    using Handle = uint32_t;
+
+    StringPool();
+
+    /**
+     * @brief Handle for a string, adding it on first use
+     */
+    Handle intern(const QString& str);
+
+    /**
+     * @brief String for a handle; empty string for unknown handles
+     */
+    const QString& str(Handle handle) const;
+
+    /**
+     * @brief Handle for a string if already interned, 0 otherwise
+     */
+    Handle find(const QString& str) const { return m_index.value(str, 0); }
+
+    int size() const { return m_strings.size(); }
+
+private:
+    QVector<QString> m_strings;
+    QHash<QString, Handle> m_index;
+};
+
+} // namespace rcms
@@ -0,0 +1,701 @@
+#include "TelemetryArchive.h"
+#include "comm/CRC16.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rcms {
+
+namespace {
+
+constexpr uint32_t SEGMENT_MAGIC = 0x53415452;  // "RTAS"
+constexpr uint16_t SEGMENT_VERSION = 1;
+
+enum Column : size_t {
+    ColTimestamp,
+    ColVoltage,
+    ColTemperature,
+    ColFrequency,
+    ColSignal,
+    ColTransmitting,
+    COLUMN_COUNT
+};
+
+/**
+ * On-disk segment header, followed by the device name and the columns.
+ * Little-endian, segments padded to 8 bytes.
+ */
+struct SegmentHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t nameLength;
+    uint32_t totalSize;                             // Header to end of padding
+    uint32_t count;
+    int64_t firstMs;
+    int64_t lastMs;
+    double min[TelemetryArchive::METRIC_COUNT];
+    double max[TelemetryArchive::METRIC_COUNT];
+    double sum[TelemetryArchive::METRIC_COUNT];
+    uint32_t columnEnd[COLUMN_COUNT];               // Relative to the first column
+    uint16_t crc;                                   // Name and columns
+    uint16_t reserved0;
+    uint32_t reserved1;
+};
+static_assert(sizeof(SegmentHeader) % 8 == 0, "segment header must keep 8-byte alignment");
+
+// ========== Varint / zigzag ==========
+
+void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (unsigned shift = 0; shift < 64 && p < end; shift += 7) {
+        const uint8_t byte = *p++;
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+// ========== XOR float ==========
+
+// Control byte: high nibble = leading zero bytes, low nibble = trailing
+// zero bytes of (value ^ previous); the bytes in between follow. An
+// unchanged value is the single byte 0x80.
+void putXor(std::vector<uint8_t>& out, uint64_t bits, uint64_t& prev) {
+    const uint64_t x = bits ^ prev;
+    prev = bits;
+    if (x == 0) {
+        out.push_back(0x80);
+        return;
+    }
+    const unsigned lead = static_cast<unsigned>(__builtin_clzll(x)) / 8;
+    const unsigned trail = static_cast<unsigned>(__builtin_ctzll(x)) / 8;
+    out.push_back(static_cast<uint8_t>((lead << 4) | trail));
+    uint64_t v = x >> (trail * 8);
+    for (unsigned i = 0; i < 8 - lead - trail; ++i) {
+        out.push_back(static_cast<uint8_t>(v));
+        v >>= 8;
+    }
+}
+
+bool getXor(const uint8_t*& p, const uint8_t* end, uint64_t& prev) {
+    if (p >= end) {
+        return false;
+    }
+    const unsigned lead = *p >> 4;
+    const unsigned trail = *p & 0x0F;
+    ++p;
+    if (lead + trail > 8) {
+        return false;
+    }
+    const unsigned n = 8 - lead - trail;
+    if (n == 0) {
+        return true;        // Unchanged
+    }
+    if (static_cast<size_t>(end - p) < n) {
+        return false;
+    }
+    uint64_t v = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    }
+    p += n;
+    prev ^= v << (trail * 8);
+    return true;
+}
+
+uint64_t toBits(double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+double fromBits(uint64_t bits) {
+    double v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+} // anonymous namespace
+
+// ========== Cursor ==========
+
+bool TelemetryArchive::Cursor::next(Sample& out) {
+    if (m_remaining == 0) {
+        return false;
+    }
+
+    uint64_t dod = 0;
+    uint64_t signal = 0;
+    if (!getVarint(m_col[ColTimestamp], m_end[ColTimestamp], dod) ||
+        !getXor(m_col[ColVoltage], m_end[ColVoltage], m_bits[0]) ||
+        !getXor(m_col[ColTemperature], m_end[ColTemperature], m_bits[1]) ||
+        !getXor(m_col[ColFrequency], m_end[ColFrequency], m_bits[2]) ||
+        !getVarint(m_col[ColSignal], m_end[ColSignal], signal) ||
+        m_col[ColTransmitting] + m_index / 8 >= m_end[ColTransmitting]) {
+        m_remaining = 0;    // Corrupt: stop rather than read past the column
+        return false;
+    }
+
+    m_delta += unzigzag(dod);
+    m_ts += m_delta;
+    m_signal += unzigzag(signal);
+
+    out.timestampMs = m_ts;
+    out.voltage = fromBits(m_bits[0]);
+    out.temperature = fromBits(m_bits[1]);
+    out.frequencyMHz = fromBits(m_bits[2]);
+    out.signalLevel = static_cast<int32_t>(m_signal);
+    out.transmitting = (m_col[ColTransmitting][m_index / 8] >> (m_index % 8)) & 1;
+
+    ++m_index;
+    --m_remaining;
+    return true;
+}
+
+// ========== Archive ==========
+
+TelemetryArchive::TelemetryArchive() = default;
+
+TelemetryArchive::~TelemetryArchive() {
+    close();
+}
+
+bool TelemetryArchive::open(const std::string& path) {
+    close();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_lastError.clear();
+        m_stop = false;
+    }
+
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+        fail("open");
+        return false;
+    }
+    m_path = path;
+
+    if (!loadIndex()) {
+        unmap();
+        ::close(m_fd);
+        m_fd = -1;
+        m_devices.clear();
+        m_segmentCount = 0;
+        m_corruptSegments = 0;
+        return false;
+    }
+
+    m_fileEnd = m_size;
+    m_nextSweepMs = 0;
+    m_writer = std::thread(&TelemetryArchive::writerLoop, this);
+    return true;
+}
+
+void TelemetryArchive::close() {
+    if (m_fd < 0) {
+        return;
+    }
+    sealAll();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+    collect();
+
+    unmap();
+    ::close(m_fd);
+    m_fd = -1;
+    m_size = 0;
+    m_devices.clear();
+    m_segmentCount = 0;
+    m_corruptSegments = 0;
+}
+
+std::string TelemetryArchive::lastError() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastError;
+}
+
+void TelemetryArchive::fail(const std::string& what) {
+    const std::string message = what + ": " + std::strerror(errno);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastError = message;
+}
+
+bool TelemetryArchive::reserveMapping(size_t size) {
+    if (size <= m_mapped) {
+        return true;
+    }
+
+    // Pages past the file end are never touched; they become readable as
+    // the writer appends, so the mapping only moves every MAP_GROWTH bytes
+    const size_t length = (size + MAP_GROWTH - 1) / MAP_GROWTH * MAP_GROWTH;
+    void* data = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED) {
+        fail("mmap");
+        return false;
+    }
+    ::madvise(data, length, MADV_RANDOM);   // Scans touch few segments
+    unmap();
+    m_data = static_cast<const uint8_t*>(data);
+    m_mapped = length;
+    return true;
+}
+
+void TelemetryArchive::unmap() {
+    if (m_data) {
+        ::munmap(const_cast<uint8_t*>(m_data), m_mapped);
+    }
+    m_data = nullptr;
+    m_mapped = 0;
+}
+
+bool TelemetryArchive::loadIndex() {
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0) {
+        fail("fstat");
+        return false;
+    }
+    const size_t fileSize = static_cast<size_t>(st.st_size);
+    if (!reserveMapping(fileSize)) {
+        return false;
+    }
+
+    // Only a torn tail is cut off: an incomplete header, a segment running
+    // past EOF, or zeros left by a crash. A damaged segment further in is
+    // skipped by its size; a header that can't be trusted fails the open,
+    // so later segments are never deleted
+    size_t offset = 0;
+    while (offset + sizeof(SegmentHeader) <= fileSize) {
+        SegmentHeader h;
+        std::memcpy(&h, m_data + offset, sizeof(h));
+
+        const size_t payload = sizeof(h) + h.nameLength;
+        const bool sane = h.magic == SEGMENT_MAGIC && h.version == SEGMENT_VERSION &&
+                          h.totalSize % 8 == 0 && h.totalSize >= payload;
+        if (!sane) {
+            if (std::all_of(m_data + offset, m_data + fileSize, [](uint8_t b) { return b == 0; })) {
+                break;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_lastError = "corrupt segment header at offset " + std::to_string(offset);
+            return false;
+        }
+        if (h.totalSize > fileSize - offset) {
+            break;
+        }
+
+        bool valid = h.count > 0;
+        for (size_t c = 0; valid && c < COLUMN_COUNT; ++c) {
+            valid = (c == 0 || h.columnEnd[c] >= h.columnEnd[c - 1]) &&
+                    payload + h.columnEnd[c] <= h.totalSize;
+        }
+        if (valid) {
+            const uint8_t* body = m_data + offset + sizeof(h);
+            valid = CRC16::calculate(body, h.nameLength + h.columnEnd[COLUMN_COUNT - 1]) == h.crc;
+        }
+        if (!valid) {
+            ++m_corruptSegments;
+            offset += h.totalSize;
+            continue;
+        }
+
+        SegmentInfo info;
+        info.offset = offset;
+        info.count = h.count;
+        info.firstMs = h.firstMs;
+        info.lastMs = h.lastMs;
+        info.bytes = h.totalSize;
+        for (size_t m = 0; m < METRIC_COUNT; ++m) {
+            info.min[m] = h.min[m];
+            info.max[m] = h.max[m];
+            info.sum[m] = h.sum[m];
+        }
+
+        std::string name(reinterpret_cast<const char*>(m_data + offset + sizeof(h)), h.nameLength);
+        m_devices[name].segments.push_back(info);
+        ++m_segmentCount;
+        offset += h.totalSize;
+    }
+
+    // Torn tail from a crash during append: cut it so new segments follow
+    // the last good one
+    if (offset != fileSize && ::ftruncate(m_fd, static_cast<off_t>(offset)) != 0) {
+        fail("ftruncate");
+        return false;
+    }
+    m_size = offset;
+
+    for (auto& entry : m_devices) {
+        auto& list = entry.second.segments;
+        std::sort(list.begin(), list.end(), [](const SegmentInfo& a, const SegmentInfo& b) {
+            return a.firstMs < b.firstMs;
+        });
+    }
+    return true;
+}
+
+void TelemetryArchive::append(const std::string& device, const Sample& sample) {
+    if (m_fd < 0) {
+        return;
+    }
+    collect();
+
+    auto it = m_devices.find(device);
+    if (it == m_devices.end()) {
+        it = m_devices.emplace(device, DeviceIndex()).first;
+    }
+    DeviceIndex& index = it->second;
+
+    // A segment never spans more than maxPendingMs
+    if (!index.pending.empty() &&
+        sample.timestampMs - index.pending.front().timestampMs >= m_maxPendingMs) {
+        seal(it->first, index);
+    }
+    index.pending.push_back(sample);
+    if (index.pending.size() >= SEGMENT_SAMPLES) {
+        seal(it->first, index);
+    }
+
+    // Devices that went quiet are sealed against the others' clock
+    if (sample.timestampMs >= m_nextSweepMs) {
+        sealStale(sample.timestampMs);
+        m_nextSweepMs = sample.timestampMs + std::max<int64_t>(m_maxPendingMs / 4, 1);
+    }
+}
+
+void TelemetryArchive::sealStale(int64_t nowMs) {
+    for (auto& entry : m_devices) {
+        const std::vector<Sample>& pending = entry.second.pending;
+        if (!pending.empty() && nowMs - pending.front().timestampMs >= m_maxPendingMs) {
+            seal(entry.first, entry.second);
+        }
+    }
+}
+
+bool TelemetryArchive::flush() {
+    if (m_fd < 0) {
+        return true;
+    }
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_drained.wait(lock, [this]() { return m_jobs.empty() && !m_busy; });
+    }
+    return collect();
+}
+
+bool TelemetryArchive::sealAll() {
+    for (auto& entry : m_devices) {
+        seal(entry.first, entry.second);
+    }
+    return flush();
+}
+
+void TelemetryArchive::seal(const std::string& device, DeviceIndex& index) {
+    if (index.pending.empty()) {
+        return;
+    }
+
+    // The buffer moves to the writer; a recycled one takes its place
+    index.sealing.emplace_back();
+    index.sealing.back().swap(index.pending);
+    index.pending.swap(m_spare);
+    index.pending.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(SealJob{&device, &index, &index.sealing.back(), SegmentInfo(), false});
+    }
+    m_wake.notify_one();
+}
+
+bool TelemetryArchive::collect() {
+    std::vector<SealJob> done;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_done.empty()) {
+            return true;
+        }
+        done.swap(m_done);
+    }
+
+    // Jobs finish in the order they were queued: the front batch is theirs
+    bool ok = true;
+    for (const SealJob& job : done) {
+        DeviceIndex& index = *job.index;
+        std::vector<Sample>& batch = index.sealing.front();
+        if (job.ok) {
+            // A retried batch may land after newer ones: keep time order
+            auto& list = index.segments;
+            auto pos = std::upper_bound(list.begin(), list.end(), job.info.firstMs,
+                                        [](int64_t t, const SegmentInfo& s) {
+                                            return t < s.firstMs;
+                                        });
+            list.insert(pos, job.info);
+            ++m_segmentCount;
+            m_size = std::max(m_size, job.info.offset + job.info.bytes);
+        } else {
+            // Buffered again, ahead of what arrived meanwhile
+            batch.insert(batch.end(), index.pending.begin(), index.pending.end());
+            index.pending.swap(batch);
+            ok = false;
+        }
+        batch.clear();
+        m_spare.swap(batch);
+        index.sealing.pop_front();
+    }
+    return reserveMapping(m_size) && ok;
+}
+
+void TelemetryArchive::writerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+        if (m_jobs.empty()) {
+            break;  // Stopping with nothing left
+        }
+
+        SealJob job = m_jobs.front();
+        m_jobs.pop_front();
+        m_busy = true;
+
+        lock.unlock();
+        job.ok = writeSegment(*job.device, *job.samples, job.info);
+        lock.lock();
+
+        m_busy = false;
+        m_done.push_back(job);
+        m_drained.notify_all();
+    }
+}
+
+bool TelemetryArchive::writeSegment(const std::string& device, const std::vector<Sample>& samples,
+                                    SegmentInfo& info) {
+    SegmentHeader h{};
+    h.magic = SEGMENT_MAGIC;
+    h.version = SEGMENT_VERSION;
+    h.nameLength = static_cast<uint16_t>(std::min<size_t>(device.size(), UINT16_MAX));
+    h.count = static_cast<uint32_t>(samples.size());
+    h.firstMs = samples.front().timestampMs;
+    h.lastMs = samples.back().timestampMs;
+    for (size_t m = 0; m < METRIC_COUNT; ++m) {
+        const double v = samples.front().value(static_cast<Metric>(m));
+        h.min[m] = h.max[m] = v;
+    }
+    for (const Sample& s : samples) {
+        for (size_t m = 0; m < METRIC_COUNT; ++m) {
+            const double v = s.value(static_cast<Metric>(m));
+            h.min[m] = std::min(h.min[m], v);
+            h.max[m] = std::max(h.max[m], v);
+            h.sum[m] += v;
+        }
+    }
+
+    // Columns one after another, each encoded in a single pass
+    std::vector<uint8_t>& buf = m_encodeBuffer;
+    buf.assign(sizeof(h), 0);
+    buf.insert(buf.end(), device.begin(), device.begin() + h.nameLength);
+    const size_t columnsStart = buf.size();
+
+    int64_t prevTs = h.firstMs;
+    int64_t prevDelta = 0;
+    for (const Sample& s : samples) {
+        const int64_t delta = s.timestampMs - prevTs;
+        putVarint(buf, zigzag(delta - prevDelta));
+        prevDelta = delta;
+        prevTs = s.timestampMs;
+    }
+    h.columnEnd[ColTimestamp] = static_cast<uint32_t>(buf.size() - columnsStart);
+
+    uint64_t prevBits = 0;
+    for (const Sample& s : samples) {
+        putXor(buf, toBits(s.voltage), prevBits);
+    }
+    h.columnEnd[ColVoltage] = static_cast<uint32_t>(buf.size() - columnsStart);
+
+    prevBits = 0;
+    for (const Sample& s : samples) {
+        putXor(buf, toBits(s.temperature), prevBits);
+    }
+    h.columnEnd[ColTemperature] = static_cast<uint32_t>(buf.size() - columnsStart);
+
+    prevBits = 0;
+    for (const Sample& s : samples) {
+        putXor(buf, toBits(s.frequencyMHz), prevBits);
+    }
+    h.columnEnd[ColFrequency] = static_cast<uint32_t>(buf.size() - columnsStart);
+
+    int64_t prevSignal = 0;
+    for (const Sample& s : samples) {
+        putVarint(buf, zigzag(static_cast<int64_t>(s.signalLevel) - prevSignal));
+        prevSignal = s.signalLevel;
+    }
+    h.columnEnd[ColSignal] = static_cast<uint32_t>(buf.size() - columnsStart);
+
+    const size_t bitmapStart = buf.size();
+    buf.resize(bitmapStart + (samples.size() + 7) / 8, 0);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        if (samples[i].transmitting) {
+            buf[bitmapStart + i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+        }
+    }
+    h.columnEnd[ColTransmitting] = static_cast<uint32_t>(buf.size() - columnsStart);
+
+    h.crc = CRC16::calculate(buf.data() + sizeof(h), buf.size() - sizeof(h));
+    buf.resize((buf.size() + 7) & ~size_t(7), 0);
+    h.totalSize = static_cast<uint32_t>(buf.size());
+    std::memcpy(buf.data(), &h, sizeof(h));
+
+    // O_APPEND: the segment lands after the last sealed one
+    const size_t offset = m_fileEnd;
+    size_t written = 0;
+    while (written < buf.size()) {
+        const ssize_t n = ::write(m_fd, buf.data() + written, buf.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fail("write");
+            // Drop the partial segment so the file stays well-formed
+            if (::ftruncate(m_fd, static_cast<off_t>(offset)) != 0) {
+                fail("ftruncate");
+            }
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    // Not durable is as bad as not written: the samples stay buffered
+    if (::fdatasync(m_fd) != 0) {
+        fail("fdatasync");
+        if (::ftruncate(m_fd, static_cast<off_t>(offset)) != 0) {
+            fail("ftruncate");
+        }
+        return false;
+    }
+    m_fileEnd = offset + buf.size();
+
+    info.offset = offset;
+    info.count = h.count;
+    info.firstMs = h.firstMs;
+    info.lastMs = h.lastMs;
+    info.bytes = h.totalSize;
+    for (size_t m = 0; m < METRIC_COUNT; ++m) {
+        info.min[m] = h.min[m];
+        info.max[m] = h.max[m];
+        info.sum[m] = h.sum[m];
+    }
+    return true;
+}
+
+std::vector<TelemetryArchive::SegmentInfo> TelemetryArchive::segments(
+    const std::string& device, int64_t fromMs, int64_t toMs) const {
+    std::vector<SegmentInfo> result;
+
+    auto it = m_devices.find(device);
+    if (it == m_devices.end()) {
+        return result;
+    }
+
+    // Segments of a device are in time order: skip to the first one that
+    // can reach fromMs without touching the others
+    const auto& list = it->second.segments;
+    auto first = std::lower_bound(list.begin(), list.end(), fromMs,
+                                  [](const SegmentInfo& s, int64_t t) { return s.lastMs < t; });
+    for (auto s = first; s != list.end() && s->firstMs <= toMs; ++s) {
+        result.push_back(*s);
+    }
+    return result;
+}
+
+TelemetryArchive::Cursor TelemetryArchive::cursor(const SegmentInfo& segment) const {
+    Cursor c;
+    if (!m_data || segment.offset + segment.bytes > m_size) {
+        return c;
+    }
+
+    SegmentHeader h;
+    std::memcpy(&h, m_data + segment.offset, sizeof(h));
+    const uint8_t* columns = m_data + segment.offset + sizeof(h) + h.nameLength;
+
+    for (size_t col = 0; col < COLUMN_COUNT; ++col) {
+        c.m_col[col] = columns + (col == 0 ? 0 : h.columnEnd[col - 1]);
+        c.m_end[col] = columns + h.columnEnd[col];
+    }
+    c.m_remaining = h.count;
+    c.m_ts = h.firstMs;
+    return c;
+}
+
+TelemetryArchive::Summary TelemetryArchive::summarize(const std::string& device, Metric metric,
+                                                      int64_t fromMs, int64_t toMs) const {
+    Summary summary;
+    double sum = 0.0;
+    const size_t m = static_cast<size_t>(metric);
+
+    auto add = [&summary, &sum](double min, double max, double total, uint64_t count) {
+        if (summary.count == 0) {
+            summary.min = min;
+            summary.max = max;
+        } else {
+            summary.min = std::min(summary.min, min);
+            summary.max = std::max(summary.max, max);
+        }
+        sum += total;
+        summary.count += count;
+    };
+
+    Sample s;
+    for (const SegmentInfo& segment : segments(device, fromMs, toMs)) {
+        if (segment.firstMs >= fromMs && segment.lastMs <= toMs) {
+            add(segment.min[m], segment.max[m], segment.sum[m], segment.count);
+            continue;
+        }
+        ++summary.segmentsDecoded;
+        Cursor c = cursor(segment);
+        while (c.next(s)) {
+            if (s.timestampMs >= fromMs && s.timestampMs <= toMs) {
+                const double v = s.value(metric);
+                add(v, v, v, 1);
+            }
+        }
+    }
+
+    forEachBuffered(device, [&](const Sample& p) {
+        if (p.timestampMs >= fromMs && p.timestampMs <= toMs) {
+            const double v = p.value(metric);
+            add(v, v, v, 1);
+        }
+    });
+
+    summary.avg = summary.count > 0 ? sum / static_cast<double>(summary.count) : 0.0;
+    return summary;
+}
+
+} // namespace rcms
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "TelemetryStore.h"
+
+namespace rcms {
+
+/**
+ * @brief Append-only columnar archive for long-term telemetry retention
+ *
+ * Samples are buffered per device and sealed into immutable segments of
+ * up to SEGMENT_SAMPLES samples, or fewer once the oldest buffered sample
+ * is maxPendingMs old, appended to a single file. Each segment stores its
+ * columns separately:
+ *  - timestamps: delta-of-delta, zigzag varint (1 byte per regular poll)
+ *  - voltage, temperature, frequency: XOR with the previous value,
+ *    leading/trailing zero bytes dropped (1 byte when unchanged)
+ *  - signal level: delta, zigzag varint
+ *  - transmitting: bitmap
+ *
+ * The segment header carries the device, time range, per-metric
+ * min/max/sum and a CRC. The file is memory-mapped; range scans pick
+ * segments by the in-memory index and decode straight from the mapping.
+ * A torn tail left by a crash is cut off on open. A damaged segment
+ * elsewhere is skipped and counted, and a damaged header fails the open;
+ * neither ever truncates the data after it.
+ *
+ * Sealing hands the device's buffer to a writer thread, which encodes,
+ * writes and fdatasyncs the segment. Finished segments enter the index on
+ * the owner's next append(), flush() or sealAll(); until then their
+ * samples are still served from memory. The mapping reserves address
+ * space ahead of the file end, so it only moves every MAP_GROWTH bytes.
+ *
+ * Not thread-safe: call from one thread. Cursors are invalidated by the
+ * next append(), flush() or sealAll().
+ */
+class TelemetryArchive {
+public:
+    using Sample = TelemetryStore::Sample;
+    using Metric = TelemetryStore::Metric;
+
+    static constexpr size_t METRIC_COUNT = TelemetryStore::METRIC_COUNT;
+
+    // One hour per device at 1 Hz
+    static constexpr uint32_t SEGMENT_SAMPLES = 3600;
+
+    // Longest a sample stays buffered (by sample time) before it is sealed
+    static constexpr int64_t DEFAULT_MAX_PENDING_MS = 15 * 60 * 1000;
+
+    // Address space reserved ahead of the file end
+    static constexpr size_t MAP_GROWTH = size_t(64) << 20;
+
+    /**
+     * @brief Index entry of one sealed segment
+     */
+    struct SegmentInfo {
+        size_t offset = 0;          // In the file
+        uint32_t count = 0;
+        int64_t firstMs = 0;
+        int64_t lastMs = 0;
+        std::array<double, METRIC_COUNT> min{};
+        std::array<double, METRIC_COUNT> max{};
+        std::array<double, METRIC_COUNT> sum{};
+        size_t bytes = 0;           // Whole segment, header included
+    };
+
+    /**
+     * @brief Min/max/avg of one metric over a time range
+     */
+    struct Summary {
+        double min = 0.0;
+        double max = 0.0;
+        double avg = 0.0;
+        uint64_t count = 0;
+        size_t segmentsDecoded = 0; // Segments not answered by the index alone
+    };
+
+    /**
+     * @brief Sequential decoder over one mapped segment
+     */
+    class Cursor {
+    public:
+        Cursor() = default;
+        bool next(Sample& out);
+
+    private:
+        friend class TelemetryArchive;
+
+        const uint8_t* m_col[6] = {};
+        const uint8_t* m_end[6] = {};
+        uint32_t m_remaining = 0;
+        uint32_t m_index = 0;
+        int64_t m_ts = 0;
+        int64_t m_delta = 0;
+        uint64_t m_bits[3] = {};
+        int64_t m_signal = 0;
+    };
+
+    TelemetryArchive();
+    ~TelemetryArchive();
+
+    TelemetryArchive(const TelemetryArchive&) = delete;
+    TelemetryArchive& operator=(const TelemetryArchive&) = delete;
+
+    /**
+     * @brief Open (create) an archive file and index its segments
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Seal buffered samples, stop the writer and unmap
+     */
+    void close();
+
+    bool isOpen() const { return m_fd >= 0; }
+    std::string lastError() const;
+
+    /**
+     * @brief Bound on buffered (unsealed) data per device, in sample time
+     *
+     * Also applies to devices that stopped reporting: they are sealed
+     * once other devices' samples are that much newer.
+     */
+    void setMaxPendingMs(int64_t ms) { m_maxPendingMs = ms; }
+    int64_t maxPendingMs() const { return m_maxPendingMs; }
+
+    /**
+     * @brief Buffer a sample; hands the device's buffer to the writer
+     *        when full or too old
+     *
+     * Samples of one device are expected in time order.
+     */
+    void append(const std::string& device, const Sample& sample);
+
+    /**
+     * @brief Wait for segments handed to the writer and index them
+     * @return false if one of them failed (its samples are buffered again)
+     */
+    bool flush();
+
+    /**
+     * @brief Write every device's buffered samples as segments and wait
+     */
+    bool sealAll();
+
+    /**
+     * @brief Sealed segments of a device overlapping [fromMs, toMs]
+     */
+    std::vector<SegmentInfo> segments(const std::string& device,
+                                      int64_t fromMs, int64_t toMs) const;
+
+    /**
+     * @brief Decoder for a sealed segment (from segments())
+     */
+    Cursor cursor(const SegmentInfo& segment) const;
+
+    /**
+     * @brief Call fn(const Sample&) for every sample in [fromMs, toMs],
+     *        sealed and buffered, in time order
+     * @return Number of samples visited
+     */
+    template <typename Fn>
+    size_t scan(const std::string& device, int64_t fromMs, int64_t toMs, Fn&& fn) const;
+
+    /**
+     * @brief Min/max/avg of a metric; segments that lie entirely inside
+     *        the range are answered from the index without decoding
+     */
+    Summary summarize(const std::string& device, Metric metric,
+                      int64_t fromMs, int64_t toMs) const;
+
+    size_t segmentCount() const { return m_segmentCount; }
+
+    /**
+     * @brief Segments skipped on open for a bad CRC or column table
+     */
+    size_t corruptSegments() const { return m_corruptSegments; }
+    size_t fileSize() const { return m_size; }
+
+private:
+    struct DeviceIndex {
+        std::vector<SegmentInfo> segments;  // Time order
+        std::list<std::vector<Sample>> sealing; // With the writer, oldest first
+        std::vector<Sample> pending;
+    };
+
+    // One segment handed to the writer
+    struct SealJob {
+        const std::string* device;          // Key in m_devices
+        DeviceIndex* index;
+        const std::vector<Sample>* samples; // In index->sealing, untouched until collected
+        SegmentInfo info;
+        bool ok = false;
+    };
+
+    void seal(const std::string& device, DeviceIndex& index);
+    void sealStale(int64_t nowMs);
+    bool collect();
+    void writerLoop();
+    bool writeSegment(const std::string& device, const std::vector<Sample>& samples,
+                      SegmentInfo& info);
+    bool reserveMapping(size_t size);
+    void unmap();
+    bool loadIndex();
+    void fail(const std::string& what);
+    template <typename Fn>
+    void forEachBuffered(const std::string& device, Fn&& fn) const;
+
+    std::string m_path;
+    int m_fd = -1;
+    const uint8_t* m_data = nullptr;
+    size_t m_mapped = 0;                // Mapping length, >= m_size
+    size_t m_size = 0;                  // Indexed bytes
+    size_t m_segmentCount = 0;
+    size_t m_corruptSegments = 0;
+    int64_t m_maxPendingMs = DEFAULT_MAX_PENDING_MS;
+    int64_t m_nextSweepMs = 0;
+    std::unordered_map<std::string, DeviceIndex> m_devices;
+    std::vector<Sample> m_spare;        // Recycled sample buffer
+
+    // Writer thread only
+    size_t m_fileEnd = 0;
+    std::vector<uint8_t> m_encodeBuffer;
+
+    // Shared with the writer, guarded by m_mutex
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_drained;
+    std::deque<SealJob> m_jobs;
+    std::vector<SealJob> m_done;
+    bool m_busy = false;
+    bool m_stop = false;
+    std::string m_lastError;
+
+    std::thread m_writer;
+};
+
+template <typename Fn>
+size_t TelemetryArchive::scan(const std::string& device, int64_t fromMs, int64_t toMs,
+                              Fn&& fn) const {
+    size_t visited = 0;
+    Sample s;
+
+    for (const SegmentInfo& segment : segments(device, fromMs, toMs)) {
+        Cursor c = cursor(segment);
+        while (c.next(s)) {
+            if (s.timestampMs < fromMs) {
+                continue;
+            }
+            if (s.timestampMs > toMs) {
+                break;
+            }
+            fn(static_cast<const Sample&>(s));
+            ++visited;
+        }
+    }
+
+    forEachBuffered(device, [&](const Sample& p) {
+        if (p.timestampMs >= fromMs && p.timestampMs <= toMs) {
+            fn(p);
+            ++visited;
+        }
+    });
+    return visited;
+}
+
+template <typename Fn>
+void TelemetryArchive::forEachBuffered(const std::string& device, Fn&& fn) const {
+    auto it = m_devices.find(device);
+    if (it == m_devices.end()) {
+        return;
+    }
+    for (const std::vector<Sample>& batch : it->second.sealing) {
+        for (const Sample& s : batch) {
+            fn(s);
+        }
+    }
+    for (const Sample& s : it->second.pending) {
+        fn(s);
+    }
+}
+
+} // namespace rcms
@@ -0,0 +1,590 @@
+#include "TelemetryStore.h"
+#include <sqlite3.h>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+namespace rcms {
+
+namespace {
+const char* const SCHEMA =
+    "CREATE TABLE IF NOT EXISTS devices ("
+    "  id INTEGER PRIMARY KEY,"
+    "  name TEXT NOT NULL UNIQUE"
+    ");"
+    "CREATE TABLE IF NOT EXISTS samples ("
+    "  device INTEGER NOT NULL,"
+    "  ts INTEGER NOT NULL,"
+    "  voltage REAL,"
+    "  temperature REAL,"
+    "  signal INTEGER,"
+    "  frequency REAL,"
+    "  tx INTEGER,"
+    "  PRIMARY KEY (device, ts)"
+    ") WITHOUT ROWID;"
+    // One row per (resolution, device, metric, bucket); avg = sum / count
+    "CREATE TABLE IF NOT EXISTS rollups ("
+    "  resolution INTEGER NOT NULL,"
+    "  device INTEGER NOT NULL,"
+    "  metric INTEGER NOT NULL,"
+    "  bucket INTEGER NOT NULL,"
+    "  min REAL NOT NULL,"
+    "  max REAL NOT NULL,"
+    "  sum REAL NOT NULL,"
+    "  count INTEGER NOT NULL,"
+    "  PRIMARY KEY (resolution, device, metric, bucket)"
+    ") WITHOUT ROWID;";
+
+// Indexed by Metric
+const char* const SELECT_RAW[TelemetryStore::METRIC_COUNT] = {
+    "SELECT ts, voltage FROM samples WHERE device = ? AND ts BETWEEN ? AND ? ORDER BY ts",
+    "SELECT ts, temperature FROM samples WHERE device = ? AND ts BETWEEN ? AND ? ORDER BY ts",
+    "SELECT ts, signal FROM samples WHERE device = ? AND ts BETWEEN ? AND ? ORDER BY ts",
+    "SELECT ts, frequency FROM samples WHERE device = ? AND ts BETWEEN ? AND ? ORDER BY ts",
+    "SELECT ts, tx FROM samples WHERE device = ? AND ts BETWEEN ? AND ? ORDER BY ts",
+};
+
+const char* const SELECT_ROLLUP =
+    "SELECT bucket, min, max, sum, count FROM rollups"
+    "  WHERE resolution = ? AND device = ? AND metric = ? AND bucket BETWEEN ? AND ?"
+    "  ORDER BY bucket";
+
+constexpr int64_t MINUTE_MS = 60 * 1000;
+constexpr int64_t HOUR_MS = 60 * MINUTE_MS;
+
+// Above this many raw points a coarser resolution is used
+constexpr int64_t MAX_POINTS = 4000;
+
+int64_t bucketStart(int64_t timeMs, int64_t widthMs) {
+    int64_t r = timeMs % widthMs;
+    if (r < 0) {
+        r += widthMs;
+    }
+    return timeMs - r;
+}
+
+int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+}
+
+double TelemetryStore::Sample::value(Metric metric) const {
+    switch (metric) {
+    case Metric::Voltage:      return voltage;
+    case Metric::Temperature:  return temperature;
+    case Metric::SignalLevel:  return signalLevel;
+    case Metric::Frequency:    return frequencyMHz;
+    case Metric::Transmitting: return transmitting ? 1.0 : 0.0;
+    }
+    return 0.0;
+}
+
+void TelemetryStore::Bucket::add(double v) {
+    if (count == 0) {
+        min = max = sum = v;
+    } else {
+        min = std::min(min, v);
+        max = std::max(max, v);
+        sum += v;
+    }
+    ++count;
+}
+
+TelemetryStore::TelemetryStore() = default;
+
+TelemetryStore::~TelemetryStore() {
+    close();
+}
+
+bool TelemetryStore::open(const std::string& path) {
+    return open(path, Config());
+}
+
+bool TelemetryStore::open(const std::string& path, const Config& config) {
+    close();
+    m_config = config;
+
+    if (sqlite3_open(path.c_str(), &m_db) != SQLITE_OK) {
+        setError("open: " + std::string(sqlite3_errmsg(m_db)));
+        sqlite3_close(m_db);
+        m_db = nullptr;
+        return false;
+    }
+
+    if (!exec("PRAGMA journal_mode=WAL;") || !exec("PRAGMA synchronous=NORMAL;") ||
+        !exec(SCHEMA)) {
+        sqlite3_close(m_db);
+        m_db = nullptr;
+        return false;
+    }
+
+    bool prepared =
+        sqlite3_prepare_v2(m_db,
+                           "INSERT OR REPLACE INTO samples"
+                           " (device, ts, voltage, temperature, signal, frequency, tx)"
+                           " VALUES (?, ?, ?, ?, ?, ?, ?)", -1, &m_insertSample,
+                           nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_db,
+                           "INSERT OR REPLACE INTO rollups"
+                           " (resolution, device, metric, bucket, min, max, sum, count)"
+                           " VALUES (?, ?, ?, ?, ?, ?, ?, ?)", -1, &m_upsertRollup,
+                           nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(m_db, "INSERT OR IGNORE INTO devices (id, name) VALUES (?, ?)",
+                           -1, &m_insertDevice, nullptr) == SQLITE_OK;
+    if (!prepared) {
+        setError("prepare: " + std::string(sqlite3_errmsg(m_db)));
+        finalize();
+        return false;
+    }
+
+    m_path = path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = false;
+        m_ingested = m_written = m_dropped = m_writeFailures = 0;
+    }
+
+    if (!loadState()) {
+        finalize();
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_readMutex);
+        if (sqlite3_open_v2(path.c_str(), &m_reader, SQLITE_OPEN_READONLY,
+                            nullptr) != SQLITE_OK) {
+            sqlite3_close(m_reader);
+            m_reader = nullptr;
+        }
+    }
+
+    m_writer = std::thread(&TelemetryStore::writerLoop, this);
+    return true;
+}
+
+bool TelemetryStore::loadState() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_devices.clear();
+    m_dirty.clear();
+    m_raw.clear();
+    m_closed.clear();
+    m_newDevices.clear();
+    m_nextDeviceId = 1;
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(m_db, "SELECT id, name FROM devices", -1, &stmt,
+                           nullptr) != SQLITE_OK) {
+        m_lastError = "load: " + std::string(sqlite3_errmsg(m_db));
+        return false;
+    }
+    std::unordered_map<uint32_t, DeviceState*> byId;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const uint32_t id = static_cast<uint32_t>(sqlite3_column_int64(stmt, 0));
+        const unsigned char* name = sqlite3_column_text(stmt, 1);
+        DeviceState& state = m_devices[name ? reinterpret_cast<const char*>(name) : ""];
+        state.id = id;
+        byId[id] = &state;
+        m_nextDeviceId = std::max(m_nextDeviceId, id + 1);
+    }
+    sqlite3_finalize(stmt);
+
+    // Resume the buckets still open, so a restart doesn't overwrite their
+    // stored partial aggregates with post-restart data only
+    if (sqlite3_prepare_v2(m_db,
+                           "SELECT device, metric, bucket, min, max, sum, count FROM rollups"
+                           "  WHERE resolution = ? AND bucket >= ?", -1, &stmt,
+                           nullptr) != SQLITE_OK) {
+        m_lastError = "load: " + std::string(sqlite3_errmsg(m_db));
+        return false;
+    }
+    const int64_t now = nowMs();
+    for (size_t level = 0; level < ROLLUP_LEVELS; ++level) {
+        const Resolution resolution = static_cast<Resolution>(level + 1);
+        sqlite3_bind_int(stmt, 1, static_cast<int>(resolution));
+        sqlite3_bind_int64(stmt, 2, bucketStart(now, bucketWidthMs(resolution)));
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            auto it = byId.find(static_cast<uint32_t>(sqlite3_column_int64(stmt, 0)));
+            const int metric = sqlite3_column_int(stmt, 1);
+            if (it == byId.end() || metric < 0 || metric >= static_cast<int>(METRIC_COUNT)) {
+                continue;
+            }
+            Bucket& b = it->second->buckets[metric][level];
+            b.start = sqlite3_column_int64(stmt, 2);
+            b.min = sqlite3_column_double(stmt, 3);
+            b.max = sqlite3_column_double(stmt, 4);
+            b.sum = sqlite3_column_double(stmt, 5);
+            b.count = static_cast<uint32_t>(sqlite3_column_int64(stmt, 6));
+        }
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    return true;
+}
+
+void TelemetryStore::close() {
+    if (m_writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_writer.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_readMutex);
+        sqlite3_close(m_reader);
+        m_reader = nullptr;
+    }
+
+    if (m_db) {
+        finalize();
+    }
+}
+
+void TelemetryStore::finalize() {
+    sqlite3_finalize(m_insertSample);
+    sqlite3_finalize(m_upsertRollup);
+    sqlite3_finalize(m_insertDevice);
+    m_insertSample = m_upsertRollup = m_insertDevice = nullptr;
+    sqlite3_close(m_db);
+    m_db = nullptr;
+}
+
+std::string TelemetryStore::lastError() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastError;
+}
+
+void TelemetryStore::setError(const std::string& what) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastError = what;
+}
+
+bool TelemetryStore::exec(const char* sql) {
+    char* message = nullptr;
+    if (sqlite3_exec(m_db, sql, nullptr, nullptr, &message) != SQLITE_OK) {
+        setError(message ? message : "sqlite3_exec failed");
+        sqlite3_free(message);
+        return false;
+    }
+    return true;
+}
+
+int64_t TelemetryStore::bucketWidthMs(Resolution resolution) {
+    switch (resolution) {
+    case Resolution::Raw:    return 1;
+    case Resolution::Minute: return MINUTE_MS;
+    case Resolution::Hour:   return HOUR_MS;
+    }
+    return 1;
+}
+
+TelemetryStore::Resolution TelemetryStore::resolutionFor(int64_t spanMs) {
+    // Devices are polled about once a second
+    if (spanMs <= MAX_POINTS * 1000) {
+        return Resolution::Raw;
+    }
+    if (spanMs <= MAX_POINTS * MINUTE_MS) {
+        return Resolution::Minute;
+    }
+    return Resolution::Hour;
+}
+
+uint64_t TelemetryStore::ingested() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ingested;
+}
+
+uint64_t TelemetryStore::samplesWritten() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_written;
+}
+
+uint64_t TelemetryStore::samplesDropped() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dropped;
+}
+
+uint64_t TelemetryStore::writeFailures() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_writeFailures;
+}
+
+void TelemetryStore::ingest(const std::string& device, const Sample& sample) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_writer.joinable() || m_stop) {
+            return; // Not open: nothing to persist to
+        }
+
+        auto it = m_devices.find(device);
+        if (it == m_devices.end()) {
+            it = m_devices.emplace(device, DeviceState()).first;
+            it->second.id = m_nextDeviceId++;
+            m_newDevices.push_back(DeviceRow{it->second.id, device});
+        }
+        DeviceState& state = it->second;
+
+        m_raw.push_back(RawRow{state.id, sample});
+        ++m_ingested;
+
+        for (size_t level = 0; level < ROLLUP_LEVELS; ++level) {
+            const Resolution resolution = static_cast<Resolution>(level + 1);
+            const int64_t start = bucketStart(sample.timestampMs, bucketWidthMs(resolution));
+
+            for (size_t metric = 0; metric < METRIC_COUNT; ++metric) {
+                Bucket& bucket = state.buckets[metric][level];
+                if (bucket.start != start) {
+                    // Late samples for an older bucket are kept raw only
+                    if (bucket.start > start) {
+                        continue;
+                    }
+                    if (bucket.count > 0) {
+                        m_closed.push_back(RollupRow{static_cast<uint8_t>(resolution),
+                                                     static_cast<uint8_t>(metric),
+                                                     state.id, bucket});
+                    }
+                    bucket = Bucket();
+                    bucket.start = start;
+                }
+                bucket.add(sample.value(static_cast<Metric>(metric)));
+            }
+        }
+
+        if (!state.dirty) {
+            state.dirty = true;
+            m_dirty.push_back(&state);
+        }
+        wake = m_raw.size() >= m_config.flushSamples;
+    }
+    if (wake) {
+        m_wake.notify_one();
+    }
+}
+
+void TelemetryStore::flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_writer.joinable()) {
+        return;
+    }
+    const uint64_t target = m_ingested;
+    const uint64_t failures = m_writeFailures;
+    ++m_flushWaiters;
+    m_wake.notify_one();
+    m_drained.wait(lock, [this, target, failures]() {
+        return m_written + m_dropped >= target || m_writeFailures != failures || m_stop;
+    });
+    --m_flushWaiters;
+}
+
+void TelemetryStore::takePending(std::vector<RawRow>& raw, std::vector<RollupRow>& rollups,
+                                 std::vector<DeviceRow>& devices) {
+    raw.clear();
+    rollups.clear();
+    devices.clear();
+    raw.swap(m_raw);
+    rollups.swap(m_closed);
+    devices.swap(m_newDevices);
+
+    // Open buckets are written as they stand and replaced on later flushes
+    for (DeviceState* state : m_dirty) {
+        state->dirty = false;
+        for (size_t metric = 0; metric < METRIC_COUNT; ++metric) {
+            for (size_t level = 0; level < ROLLUP_LEVELS; ++level) {
+                const Bucket& bucket = state->buckets[metric][level];
+                if (bucket.count > 0) {
+                    rollups.push_back(RollupRow{static_cast<uint8_t>(level + 1),
+                                                static_cast<uint8_t>(metric),
+                                                state->id, bucket});
+                }
+            }
+        }
+    }
+    m_dirty.clear();
+}
+
+void TelemetryStore::writerLoop() {
+    std::vector<RawRow> raw;
+    std::vector<RollupRow> rollups;
+    std::vector<DeviceRow> devices;
+
+    // After a failed write the next attempt waits a full interval
+    bool retrying = false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait_for(lock, std::chrono::milliseconds(m_config.flushIntervalMs),
+                        [this, &retrying]() {
+            return m_stop ||
+                   (!retrying && (m_raw.size() >= m_config.flushSamples ||
+                                  (m_flushWaiters > 0 && m_written + m_dropped < m_ingested)));
+        });
+
+        takePending(raw, rollups, devices);
+        const bool stop = m_stop;
+
+        bool ok = true;
+        if (!raw.empty() || !rollups.empty() || !devices.empty()) {
+            lock.unlock();
+            ok = writeBatch(raw, rollups, devices);
+            lock.lock();
+        }
+
+        if (ok) {
+            m_written += raw.size();
+        } else {
+            ++m_writeFailures;
+            if (stop) {
+                m_dropped += raw.size();    // Last attempt before closing
+            } else {
+                retainFailed(raw, rollups, devices);
+            }
+        }
+        retrying = !ok;
+        m_drained.notify_all();
+
+        if (stop && m_raw.empty()) {
+            break;
+        }
+    }
+}
+
+void TelemetryStore::retainFailed(std::vector<RawRow>& raw, std::vector<RollupRow>& rollups,
+                                  std::vector<DeviceRow>& devices) {
+    // Failed rows go back ahead of anything ingested during the attempt;
+    // rollups are upserts, so a newer row for the same bucket still wins
+    raw.insert(raw.end(), m_raw.begin(), m_raw.end());
+    raw.swap(m_raw);
+    rollups.insert(rollups.end(), m_closed.begin(), m_closed.end());
+    rollups.swap(m_closed);
+    devices.insert(devices.end(), std::make_move_iterator(m_newDevices.begin()),
+                   std::make_move_iterator(m_newDevices.end()));
+    devices.swap(m_newDevices);
+
+    if (m_raw.size() > m_config.maxRetainedSamples) {
+        const size_t excess = m_raw.size() - m_config.maxRetainedSamples;
+        m_raw.erase(m_raw.begin(), m_raw.begin() + static_cast<std::ptrdiff_t>(excess));
+        m_dropped += excess;
+    }
+}
+
+bool TelemetryStore::writeBatch(const std::vector<RawRow>& raw,
+                                const std::vector<RollupRow>& rollups,
+                                const std::vector<DeviceRow>& devices) {
+    if (!exec("BEGIN")) {
+        return false;
+    }
+
+    bool ok = true;
+    auto step = [this, &ok](sqlite3_stmt* stmt) {
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            setError("write: " + std::string(sqlite3_errmsg(m_db)));
+            ok = false;
+        }
+        sqlite3_reset(stmt);
+    };
+
+    for (const DeviceRow& d : devices) {
+        sqlite3_bind_int64(m_insertDevice, 1, d.id);
+        sqlite3_bind_text(m_insertDevice, 2, d.name.c_str(), -1, SQLITE_TRANSIENT);
+        step(m_insertDevice);
+    }
+
+    for (const RawRow& r : raw) {
+        const Sample& s = r.sample;
+        sqlite3_bind_int64(m_insertSample, 1, r.device);
+        sqlite3_bind_int64(m_insertSample, 2, s.timestampMs);
+        sqlite3_bind_double(m_insertSample, 3, s.voltage);
+        sqlite3_bind_double(m_insertSample, 4, s.temperature);
+        sqlite3_bind_int(m_insertSample, 5, s.signalLevel);
+        sqlite3_bind_double(m_insertSample, 6, s.frequencyMHz);
+        sqlite3_bind_int(m_insertSample, 7, s.transmitting ? 1 : 0);
+        step(m_insertSample);
+    }
+
+    for (const RollupRow& r : rollups) {
+        sqlite3_bind_int(m_upsertRollup, 1, r.resolution);
+        sqlite3_bind_int64(m_upsertRollup, 2, r.device);
+        sqlite3_bind_int(m_upsertRollup, 3, r.metric);
+        sqlite3_bind_int64(m_upsertRollup, 4, r.bucket.start);
+        sqlite3_bind_double(m_upsertRollup, 5, r.bucket.min);
+        sqlite3_bind_double(m_upsertRollup, 6, r.bucket.max);
+        sqlite3_bind_double(m_upsertRollup, 7, r.bucket.sum);
+        sqlite3_bind_int64(m_upsertRollup, 8, r.bucket.count);
+        step(m_upsertRollup);
+    }
+
+    // All or nothing: failed rows are retried, so none may be committed
+    if (!ok || !exec("COMMIT")) {
+        exec("ROLLBACK");
+        return false;
+    }
+    return true;
+}
+
+std::vector<TelemetryStore::Point> TelemetryStore::query(const std::string& device,
+                                                         Metric metric, int64_t fromMs,
+                                                         int64_t toMs,
+                                                         Resolution resolution) const {
+    std::vector<Point> points;
+
+    uint32_t deviceId = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_devices.find(device);
+        if (it == m_devices.end()) {
+            return points;
+        }
+        deviceId = it->second.id;
+    }
+
+    std::lock_guard<std::mutex> lock(m_readMutex);
+    if (!m_reader) {
+        return points;
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    if (resolution == Resolution::Raw) {
+        if (sqlite3_prepare_v2(m_reader, SELECT_RAW[static_cast<size_t>(metric)], -1, &stmt,
+                               nullptr) != SQLITE_OK) {
+            return points;
+        }
+        sqlite3_bind_int64(stmt, 1, deviceId);
+        sqlite3_bind_int64(stmt, 2, fromMs);
+        sqlite3_bind_int64(stmt, 3, toMs);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            Point p;
+            p.timeMs = sqlite3_column_int64(stmt, 0);
+            p.min = p.max = p.avg = sqlite3_column_double(stmt, 1);
+            p.count = 1;
+            points.push_back(p);
+        }
+    } else {
+        if (sqlite3_prepare_v2(m_reader, SELECT_ROLLUP, -1, &stmt, nullptr) != SQLITE_OK) {
+            return points;
+        }
+        sqlite3_bind_int(stmt, 1, static_cast<int>(resolution));
+        sqlite3_bind_int64(stmt, 2, deviceId);
+        sqlite3_bind_int(stmt, 3, static_cast<int>(metric));
+        // Include the bucket that contains fromMs
+        sqlite3_bind_int64(stmt, 4, bucketStart(fromMs, bucketWidthMs(resolution)));
+        sqlite3_bind_int64(stmt, 5, toMs);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            Point p;
+            p.timeMs = sqlite3_column_int64(stmt, 0);
+            p.min = sqlite3_column_double(stmt, 1);
+            p.max = sqlite3_column_double(stmt, 2);
+            p.count = static_cast<uint32_t>(sqlite3_column_int64(stmt, 4));
+            p.avg = p.count > 0 ? sqlite3_column_double(stmt, 3) / p.count : 0.0;
+            points.push_back(p);
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    return points;
+}
+
+} // namespace rcms
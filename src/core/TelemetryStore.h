@@ -0,0 +1,207 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace rcms {
+
+/**
+ * @brief Per-device telemetry history (SQLite) with min/max/avg rollups
+ *
+ * ingest() is cheap and thread-safe: the sample goes to an in-memory
+ * buffer and the 1-minute and 1-hour rollup buckets of every metric are
+ * updated in place. A writer thread flushes raw samples, closed buckets
+ * and the current state of open buckets in one transaction every
+ * flushIntervalMs (or sooner when flushSamples are pending). Long-range
+ * queries read the rollup table, never the raw rows.
+ *
+ * A failed transaction is rolled back and its rows are kept for the next
+ * flush, up to maxRetainedSamples raw samples; beyond that the oldest are
+ * dropped and counted in samplesDropped(), never in samplesWritten().
+ *
+ * Queries see data up to the last flush.
+ */
+class TelemetryStore {
+public:
+    enum class Metric : uint8_t {
+        Voltage,
+        Temperature,
+        SignalLevel,
+        Frequency,
+        Transmitting        // Avg over a bucket = TX duty cycle
+    };
+    static constexpr size_t METRIC_COUNT = 5;
+
+    enum class Resolution : uint8_t {
+        Raw,
+        Minute,
+        Hour
+    };
+
+    struct Sample {
+        int64_t timestampMs = 0;    // Epoch ms
+        double voltage = 0.0;
+        double temperature = 0.0;
+        double frequencyMHz = 0.0;
+        int32_t signalLevel = 0;
+        bool transmitting = false;
+
+        double value(Metric metric) const;
+    };
+
+    /**
+     * @brief Query result: one raw sample or one rollup bucket
+     */
+    struct Point {
+        int64_t timeMs = 0;         // Sample time or bucket start
+        double min = 0.0;
+        double max = 0.0;
+        double avg = 0.0;
+        uint32_t count = 0;
+    };
+
+    struct Config {
+        int flushIntervalMs = 5000;
+        size_t flushSamples = 4096;     // Pending raw samples that force a flush
+        size_t maxRetainedSamples = 65536;  // Unwritten samples kept while writes fail
+    };
+
+    TelemetryStore();
+    ~TelemetryStore();
+
+    TelemetryStore(const TelemetryStore&) = delete;
+    TelemetryStore& operator=(const TelemetryStore&) = delete;
+
+    bool open(const std::string& path);
+    bool open(const std::string& path, const Config& config);
+
+    /**
+     * @brief Flush everything and stop the writer
+     */
+    void close();
+
+    bool isOpen() const { return m_db != nullptr; }
+    std::string lastError() const;
+
+    /**
+     * @brief Record one poll result for a device
+     */
+    void ingest(const std::string& device, const Sample& sample);
+
+    /**
+     * @brief Block until everything ingested so far is written (or
+     *        dropped), or until a write attempt fails
+     */
+    void flush();
+
+    /**
+     * @brief History of one metric over [fromMs, toMs]
+     */
+    std::vector<Point> query(const std::string& device, Metric metric,
+                             int64_t fromMs, int64_t toMs, Resolution resolution) const;
+
+    /**
+     * @brief Finest resolution that keeps a span to a few thousand points
+     */
+    static Resolution resolutionFor(int64_t spanMs);
+
+    static int64_t bucketWidthMs(Resolution resolution);
+
+    uint64_t ingested() const;
+    uint64_t samplesWritten() const;
+    uint64_t samplesDropped() const;
+    uint64_t writeFailures() const;     // Failed flush transactions since open()
+
+private:
+    static constexpr size_t ROLLUP_LEVELS = 2;     // Minute, Hour
+
+    struct Bucket {
+        int64_t start = -1;
+        double min = 0.0;
+        double max = 0.0;
+        double sum = 0.0;
+        uint32_t count = 0;
+
+        void add(double v);
+    };
+
+    struct DeviceState {
+        uint32_t id = 0;
+        bool dirty = false;         // Open buckets changed since last flush
+        std::array<std::array<Bucket, ROLLUP_LEVELS>, METRIC_COUNT> buckets{};
+    };
+
+    struct RawRow {
+        uint32_t device;
+        Sample sample;
+    };
+
+    struct RollupRow {
+        uint8_t resolution;
+        uint8_t metric;
+        uint32_t device;
+        Bucket bucket;
+    };
+
+    struct DeviceRow {
+        uint32_t id;
+        std::string name;
+    };
+
+    void writerLoop();
+    void takePending(std::vector<RawRow>& raw, std::vector<RollupRow>& rollups,
+                     std::vector<DeviceRow>& devices);
+    void retainFailed(std::vector<RawRow>& raw, std::vector<RollupRow>& rollups,
+                      std::vector<DeviceRow>& devices);
+    bool writeBatch(const std::vector<RawRow>& raw, const std::vector<RollupRow>& rollups,
+                    const std::vector<DeviceRow>& devices);
+    bool loadState();
+    bool exec(const char* sql);
+    void setError(const std::string& what);
+    void finalize();
+
+    Config m_config;
+    std::string m_path;
+
+    // Writer connection (writer thread only once started)
+    sqlite3* m_db = nullptr;
+    sqlite3_stmt* m_insertSample = nullptr;
+    sqlite3_stmt* m_upsertRollup = nullptr;
+    sqlite3_stmt* m_insertDevice = nullptr;
+
+    // Reader connection for queries
+    mutable std::mutex m_readMutex;
+    sqlite3* m_reader = nullptr;
+
+    // Ingest side, guarded by m_mutex
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_drained;
+    std::unordered_map<std::string, DeviceState> m_devices;
+    std::vector<DeviceState*> m_dirty;
+    std::vector<RawRow> m_raw;
+    std::vector<RollupRow> m_closed;
+    std::vector<DeviceRow> m_newDevices;
+    uint32_t m_nextDeviceId = 1;
+    uint64_t m_ingested = 0;
+    uint64_t m_written = 0;
+    uint64_t m_dropped = 0;
+    uint64_t m_writeFailures = 0;
+    int m_flushWaiters = 0;
+    bool m_stop = false;
+    std::string m_lastError;
+
+    std::thread m_writer;
+};
+
+} // namespace rcms
@@ -0,0 +1,352 @@
+#include "Trace.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace rcms {
+
+namespace trace_detail {
+std::atomic<bool> g_enabled{false};
+std::atomic<int64_t> g_originNs{0};
+}
+
+namespace {
+
+using trace_detail::Ring;
+using trace_detail::RING_RECORDS;
+
+const char FILE_MAGIC[8] = {'R', 'C', 'M', 'S', 'T', 'R', 'C', '1'};
+
+const Trace::EventInfo EVENTS[] = {
+    {TraceEvent::ModbusRequest, "modbus.request", "addr={} fc={:#x} reg={:#x} bytes={}"},
+    {TraceEvent::ModbusTransaction, "modbus.transaction",
+     "addr={} fc={:#x} reg={:#x} latency_us={} result={}"},
+    {TraceEvent::ModbusException, "modbus.exception", "addr={} fc={:#x} code={:#x}"},
+    {TraceEvent::ModbusCrcError, "modbus.crc_error", "addr={} fc={:#x}"},
+    {TraceEvent::DevicePoll, "device.poll", "addr={} blocks={} registers={} slow={} ok={}"},
+    {TraceEvent::FrequencySet, "device.frequency", "addr={} frrs={:#x} khz={} ok={}"},
+    {TraceEvent::SquelchSet, "device.squelch", "addr={} enabled={} level={} ok={}"},
+    {TraceEvent::PttSet, "device.ptt", "addr={} enabled={} ok={}"},
+};
+
+/**
+ * Rings of all threads that ever traced, the output file and the drain
+ * thread. Rings are never freed while their thread lives; retired rings
+ * are freed by the drain once empty.
+ */
+struct Session {
+    std::mutex mutex;                       // Ring list and session state
+    std::condition_variable wake;
+    std::vector<std::unique_ptr<Ring>> rings;
+    uint16_t nextThread = 0;
+
+    Trace::Config config;
+    Trace::FileHeader header{};             // Repeated at the start of every file
+    std::FILE* file = nullptr;
+    uint64_t fileBytes = 0;
+    std::thread drainer;
+    bool stop = false;
+    uint64_t written = 0;
+    uint64_t droppedRetired = 0;            // From rings already freed
+    std::vector<TraceRecord> buffer;
+};
+
+Session& session() {
+    static Session s;
+    return s;
+}
+
+// Marks the thread's ring retired when the thread exits
+struct RingOwner {
+    Ring* ring = nullptr;
+    ~RingOwner() {
+        if (ring) {
+            trace_detail::t_ring = nullptr;
+            ring->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+thread_local RingOwner t_owner;
+
+// Copy out what the producer published; caller holds the session mutex
+void drainRing(Ring& ring, std::vector<TraceRecord>& out) {
+    const uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+    const uint32_t head = ring.head.load(std::memory_order_acquire);
+    for (uint32_t i = tail; i != head; ++i) {
+        out.push_back(ring.slots[i & (RING_RECORDS - 1)]);
+    }
+    ring.tail.store(head, std::memory_order_release);
+}
+
+// file -> file.1 -> ... -> file.maxFiles; the oldest is removed
+void rotateFiles(const std::string& path, size_t maxFiles) {
+    auto numbered = [&path](size_t n) { return path + "." + std::to_string(n); };
+    if (maxFiles == 0) {
+        std::remove(path.c_str());
+        return;
+    }
+    std::remove(numbered(maxFiles).c_str());
+    for (size_t n = maxFiles; n > 1; --n) {
+        std::rename(numbered(n - 1).c_str(), numbered(n).c_str());
+    }
+    std::rename(path.c_str(), numbered(1).c_str());
+}
+
+// Caller holds the session mutex
+bool openFile(Session& s) {
+    s.file = std::fopen(s.config.file.c_str(), "wb");
+    if (!s.file) {
+        return false;
+    }
+    std::fwrite(&s.header, sizeof(s.header), 1, s.file);
+    s.fileBytes = sizeof(s.header);
+    return true;
+}
+
+// Caller holds the session mutex
+void drainAll(Session& s) {
+    s.buffer.clear();
+    for (auto& ring : s.rings) {
+        drainRing(*ring, s.buffer);
+    }
+
+    // Free rings of exited threads once nothing is left in them
+    for (auto it = s.rings.begin(); it != s.rings.end();) {
+        Ring& ring = **it;
+        if (ring.retired.load(std::memory_order_acquire) &&
+            ring.tail.load(std::memory_order_relaxed) == ring.head.load(std::memory_order_acquire)) {
+            s.droppedRetired += ring.dropped.load(std::memory_order_relaxed);
+            it = s.rings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (!s.file || s.buffer.empty()) {
+        return;
+    }
+
+    // Size cap: start the next file rather than grow this one
+    const uint64_t bytes = s.buffer.size() * sizeof(TraceRecord);
+    if (s.fileBytes > sizeof(s.header) && s.fileBytes + bytes > s.config.maxFileSize) {
+        std::fclose(s.file);
+        s.file = nullptr;
+        rotateFiles(s.config.file, s.config.maxFiles);
+        if (!openFile(s)) {
+            return;     // Tracing goes on into the rings, but nothing is kept
+        }
+    }
+
+    const size_t n = std::fwrite(s.buffer.data(), sizeof(TraceRecord), s.buffer.size(), s.file);
+    s.written += n;
+    s.fileBytes += n * sizeof(TraceRecord);
+}
+
+void drainLoop() {
+    Session& s = session();
+    std::unique_lock<std::mutex> lock(s.mutex);
+    while (!s.stop) {
+        s.wake.wait_for(lock, std::chrono::milliseconds(Trace::DRAIN_INTERVAL_MS),
+                        [&s]() { return s.stop; });
+        drainAll(s);
+    }
+}
+
+// Minimal "{}" / "{:#x}" substitution for the event table
+std::string format(const char* pattern, const uint32_t* args, size_t argc) {
+    std::string out;
+    size_t next = 0;
+    char number[16];
+
+    for (const char* p = pattern; *p;) {
+        if (p[0] == '{' && p[1] == '}') {
+            std::snprintf(number, sizeof(number), "%u", next < argc ? args[next] : 0u);
+            out += number;
+            ++next;
+            p += 2;
+        } else if (std::strncmp(p, "{:#x}", 5) == 0) {
+            std::snprintf(number, sizeof(number), "0x%X", next < argc ? args[next] : 0u);
+            out += number;
+            ++next;
+            p += 5;
+        } else {
+            out += *p++;
+        }
+    }
+    return out;
+}
+
+} // anonymous namespace
+
+namespace trace_detail {
+
+Ring* attachThread() {
+    Session& s = session();
+    auto ring = std::make_unique<Ring>();
+    Ring* raw = ring.get();
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        raw->thread = s.nextThread++;
+        s.rings.push_back(std::move(ring));
+    }
+    t_owner.ring = raw;
+    t_ring = raw;
+    return raw;
+}
+
+} // namespace trace_detail
+
+bool Trace::start(const std::string& path) {
+    Config config;
+    config.file = path;
+    return start(config);
+}
+
+bool Trace::start(const Config& config) {
+    stop();
+
+    Session& s = session();
+    std::unique_lock<std::mutex> lock(s.mutex);
+
+    // Keep the previous run's trace
+    if (std::FILE* existing = std::fopen(config.file.c_str(), "rb")) {
+        std::fclose(existing);
+        rotateFiles(config.file, config.maxFiles);
+    }
+
+    s.config = config;
+    s.header = FileHeader{};
+    std::memcpy(s.header.magic, FILE_MAGIC, sizeof(s.header.magic));
+    s.header.recordSize = sizeof(TraceRecord);
+    s.header.startEpochNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const int64_t origin = trace_detail::steadyNs();
+    if (!openFile(s)) {
+        return false;
+    }
+
+    // Discard whatever is left from an earlier session
+    s.buffer.clear();
+    for (auto& ring : s.rings) {
+        drainRing(*ring, s.buffer);
+        ring->dropped.store(0, std::memory_order_relaxed);
+    }
+    s.buffer.clear();
+    s.written = 0;
+    s.droppedRetired = 0;
+
+    trace_detail::g_originNs.store(origin, std::memory_order_relaxed);
+    s.stop = false;
+    s.drainer = std::thread(drainLoop);
+    trace_detail::g_enabled.store(true, std::memory_order_release);
+    return true;
+}
+
+void Trace::stop() {
+    trace_detail::g_enabled.store(false, std::memory_order_release);
+
+    Session& s = session();
+    std::thread drainer;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.stop = true;
+        drainer = std::move(s.drainer);
+    }
+    s.wake.notify_one();
+    if (drainer.joinable()) {
+        drainer.join();
+    }
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+    drainAll(s);
+    if (s.file) {
+        std::fclose(s.file);
+        s.file = nullptr;
+    }
+}
+
+uint64_t Trace::dropped() {
+    Session& s = session();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    uint64_t total = s.droppedRetired;
+    for (const auto& ring : s.rings) {
+        total += ring->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t Trace::written() {
+    Session& s = session();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.written;
+}
+
+const Trace::EventInfo* Trace::eventInfo(uint16_t event) {
+    for (const EventInfo& info : EVENTS) {
+        if (static_cast<uint16_t>(info.event) == event) {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+bool Trace::readFile(const std::string& path, FileHeader& header,
+                     std::vector<TraceRecord>& records, std::string* error) {
+    records.clear();
+
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "rb"),
+                                                         &std::fclose);
+    if (!file) {
+        if (error) {
+            *error = "cannot open " + path;
+        }
+        return false;
+    }
+
+    if (std::fread(&header, sizeof(header), 1, file.get()) != 1 ||
+        std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+        header.recordSize != sizeof(TraceRecord)) {
+        if (error) {
+            *error = "not a trace file: " + path;
+        }
+        return false;
+    }
+
+    // A partial last record (crash mid-write) is ignored
+    TraceRecord chunk[1024];
+    size_t n;
+    while ((n = std::fread(chunk, sizeof(TraceRecord), 1024, file.get())) > 0) {
+        records.insert(records.end(), chunk, chunk + n);
+    }
+
+    // Threads are drained one after another: restore global time order
+    std::stable_sort(records.begin(), records.end(),
+                     [](const TraceRecord& a, const TraceRecord& b) { return a.timeNs < b.timeNs; });
+    return true;
+}
+
+std::string Trace::render(const TraceRecord& record) {
+    char prefix[48];
+    std::snprintf(prefix, sizeof(prefix), "%12.6f [%u] ",
+                  static_cast<double>(record.timeNs) / 1e9, static_cast<unsigned>(record.thread));
+
+    std::string line = prefix;
+    if (const EventInfo* info = eventInfo(record.event)) {
+        line += info->name;
+        line += ": ";
+        line += format(info->format, record.args, 5);
+    } else {
+        char unknown[96];
+        std::snprintf(unknown, sizeof(unknown), "event#%u: %u %u %u %u %u",
+                      static_cast<unsigned>(record.event), record.args[0], record.args[1],
+                      record.args[2], record.args[3], record.args[4]);
+        line += unknown;
+    }
+    return line;
+}
+
+} // namespace rcms
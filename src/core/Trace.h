@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rcms {
+
+/**
+ * @brief Static trace event ids; numbers are part of the file format
+ *
+ * Append only; never renumber. Argument meaning and text rendering are in
+ * the table in Trace.cpp.
+ */
+enum class TraceEvent : uint16_t {
+    ModbusRequest = 1,      // addr, fc, reg, bytes
+    ModbusTransaction = 2,  // addr, fc, reg, latency us, ModbusRTU::Result
+    ModbusException = 3,    // addr, fc, exception code
+    ModbusCrcError = 4,     // addr, fc
+    DevicePoll = 5,         // addr, blocks, registers, slow tier, ok
+    FrequencySet = 6,       // addr, FRRS value, kHz, ok
+    SquelchSet = 7,         // addr, enabled, level, ok
+    PttSet = 8              // addr, enabled, ok
+};
+
+/**
+ * @brief One trace record as stored in memory and on disk (32 bytes)
+ */
+struct TraceRecord {
+    int64_t timeNs;                 // steady_clock since session start
+    uint16_t event;                 // TraceEvent
+    uint16_t thread;                // Recording thread, numbered in first-use order
+    uint32_t args[5];
+};
+static_assert(sizeof(TraceRecord) == 32, "TraceRecord layout is part of the file format");
+
+namespace trace_detail {
+
+constexpr uint32_t RING_RECORDS = 4096;     // Per thread, power of two
+
+/**
+ * @brief Single-producer (owning thread) / single-consumer (drain) ring
+ */
+struct Ring {
+    alignas(64) std::atomic<uint32_t> head{0};  // Written by the producer
+    uint32_t cachedTail = 0;                    // Producer's view of tail
+    alignas(64) std::atomic<uint32_t> tail{0};  // Written by the drain thread
+    alignas(64) std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> retired{false};           // Owning thread has exited
+    uint16_t thread = 0;
+    TraceRecord slots[RING_RECORDS];
+};
+
+extern std::atomic<bool> g_enabled;
+extern std::atomic<int64_t> g_originNs;
+inline thread_local Ring* t_ring = nullptr;
+
+Ring* attachThread();
+
+inline int64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace trace_detail
+
+/**
+ * @brief Binary event tracing with deferred formatting
+ *
+ * record() stores a timestamp, a static event id and up to five integer
+ * arguments in the calling thread's ring buffer: no formatting, no locks,
+ * no allocation after the thread's first event. A drain thread appends
+ * the rings to a compact file; `rcms-trace` renders it as text offline.
+ * When a ring is full the event is dropped and counted, never waited for.
+ *
+ * Files rotate like the log: the file of an earlier run and a file that
+ * grew past maxFileSize are renamed to file.1, file.2, ... (at most
+ * maxFiles kept), and every file starts with its own header.
+ */
+class Trace {
+public:
+    /**
+     * @brief File header
+     */
+    struct FileHeader {
+        char magic[8];              // "RCMSTRC1"
+        uint32_t recordSize;
+        uint32_t reserved;
+        int64_t startEpochNs;       // Wall clock at timeNs == 0
+    };
+
+    /**
+     * @brief Name and text template of an event
+     */
+    struct EventInfo {
+        TraceEvent event;
+        const char* name;
+        const char* format;         // "{}" decimal, "{:#x}" hex
+    };
+
+    struct Config {
+        std::string file = "rcms-ga.trace";
+        size_t maxFileSize = 64 * 1024 * 1024;
+        size_t maxFiles = 3;                // Rotated files kept besides the current one
+    };
+
+    static constexpr int DRAIN_INTERVAL_MS = 20;
+
+    /**
+     * @brief Start a session; an existing file is rotated, not truncated
+     */
+    static bool start(const Config& config);
+    static bool start(const std::string& path);
+
+    /**
+     * @brief Drain everything recorded and close the file
+     */
+    static void stop();
+
+    static bool isEnabled() { return trace_detail::g_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Record an event (hot path)
+     */
+    static void record(TraceEvent event, uint32_t a0 = 0, uint32_t a1 = 0, uint32_t a2 = 0,
+                       uint32_t a3 = 0, uint32_t a4 = 0) {
+        if (!isEnabled()) {
+            return;
+        }
+        trace_detail::Ring* ring = trace_detail::t_ring;
+        if (!ring) {
+            ring = trace_detail::attachThread();
+        }
+
+        const uint32_t head = ring->head.load(std::memory_order_relaxed);
+        if (head - ring->cachedTail >= trace_detail::RING_RECORDS) {
+            ring->cachedTail = ring->tail.load(std::memory_order_acquire);
+            if (head - ring->cachedTail >= trace_detail::RING_RECORDS) {
+                ring->dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        TraceRecord& r = ring->slots[head & (trace_detail::RING_RECORDS - 1)];
+        r.timeNs = trace_detail::steadyNs() -
+                   trace_detail::g_originNs.load(std::memory_order_relaxed);
+        r.event = static_cast<uint16_t>(event);
+        r.thread = ring->thread;
+        r.args[0] = a0;
+        r.args[1] = a1;
+        r.args[2] = a2;
+        r.args[3] = a3;
+        r.args[4] = a4;
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Events lost to full rings since start()
+     */
+    static uint64_t dropped();
+
+    /**
+     * @brief Records written to the file since start()
+     */
+    static uint64_t written();
+
+    // ========== Offline decoding ==========
+
+    static const EventInfo* eventInfo(uint16_t event);
+
+    /**
+     * @brief Read a trace file, records sorted by time
+     */
+    static bool readFile(const std::string& path, FileHeader& header,
+                         std::vector<TraceRecord>& records, std::string* error = nullptr);
+
+    /**
+     * @brief "<seconds> [thread] name: text" for one record
+     */
+    static std::string render(const TraceRecord& record);
+};
+
+} // namespace rcms
@@ -6,6 +6,7 @@
 #include <QLabel>
 #include <QMessageBox>
 #include <QDoubleValidator>
+#include <QPointer>
 
 namespace rcms {
 
@@ -101,12 +102,17 @@ void ControlPanel::onSetFrequency() {
         return;
     }
 
-    if (m_device->setFrequency(freq)) {
-        Logger::info("Frequency set to {} MHz", freq);
-    } else {
-        QMessageBox::warning(this, "Ошибка",
-                             "Не удалось установить частоту");
-    }
+    QPointer<ControlPanel> self(this);
+    m_device->setFrequency(freq, [self, freq](bool ok) {
+        if (!self) return;
+
+        if (ok) {
+            Logger::info("Frequency set to {} MHz", freq);
+        } else {
+            QMessageBox::warning(self, "Ошибка",
+                                 "Не удалось установить частоту");
+        }
+    });
 }
 
 void ControlPanel::onSquelchChanged(int state) {
@@ -115,11 +121,13 @@ void ControlPanel::onSquelchChanged(int state) {
     bool enabled = (state == Qt::Checked);
     m_spnSquelchLevel->setEnabled(enabled);
 
-    if (m_device->setSquelch(enabled, m_spnSquelchLevel->value())) {
-        Logger::info("Squelch {} (level: {})",
-                     enabled ? "enabled" : "disabled",
-                     m_spnSquelchLevel->value());
-    }
+    int level = m_spnSquelchLevel->value();
+    m_device->setSquelch(enabled, level, [enabled, level](bool ok) {
+        if (ok) {
+            Logger::info("Squelch {} (level: {})",
+                         enabled ? "enabled" : "disabled", level);
+        }
+    });
 }
 
 void ControlPanel::onSquelchLevelChanged(int value) {
@@ -131,19 +139,25 @@ void ControlPanel::onSquelchLevelChanged(int value) {
 void ControlPanel::onPTTPressed() {
     if (!m_device) return;
 
-    if (m_device->setPTT(true)) {
-        Logger::info("PTT activated");
-        m_btnPTT->setText(">>> ПЕРЕДАЧА <<<");
-    }
+    QPointer<ControlPanel> self(this);
+    m_device->setPTT(true, [self](bool ok) {
+        if (self && ok) {
+            Logger::info("PTT activated");
+            self->m_btnPTT->setText(">>> ПЕРЕДАЧА <<<");
+        }
+    });
 }
 
 void ControlPanel::onPTTReleased() {
     if (!m_device) return;
 
-    if (m_device->setPTT(false)) {
-        Logger::info("PTT deactivated");
-        m_btnPTT->setText("PTT (удерживать)");
-    }
+    QPointer<ControlPanel> self(this);
+    m_device->setPTT(false, [self](bool ok) {
+        if (self && ok) {
+            Logger::info("PTT deactivated");
+            self->m_btnPTT->setText("PTT (удерживать)");
+        }
+    });
 }
 
 } // namespace rcms
@@ -0,0 +1,378 @@
+#include "DeviceTreeModel.h"
+#include "SnapshotText.h"
+#include <QFont>
+#include <QPixmap>
+#include <algorithm>
+#include <climits>
+
+namespace rcms {
+
+namespace {
+
+const char* const UNGROUPED_NAME = "Без группы";
+
+} // anonymous namespace
+
+DeviceTreeModel::DeviceTreeModel(QObject* parent)
+    : QAbstractItemModel(parent)
+    , m_iconOffline(QPixmap(":/icons/device_offline.png"))
+    , m_iconError(QPixmap(":/icons/device_error.png"))
+    , m_iconOk(QPixmap(":/icons/device_ok.png"))
+{
+}
+
+DeviceTreeModel::~DeviceTreeModel() = default;
+
+void DeviceTreeModel::addGroup(const DeviceGroup& group) {
+    if (GroupNode* existing = m_groupById.value(group.id)) {
+        existing->group.name = group.name;
+        existing->group.description = group.description;
+        existing->group.color = group.color;
+        existing->group.expanded = group.expanded;
+        QModelIndex idx = indexOf(existing, ColName);
+        emit dataChanged(idx, idx);
+        return;
+    }
+
+    auto node = std::make_unique<GroupNode>();
+    node->group = group;
+    insertGroup(std::move(node));
+}
+
+void DeviceTreeModel::removeGroup(const QString& groupId) {
+    GroupNode* group = m_groupById.value(groupId);
+    if (!group || groupId == groups::UNGROUPED) {
+        return;
+    }
+
+    if (!group->devices.empty()) {
+        GroupNode* ungrouped = findOrCreateGroup(groups::UNGROUPED);
+        while (!group->devices.empty()) {
+            attachDevice(takeDevice(group->devices.front().get()), ungrouped);
+        }
+    }
+
+    const int row = group->row;
+    beginRemoveRows(QModelIndex(), row, row);
+    m_groupById.remove(groupId);
+    m_groups.erase(m_groups.begin() + row);
+    for (size_t i = static_cast<size_t>(row); i < m_groups.size(); ++i) {
+        m_groups[i]->row = static_cast<int>(i);
+    }
+    endRemoveRows();
+}
+
+void DeviceTreeModel::addDevice(const QString& deviceId, const QString& name, uint8_t address,
+                                const QString& groupId) {
+    if (m_devices.contains(deviceId)) {
+        return;
+    }
+
+    auto device = std::make_unique<DeviceNode>();
+    device->id = deviceId;
+    device->name = name;
+    device->address = address;
+    m_devices.insert(deviceId, device.get());
+    attachDevice(std::move(device), findOrCreateGroup(groupId));
+}
+
+void DeviceTreeModel::removeDevice(const QString& deviceId) {
+    DeviceNode* device = m_devices.value(deviceId);
+    if (!device) {
+        return;
+    }
+    m_devices.remove(deviceId);
+    takeDevice(device);
+}
+
+void DeviceTreeModel::setDeviceGroup(const QString& deviceId, const QString& groupId) {
+    DeviceNode* device = m_devices.value(deviceId);
+    if (!device || device->group->group.id == groupId) {
+        return;
+    }
+    GroupNode* target = findOrCreateGroup(groupId);
+    attachDevice(takeDevice(device), target);
+}
+
+void DeviceTreeModel::updateDeviceStatus(const QString& deviceId, const StatusDelta& delta) {
+    using namespace status_fields;
+
+    DeviceNode* device = m_devices.value(deviceId);
+    if (!device) {
+        return;
+    }
+    const DeviceSnapshot& status = delta.status;
+
+    // Compare against what is on screen: an offline device shows "Offline"
+    // whatever its last frequency was
+    bool textChanged = false;
+    bool onlineChanged = false;
+    if (delta.has(Online | Frequency | Transmitting)) {
+        onlineChanged = device->online != status.online;
+        textChanged = onlineChanged ||
+                      (status.online && (device->frequencyHz != status.frequencyHz ||
+                                         device->transmitting != status.isTransmitting));
+        device->online = status.online;
+        device->frequencyHz = status.frequencyHz;
+        device->transmitting = status.isTransmitting;
+    }
+
+    bool iconChanged = false;
+    if (delta.has(Online | ErrorCodes)) {
+        IconState state = IconState::Ok;
+        if (!status.online) {
+            state = IconState::Offline;
+        } else if (status.hasFaults()) {
+            state = IconState::Error;
+        }
+        iconChanged = device->icon != state;
+        device->icon = state;
+    }
+
+    if (textChanged) {
+        QModelIndex idx = indexOf(device, ColStatus);
+        emit dataChanged(idx, idx, {Qt::DisplayRole});
+    }
+    if (iconChanged) {
+        QModelIndex idx = indexOf(device, ColName);
+        emit dataChanged(idx, idx, {Qt::DecorationRole});
+    }
+    if (onlineChanged) {
+        device->group->onlineCount += device->online ? 1 : -1;
+        emitGroupStatusChanged(device->group);
+    }
+}
+
+void DeviceTreeModel::clear() {
+    beginResetModel();
+    m_devices.clear();
+    m_groupById.clear();
+    m_groups.clear();
+    endResetModel();
+}
+
+QModelIndex DeviceTreeModel::deviceIndex(const QString& deviceId, int column) const {
+    const DeviceNode* device = m_devices.value(deviceId);
+    return device ? indexOf(device, column) : QModelIndex();
+}
+
+QModelIndex DeviceTreeModel::groupIndex(const QString& groupId, int column) const {
+    const GroupNode* group = m_groupById.value(groupId);
+    return group ? indexOf(group, column) : QModelIndex();
+}
+
+QString DeviceTreeModel::deviceIdAt(const QModelIndex& index) const {
+    if (!index.isValid()) {
+        return QString();
+    }
+    const Node* node = static_cast<const Node*>(index.internalPointer());
+    return node->isGroup ? QString() : static_cast<const DeviceNode*>(node)->id;
+}
+
+QModelIndex DeviceTreeModel::index(int row, int column, const QModelIndex& parent) const {
+    if (!hasIndex(row, column, parent)) {
+        return QModelIndex();
+    }
+    if (!parent.isValid()) {
+        return createIndex(row, column, static_cast<Node*>(m_groups[row].get()));
+    }
+    auto* group = static_cast<GroupNode*>(static_cast<Node*>(parent.internalPointer()));
+    return createIndex(row, column, static_cast<Node*>(group->devices[row].get()));
+}
+
+QModelIndex DeviceTreeModel::parent(const QModelIndex& child) const {
+    if (!child.isValid()) {
+        return QModelIndex();
+    }
+    const Node* node = static_cast<const Node*>(child.internalPointer());
+    if (node->isGroup) {
+        return QModelIndex();
+    }
+    return indexOf(static_cast<const DeviceNode*>(node)->group, ColName);
+}
+
+int DeviceTreeModel::rowCount(const QModelIndex& parent) const {
+    if (!parent.isValid()) {
+        return static_cast<int>(m_groups.size());
+    }
+    if (parent.column() != ColName) {
+        return 0;
+    }
+    const Node* node = static_cast<const Node*>(parent.internalPointer());
+    return node->isGroup ? static_cast<int>(static_cast<const GroupNode*>(node)->devices.size()) : 0;
+}
+
+int DeviceTreeModel::columnCount(const QModelIndex& /*parent*/) const {
+    return COLUMN_COUNT;
+}
+
+QVariant DeviceTreeModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid()) {
+        return QVariant();
+    }
+    const Node* node = static_cast<const Node*>(index.internalPointer());
+
+    if (node->isGroup) {
+        const GroupNode& g = *static_cast<const GroupNode*>(node);
+        switch (role) {
+            case Qt::DisplayRole:
+                if (index.column() == ColName) {
+                    return g.group.name;
+                }
+                if (index.column() == ColStatus) {
+                    return QString("%1 из %2 в сети").arg(g.onlineCount)
+                        .arg(static_cast<int>(g.devices.size()));
+                }
+                return QVariant();
+            case Qt::ToolTipRole:
+                return g.group.description.isEmpty() ? QVariant() : QVariant(g.group.description);
+            case Qt::ForegroundRole:
+                return index.column() == ColName && g.group.color.isValid()
+                    ? QVariant(g.group.color) : QVariant();
+            case Qt::FontRole: {
+                QFont font;
+                font.setBold(true);
+                return font;
+            }
+            case GroupIdRole:
+                return g.group.id;
+            default:
+                return QVariant();
+        }
+    }
+
+    const DeviceNode& d = *static_cast<const DeviceNode*>(node);
+    switch (role) {
+        case Qt::DisplayRole:
+            switch (index.column()) {
+                case ColName: return d.name;
+                case ColAddress: return QString::number(d.address);
+                case ColStatus: return statusText(d);
+                default: return QVariant();
+            }
+        case Qt::DecorationRole:
+            return index.column() == ColName ? QVariant(icon(d.icon)) : QVariant();
+        case Qt::ToolTipRole:
+            return index.column() == ColName ? QVariant(d.id) : QVariant();
+        case DeviceIdRole:
+            return d.id;
+        case GroupIdRole:
+            return d.group->group.id;
+        default:
+            return QVariant();
+    }
+}
+
+QVariant DeviceTreeModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+        case ColName: return "Устройство";
+        case ColAddress: return "Адрес";
+        case ColStatus: return "Статус";
+        default: return QVariant();
+    }
+}
+
+DeviceTreeModel::GroupNode* DeviceTreeModel::findOrCreateGroup(const QString& groupId) {
+    const QString id = groupId.isEmpty() ? groups::UNGROUPED : groupId;
+    if (GroupNode* group = m_groupById.value(id)) {
+        return group;
+    }
+
+    auto node = std::make_unique<GroupNode>();
+    node->group.id = id;
+    if (id == groups::UNGROUPED) {
+        node->group.name = UNGROUPED_NAME;
+        node->group.sortOrder = INT_MAX;    // Always last
+    } else {
+        node->group.name = id;
+    }
+
+    GroupNode* raw = node.get();
+    insertGroup(std::move(node));
+    return raw;
+}
+
+void DeviceTreeModel::insertGroup(std::unique_ptr<GroupNode> node) {
+    const DeviceGroup& group = node->group;
+    auto pos = std::upper_bound(m_groups.begin(), m_groups.end(), group.sortOrder,
+                                [](int order, const std::unique_ptr<GroupNode>& g) {
+                                    return order < g->group.sortOrder;
+                                });
+    const int row = static_cast<int>(pos - m_groups.begin());
+
+    beginInsertRows(QModelIndex(), row, row);
+    m_groupById.insert(group.id, node.get());
+    m_groups.insert(pos, std::move(node));
+    for (size_t i = static_cast<size_t>(row); i < m_groups.size(); ++i) {
+        m_groups[i]->row = static_cast<int>(i);
+    }
+    endInsertRows();
+}
+
+std::unique_ptr<DeviceTreeModel::DeviceNode> DeviceTreeModel::takeDevice(DeviceNode* device) {
+    GroupNode* group = device->group;
+    const int row = device->row;
+
+    beginRemoveRows(indexOf(group, ColName), row, row);
+    std::unique_ptr<DeviceNode> owned = std::move(group->devices[row]);
+    group->devices.erase(group->devices.begin() + row);
+    for (size_t i = static_cast<size_t>(row); i < group->devices.size(); ++i) {
+        group->devices[i]->row = static_cast<int>(i);
+    }
+    if (owned->online) {
+        --group->onlineCount;
+    }
+    owned->group = nullptr;
+    endRemoveRows();
+
+    emitGroupStatusChanged(group);
+    return owned;
+}
+
+void DeviceTreeModel::attachDevice(std::unique_ptr<DeviceNode> device, GroupNode* group) {
+    const int row = static_cast<int>(group->devices.size());
+
+    beginInsertRows(indexOf(group, ColName), row, row);
+    device->group = group;
+    device->row = row;
+    if (device->online) {
+        ++group->onlineCount;
+    }
+    group->devices.push_back(std::move(device));
+    endInsertRows();
+
+    emitGroupStatusChanged(group);
+}
+
+QModelIndex DeviceTreeModel::indexOf(const Node* node, int column) const {
+    return createIndex(node->row, column, const_cast<Node*>(node));
+}
+
+void DeviceTreeModel::emitGroupStatusChanged(GroupNode* group) {
+    QModelIndex idx = indexOf(group, ColStatus);
+    emit dataChanged(idx, idx, {Qt::DisplayRole});
+}
+
+QString DeviceTreeModel::statusText(const DeviceNode& device) const {
+    if (!device.online) {
+        return "Offline";
+    }
+    QString text = snapshot_text::frequency(device.frequencyHz);
+    if (device.transmitting) {
+        text += " [TX]";
+    }
+    return text;
+}
+
+const QIcon& DeviceTreeModel::icon(IconState state) const {
+    switch (state) {
+        case IconState::Error: return m_iconError;
+        case IconState::Ok: return m_iconOk;
+        default: return m_iconOffline;
+    }
+}
+
+} // namespace rcms
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QIcon>
+#include <memory>
+#include <vector>
+#include "core/DeviceGroup.h"
+#include "core/StatusDelta.h"
+
+namespace rcms {
+
+/**
+ * @brief Device tree: groups at the top level, devices under them
+ *
+ * Devices are addressed by their stable deviceId, looked up through a hash
+ * rather than by row, so removing one device never renumbers the others.
+ * Status icons are loaded once; a status update stores the few fields the
+ * tree shows and emits dataChanged only for the cells whose text or icon
+ * actually changed (plus the group's online counter).
+ */
+class DeviceTreeModel : public QAbstractItemModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        ColName,
+        ColAddress,
+        ColStatus,
+        COLUMN_COUNT
+    };
+
+    enum Role {
+        DeviceIdRole = Qt::UserRole,    // QString; empty for group rows
+        GroupIdRole
+    };
+
+    explicit DeviceTreeModel(QObject* parent = nullptr);
+    ~DeviceTreeModel() override;
+
+    /**
+     * @brief Add a group, or update name and colour of an existing one
+     */
+    void addGroup(const DeviceGroup& group);
+
+    /**
+     * @brief Remove a group; its devices move to the ungrouped group
+     */
+    void removeGroup(const QString& groupId);
+
+    /**
+     * @brief Add device under a group (created as ungrouped if unknown)
+     */
+    void addDevice(const QString& deviceId, const QString& name, uint8_t address,
+                   const QString& groupId = groups::UNGROUPED);
+
+    void removeDevice(const QString& deviceId);
+
+    /**
+     * @brief Move device to another group
+     */
+    void setDeviceGroup(const QString& deviceId, const QString& groupId);
+
+    /**
+     * @brief Apply a status delta; no-op for unknown devices
+     */
+    void updateDeviceStatus(const QString& deviceId, const StatusDelta& delta);
+
+    void clear();
+
+    bool contains(const QString& deviceId) const { return m_devices.contains(deviceId); }
+    int deviceCount() const { return m_devices.size(); }
+
+    QModelIndex deviceIndex(const QString& deviceId, int column = ColName) const;
+    QModelIndex groupIndex(const QString& groupId, int column = ColName) const;
+    QString deviceIdAt(const QModelIndex& index) const;
+
+    QModelIndex index(int row, int column,
+                      const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+private:
+    enum class IconState : uint8_t {
+        Offline,
+        Error,
+        Ok
+    };
+
+    struct GroupNode;
+
+    // internalPointer of an index is a Node*: a group or a device
+    struct Node {
+        bool isGroup;
+        int row = 0;                    // Row under the parent, kept in sync
+    };
+
+    struct DeviceNode : Node {
+        DeviceNode() : Node{false} {}
+        QString id;
+        QString name;
+        GroupNode* group = nullptr;
+        uint32_t frequencyHz = 0;
+        uint8_t address = 0;
+        bool online = false;
+        bool transmitting = false;
+        IconState icon = IconState::Offline;
+    };
+
+    struct GroupNode : Node {
+        GroupNode() : Node{true} {}
+        DeviceGroup group;
+        std::vector<std::unique_ptr<DeviceNode>> devices;
+        int onlineCount = 0;
+    };
+
+    GroupNode* findOrCreateGroup(const QString& groupId);
+    void insertGroup(std::unique_ptr<GroupNode> node);
+    std::unique_ptr<DeviceNode> takeDevice(DeviceNode* device);
+    void attachDevice(std::unique_ptr<DeviceNode> device, GroupNode* group);
+    QModelIndex indexOf(const Node* node, int column) const;
+    void emitGroupStatusChanged(GroupNode* group);
+
+    QString statusText(const DeviceNode& device) const;
+    const QIcon& icon(IconState state) const;
+
+    std::vector<std::unique_ptr<GroupNode>> m_groups;   // Sorted by sortOrder
+    QHash<QString, GroupNode*> m_groupById;
+    QHash<QString, DeviceNode*> m_devices;
+
+    // Built once from the resources, shared by every row
+    QIcon m_iconOffline;
+    QIcon m_iconError;
+    QIcon m_iconOk;
+};
+
+} // namespace rcms
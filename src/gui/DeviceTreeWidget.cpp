@@ -4,84 +4,62 @@
 namespace rcms {
 
 DeviceTreeWidget::DeviceTreeWidget(QWidget* parent)
-    : QTreeWidget(parent)
+    : QTreeView(parent)
+    , m_model(new DeviceTreeModel(this))
 {
-    setHeaderLabels({"Устройство", "Адрес", "Статус"});
-    setColumnCount(3);
+    setModel(m_model);
 
     header()->setStretchLastSection(true);
-    setColumnWidth(0, 150);
-    setColumnWidth(1, 50);
+    setColumnWidth(DeviceTreeModel::ColName, 150);
+    setColumnWidth(DeviceTreeModel::ColAddress, 50);
 
-    setRootIsDecorated(false);
+    // All rows are one line: lets the view skip per-row size queries
+    setUniformRowHeights(true);
     setAlternatingRowColors(true);
 
-    connect(this, &QTreeWidget::itemClicked,
-            this, &DeviceTreeWidget::onItemClicked);
+    connect(this, &QTreeView::clicked,
+            this, &DeviceTreeWidget::onClicked);
+    connect(m_model, &QAbstractItemModel::rowsInserted,
+            this, &DeviceTreeWidget::onGroupsInserted);
 }
 
-void DeviceTreeWidget::addDevice(const QString& name, const QString& type, uint8_t address) {
-    auto* item = new QTreeWidgetItem(this);
-    item->setText(0, name);
-    item->setText(1, QString::number(address));
-    item->setText(2, "Offline");
-    item->setData(0, Qt::UserRole, topLevelItemCount() - 1);
-
-    // Set offline icon
-    updateStatusIcon(item, false, false);
+void DeviceTreeWidget::addGroup(const DeviceGroup& group) {
+    m_model->addGroup(group);
+    setExpanded(m_model->groupIndex(group.id), group.expanded);
 }
 
-void DeviceTreeWidget::removeDevice(int index) {
-    if (index >= 0 && index < topLevelItemCount()) {
-        delete takeTopLevelItem(index);
-
-        // Update indices
-        for (int i = index; i < topLevelItemCount(); ++i) {
-            topLevelItem(i)->setData(0, Qt::UserRole, i);
-        }
-    }
+void DeviceTreeWidget::addDevice(const QString& deviceId, const QString& name, uint8_t address,
+                                 const QString& groupId) {
+    m_model->addDevice(deviceId, name, address, groupId);
 }
 
-void DeviceTreeWidget::updateDeviceStatus(size_t index, const DeviceStatus& status) {
-    if (static_cast<int>(index) < topLevelItemCount()) {
-        auto* item = topLevelItem(static_cast<int>(index));
-
-        if (status.online) {
-            QString statusText = QString("%1 МГц").arg(status.frequencyMHz, 0, 'f', 3);
-            if (status.isTransmitting) {
-                statusText += " [TX]";
-            }
-            item->setText(2, statusText);
-        } else {
-            item->setText(2, "Offline");
-        }
+void DeviceTreeWidget::removeDevice(const QString& deviceId) {
+    m_model->removeDevice(deviceId);
+}
 
-        bool hasAlarm = !status.errorCodes.isEmpty();
-        updateStatusIcon(item, status.online, hasAlarm);
-    }
+void DeviceTreeWidget::updateDeviceStatus(const QString& deviceId, const StatusDelta& delta) {
+    m_model->updateDeviceStatus(deviceId, delta);
 }
 
 void DeviceTreeWidget::clear() {
-    QTreeWidget::clear();
+    m_model->clear();
 }
 
-void DeviceTreeWidget::onItemClicked(QTreeWidgetItem* item, int /*column*/) {
-    int index = item->data(0, Qt::UserRole).toInt();
-    emit deviceSelected(index);
+void DeviceTreeWidget::onClicked(const QModelIndex& index) {
+    const QString deviceId = m_model->deviceIdAt(index);
+    if (!deviceId.isEmpty()) {
+        emit deviceSelected(deviceId);
+    }
 }
 
-void DeviceTreeWidget::updateStatusIcon(QTreeWidgetItem* item, bool online, bool hasAlarm) {
-    QIcon icon;
-
-    if (!online) {
-        icon = QIcon(":/icons/device_offline.png");
-    } else if (hasAlarm) {
-        icon = QIcon(":/icons/device_error.png");
-    } else {
-        icon = QIcon(":/icons/device_ok.png");
+void DeviceTreeWidget::onGroupsInserted(const QModelIndex& parent, int first, int last) {
+    // New groups open by default; addGroup() then applies the stored state
+    if (parent.isValid()) {
+        return;
+    }
+    for (int row = first; row <= last; ++row) {
+        setExpanded(m_model->index(row, 0), true);
     }
-
-    item->setIcon(0, icon);
 }
 
 } // namespace rcms
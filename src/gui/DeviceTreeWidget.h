@@ -1,50 +1,63 @@
 #pragma once
 
-#include <QTreeWidget>
-#include "protocol/IRadioDevice.h"
+#include <QTreeView>
+#include "core/DeviceGroup.h"
+#include "core/StatusDelta.h"
+#include "DeviceTreeModel.h"
 
 namespace rcms {
 
 /**
- * @brief Widget displaying device tree with status icons
+ * @brief Device tree grouped by site, with status icons
+ *
+ * View over DeviceTreeModel; devices are addressed by deviceId.
  */
-class DeviceTreeWidget : public QTreeWidget {
+class DeviceTreeWidget : public QTreeView {
     Q_OBJECT
 
 public:
     explicit DeviceTreeWidget(QWidget* parent = nullptr);
 
+    /**
+     * @brief Add group (site, function, ...) and apply its expanded state
+     */
+    void addGroup(const DeviceGroup& group);
+
     /**
      * @brief Add device to tree
      */
-    void addDevice(const QString& name, const QString& type, uint8_t address);
+    void addDevice(const QString& deviceId, const QString& name, uint8_t address,
+                   const QString& groupId = groups::UNGROUPED);
 
     /**
-     * @brief Remove device by index
+     * @brief Remove device by id
      */
-    void removeDevice(int index);
+    void removeDevice(const QString& deviceId);
 
     /**
      * @brief Update device status display
      */
-    void updateDeviceStatus(size_t index, const DeviceStatus& status);
+    void updateDeviceStatus(const QString& deviceId, const StatusDelta& delta);
 
     /**
-     * @brief Clear all devices
+     * @brief Clear all groups and devices
      */
     void clear();
 
+    DeviceTreeModel* deviceModel() const { return m_model; }
+
 signals:
     /**
      * @brief Emitted when device is selected
      */
-    void deviceSelected(int index);
+    void deviceSelected(const QString& deviceId);
 
 private slots:
-    void onItemClicked(QTreeWidgetItem* item, int column);
+    void onClicked(const QModelIndex& index);
+    void onGroupsInserted(const QModelIndex& parent, int first, int last);
 
 private:
-    void updateStatusIcon(QTreeWidgetItem* item, bool online, bool hasAlarm);
+    DeviceTreeModel* m_model;
 };
 
 } // namespace rcms
@@ -0,0 +1,171 @@
+#include "EventLogModel.h"
+#include <QColor>
+#include <QDateTime>
+#include <algorithm>
+
+namespace rcms {
+
+EventLogModel::EventLogModel(QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_ring(DEFAULT_CAPACITY)
+    , m_batchTimer(new QTimer(this))
+{
+    // Coalesces an alarm burst into one row insertion
+    m_batchTimer->setSingleShot(true);
+    m_batchTimer->setInterval(BATCH_INTERVAL_MS);
+    connect(m_batchTimer, &QTimer::timeout, this, &EventLogModel::flush);
+}
+
+void EventLogModel::setCapacity(int capacity) {
+    capacity = std::max(1, capacity);
+    if (capacity == static_cast<int>(m_ring.size())) {
+        return;
+    }
+
+    flush();
+    beginResetModel();
+    std::vector<Entry> ring(static_cast<size_t>(capacity));
+    const uint64_t keep = std::min<uint64_t>(m_nextSeq - m_firstSeq, ring.size());
+    for (uint64_t seq = m_nextSeq - keep; seq < m_nextSeq; ++seq) {
+        ring[seq % ring.size()] = m_ring[seq % m_ring.size()];
+    }
+    m_ring.swap(ring);
+    m_firstSeq = m_nextSeq - keep;
+    endResetModel();
+}
+
+void EventLogModel::append(const AlarmEvent& event) {
+    Entry entry;
+    entry.timestampMs = event.timestamp.toMSecsSinceEpoch();
+    entry.device = m_strings.intern(event.deviceName);
+    entry.message = m_strings.intern(event.alarm.message);
+    entry.code = event.alarm.code;
+    entry.address = event.deviceAddress;
+    entry.severity = event.alarm.severity;
+    m_pending.push_back(entry);
+
+    if (!m_batchTimer->isActive()) {
+        m_batchTimer->start();
+    }
+}
+
+void EventLogModel::flush() {
+    m_batchTimer->stop();
+    if (m_pending.empty()) {
+        return;
+    }
+
+    const uint64_t capacity = m_ring.size();
+
+    // More than a ring's worth: only the newest can ever be shown
+    size_t skip = 0;
+    if (m_pending.size() > capacity) {
+        skip = m_pending.size() - static_cast<size_t>(capacity);
+    }
+    const uint64_t incoming = m_pending.size() - skip;
+
+    // Evict the oldest rows (bottom) to make room
+    const uint64_t stored = m_nextSeq - m_firstSeq;
+    const uint64_t evict = stored + incoming > capacity ? stored + incoming - capacity : 0;
+    if (evict > 0) {
+        const int last = static_cast<int>(stored) - 1;
+        beginRemoveRows(QModelIndex(), last - static_cast<int>(evict) + 1, last);
+        m_firstSeq += evict;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), 0, static_cast<int>(incoming) - 1);
+    for (size_t i = skip; i < m_pending.size(); ++i) {
+        m_ring[m_nextSeq % capacity] = m_pending[i];
+        ++m_nextSeq;
+    }
+    endInsertRows();
+
+    m_pending.clear();
+}
+
+void EventLogModel::clear() {
+    m_batchTimer->stop();
+    m_pending.clear();
+    beginResetModel();
+    m_firstSeq = m_nextSeq;
+    endResetModel();
+}
+
+int EventLogModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_nextSeq - m_firstSeq);
+}
+
+int EventLogModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : COLUMN_COUNT;
+}
+
+QVariant EventLogModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    const Entry& e = entryAt(index.row());
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+            case ColTime:
+                return QDateTime::fromMSecsSinceEpoch(e.timestampMs).toString("hh:mm:ss");
+            case ColDevice:
+                return QString("%1 [%2]").arg(m_strings.str(e.device)).arg(e.address);
+            case ColSeverity:
+                return severityToString(e.severity);
+            case ColCode:
+                return QString("0x%1").arg(e.code, 4, 16, QChar('0')).toUpper();
+            case ColMessage:
+                return m_strings.str(e.message);
+            default:
+                return QVariant();
+        }
+    }
+
+    if (role == Qt::BackgroundRole && index.column() == ColSeverity) {
+        return severityToColor(e.severity);
+    }
+
+    if (role == Qt::ToolTipRole && index.column() == ColTime) {
+        return QDateTime::fromMSecsSinceEpoch(e.timestampMs).toString("dd.MM.yyyy hh:mm:ss.zzz");
+    }
+
+    return QVariant();
+}
+
+QVariant EventLogModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+        case ColTime: return "Время";
+        case ColDevice: return "Устройство";
+        case ColSeverity: return "Тип";
+        case ColCode: return "Код";
+        case ColMessage: return "Сообщение";
+        default: return QVariant();
+    }
+}
+
+QString EventLogModel::severityToString(AlarmSeverity severity) {
+    switch (severity) {
+        case AlarmSeverity::Info: return "Инфо";
+        case AlarmSeverity::Warning: return "Внимание";
+        case AlarmSeverity::Error: return "Ошибка";
+        case AlarmSeverity::Critical: return "Авария";
+        default: return "?";
+    }
+}
+
+QColor EventLogModel::severityToColor(AlarmSeverity severity) {
+    switch (severity) {
+        case AlarmSeverity::Info: return QColor(200, 200, 255);
+        case AlarmSeverity::Warning: return QColor(255, 255, 150);
+        case AlarmSeverity::Error: return QColor(255, 200, 150);
+        case AlarmSeverity::Critical: return QColor(255, 150, 150);
+        default: return QColor(255, 255, 255);
+    }
+}
+
+} // namespace rcms
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QTimer>
+#include <vector>
+#include "core/AlarmManager.h"
+#include "core/StringPool.h"
+
+namespace rcms {
+
+/**
+ * @brief Event log rows over a fixed-capacity ring, newest first
+ *
+ * append() only stores a compact entry (names and messages interned) and
+ * arms a short timer; pending entries reach the view in one
+ * beginInsertRows/endInsertRows per batch, evicting the oldest rows past
+ * capacity in one beginRemoveRows. Display text and colours are produced
+ * in data(), i.e. only for rows the view actually paints.
+ */
+class EventLogModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        ColTime,
+        ColDevice,
+        ColSeverity,
+        ColCode,
+        ColMessage,
+        COLUMN_COUNT
+    };
+
+    static constexpr int DEFAULT_CAPACITY = 100000;
+    static constexpr int BATCH_INTERVAL_MS = 50;
+
+    explicit EventLogModel(QObject* parent = nullptr);
+
+    void setCapacity(int capacity);
+    int capacity() const { return static_cast<int>(m_ring.size()); }
+
+    /**
+     * @brief Queue an event; shown with the next batch
+     */
+    void append(const AlarmEvent& event);
+
+    /**
+     * @brief Insert queued events now
+     */
+    void flush();
+
+    void clear();
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    static QString severityToString(AlarmSeverity severity);
+    static QColor severityToColor(AlarmSeverity severity);
+
+private:
+    struct Entry {
+        int64_t timestampMs = 0;
+        StringPool::Handle device = 0;
+        StringPool::Handle message = 0;
+        uint16_t code = 0;
+        uint8_t address = 0;
+        AlarmSeverity severity = AlarmSeverity::Info;
+    };
+
+    // Row 0 is the newest stored entry
+    const Entry& entryAt(int row) const {
+        return m_ring[(m_nextSeq - 1 - static_cast<uint64_t>(row)) % m_ring.size()];
+    }
+
+    std::vector<Entry> m_ring;
+    uint64_t m_firstSeq = 0;    // Stored entries are [m_firstSeq, m_nextSeq)
+    uint64_t m_nextSeq = 0;
+    std::vector<Entry> m_pending;
+    StringPool m_strings;
+    QTimer* m_batchTimer;
+};
+
+} // namespace rcms
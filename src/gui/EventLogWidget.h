@@ -1,14 +1,18 @@
 #pragma once
 
-#include <QTableWidget>
+#include <QTableView>
 #include "core/AlarmManager.h"
+#include "EventLogModel.h"
 
 namespace rcms {
 
 /**
  * @brief Widget displaying event log table
+ *
+ * A view over EventLogModel: only visible rows are formatted and painted,
+ * so the retained history size does not affect redraw cost.
  */
-class EventLogWidget : public QTableWidget {
+class EventLogWidget : public QTableView {
     Q_OBJECT
 
 public:
@@ -24,10 +28,12 @@ public:
      */
     void clearEvents();
 
+    EventLogModel* eventModel() const { return m_model; }
+
 private:
     void setupUI();
-    QString severityToString(AlarmSeverity severity);
-    QColor severityToColor(AlarmSeverity severity);
+
+    EventLogModel* m_model;
 };
 
 } // namespace rcms
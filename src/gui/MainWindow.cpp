@@ -5,6 +5,7 @@
 #include "ControlPanel.h"
 #include "EventLogWidget.h"
 #include "SettingsDialog.h"
+#include "UpdateCoalescer.h"
 #include "core/Logger.h"
 
 #include <QMenuBar>
@@ -15,12 +16,16 @@
 #include <QDockWidget>
 #include <QMessageBox>
 #include <QCloseEvent>
+#include <QLabel>
 
 namespace rcms {
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , m_alarmJournal(std::make_unique<AlarmJournal>())
+    , m_telemetryStore(std::make_unique<TelemetryStore>())
+    , m_telemetryArchive(std::make_unique<TelemetryArchive>())
     , m_deviceManager(std::make_unique<DeviceManager>(this))
     , m_alarmManager(std::make_unique<AlarmManager>(this))
     , m_configManager(std::make_unique<ConfigManager>())
@@ -36,6 +41,26 @@ MainWindow::MainWindow(QWidget* parent)
     setupConnections();
     loadConfiguration();
 
+    // After connections, so restored alarms reach the event log
+    if (!m_alarmJournal->open(ALARM_JOURNAL_FILE)) {
+        Logger::error("Alarm journal unavailable: {}", m_alarmJournal->lastError());
+    }
+    m_alarmManager->attachJournal(m_alarmJournal.get());
+    for (const AlarmEvent& event : m_alarmManager->activeAlarms()) {
+        m_deviceManager->restoreAlarm(event.deviceAddress, event.alarm.code);
+    }
+
+    if (m_telemetryStore->open(TELEMETRY_FILE)) {
+        m_deviceManager->setTelemetryStore(m_telemetryStore.get());
+    } else {
+        Logger::error("Telemetry store unavailable: {}", m_telemetryStore->lastError());
+    }
+    if (m_telemetryArchive->open(TELEMETRY_ARCHIVE_FILE)) {
+        m_deviceManager->setTelemetryArchive(m_telemetryArchive.get());
+    } else {
+        Logger::error("Telemetry archive unavailable: {}", m_telemetryArchive->lastError());
+    }
+
     statusBar()->showMessage("Готов к работе");
 }
 
@@ -74,6 +99,11 @@ void MainWindow::setupUI() {
     m_eventLog = new EventLogWidget(this);
     logDock->setWidget(m_eventLog);
     addDockWidget(Qt::BottomDockWidgetArea, logDock);
+
+    // Status and alarm updates reach the widgets at the refresh rate
+    m_updateCoalescer = new UpdateCoalescer(this);
+    m_updateRateLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(m_updateRateLabel);
 }
 
 void MainWindow::setupMenus() {
@@ -109,22 +139,41 @@ void MainWindow::setupConnections() {
     connect(m_deviceTree, &DeviceTreeWidget::deviceSelected,
             this, &MainWindow::onDeviceSelected);
 
+    // Indexes shift on removal; the coalescer holds updates by deviceId
     connect(m_deviceManager.get(), &DeviceManager::deviceStatusChanged,
+            [this](size_t index, const StatusDelta& delta) {
+                if (auto device = m_deviceManager->device(index)) {
+                    m_updateCoalescer->postStatus(device->deviceId(), delta);
+                }
+            });
+    connect(m_updateCoalescer, &UpdateCoalescer::statusReady,
             this, &MainWindow::onDeviceStatusChanged);
 
     connect(m_deviceManager.get(), &DeviceManager::alarmDetected,
             this, &MainWindow::onAlarmDetected);
 
+    connect(m_deviceManager.get(), &DeviceManager::alarmCleared,
+            this, &MainWindow::onAlarmCleared);
+
     connect(m_alarmManager.get(), &AlarmManager::alarmAdded,
+            m_updateCoalescer, &UpdateCoalescer::postAlarm);
+    connect(m_updateCoalescer, &UpdateCoalescer::alarmReady,
             [this](const AlarmEvent& event) {
                 m_eventLog->addEvent(event);
             });
+
+    connect(m_updateCoalescer, &UpdateCoalescer::rateUpdated,
+            [this](int received, int delivered) {
+                m_updateRateLabel->setText(QString("Обновления: %1/с, отрисовано: %2/с")
+                                               .arg(received).arg(delivered));
+            });
 }
 
 void MainWindow::loadConfiguration() {
     if (!m_configManager->load("config/default.json")) {
         Logger::warn("Using default configuration");
     }
+    m_updateCoalescer->setRefreshRate(m_configManager->guiRefreshRate());
 
     // TODO: Create devices from configuration
 }
@@ -139,8 +188,15 @@ void MainWindow::closeEvent(QCloseEvent* event) {
     event->accept();
 }
 
-void MainWindow::onDeviceSelected(int index) {
+void MainWindow::onDeviceSelected(const QString& deviceId) {
+    const int index = m_deviceManager->indexOf(deviceId);
     m_selectedDevice = index;
+    m_selectedDeviceId = index >= 0 ? deviceId : QString();
+    m_statusPanel->clear();
+
+    // Full telemetry every cycle for the device shown in StatusPanel;
+    // also replays its last status into the panel
+    m_deviceManager->setFocusedDevice(index);
 
     if (index >= 0 && static_cast<size_t>(index) < m_deviceManager->devices().size()) {
         auto device = m_deviceManager->device(index);
@@ -150,11 +206,11 @@ void MainWindow::onDeviceSelected(int index) {
     }
 }
 
-void MainWindow::onDeviceStatusChanged(size_t index, const DeviceStatus& status) {
-    m_deviceTree->updateDeviceStatus(index, status);
+void MainWindow::onDeviceStatusChanged(const QString& deviceId, const StatusDelta& delta) {
+    m_deviceTree->updateDeviceStatus(deviceId, delta);
 
-    if (static_cast<int>(index) == m_selectedDevice) {
-        m_statusPanel->updateStatus(status);
+    if (!m_selectedDeviceId.isEmpty() && deviceId == m_selectedDeviceId) {
+        m_statusPanel->updateStatus(delta);
     }
 }
 
@@ -166,6 +222,13 @@ void MainWindow::onAlarmDetected(size_t index, const AlarmInfo& alarm) {
     m_alarmManager->addAlarm(deviceName, address, alarm);
 }
 
+void MainWindow::onAlarmCleared(size_t index, uint16_t code) {
+    auto device = m_deviceManager->device(index);
+    if (device) {
+        m_alarmManager->clearAlarm(device->modbusAddress(), code);
+    }
+}
+
 void MainWindow::onAddDevice() {
     // TODO: Show add device dialog
     QMessageBox::information(this, "Добавить устройство",
@@ -173,10 +236,12 @@ void MainWindow::onAddDevice() {
 }
 
 void MainWindow::onRemoveDevice() {
-    if (m_selectedDevice >= 0) {
+    if (auto device = m_deviceManager->device(m_selectedDevice)) {
+        m_updateCoalescer->discardStatus(device->deviceId());
+        m_deviceTree->removeDevice(device->deviceId());
         m_deviceManager->removeDevice(m_selectedDevice);
-        m_deviceTree->removeDevice(m_selectedDevice);
         m_selectedDevice = -1;
+        m_selectedDeviceId.clear();
     }
 }
 
@@ -6,6 +6,8 @@
 #include "core/AlarmManager.h"
 #include "core/ConfigManager.h"
 
+class QLabel;
+
 namespace Ui {
 class MainWindow;
 }
@@ -16,6 +18,7 @@ class DeviceTreeWidget;
 class StatusPanel;
 class ControlPanel;
 class EventLogWidget;
+class UpdateCoalescer;
 
 /**
  * @brief Main application window
@@ -31,9 +34,10 @@ protected:
     void closeEvent(QCloseEvent* event) override;
 
 private slots:
-    void onDeviceSelected(int index);
-    void onDeviceStatusChanged(size_t index, const DeviceStatus& status);
+    void onDeviceSelected(const QString& deviceId);
+    void onDeviceStatusChanged(const QString& deviceId, const StatusDelta& delta);
     void onAlarmDetected(size_t index, const AlarmInfo& alarm);
+    void onAlarmCleared(size_t index, uint16_t code);
 
     void onAddDevice();
     void onRemoveDevice();
@@ -53,7 +57,10 @@ private:
 
     Ui::MainWindow* ui;
 
-    // Managers
+    // Managers (stores first: they outlive the managers feeding them)
+    std::unique_ptr<AlarmJournal> m_alarmJournal;
+    std::unique_ptr<TelemetryStore> m_telemetryStore;
+    std::unique_ptr<TelemetryArchive> m_telemetryArchive;
     std::unique_ptr<DeviceManager> m_deviceManager;
     std::unique_ptr<AlarmManager> m_alarmManager;
     std::unique_ptr<ConfigManager> m_configManager;
@@ -63,8 +70,16 @@ private:
     StatusPanel* m_statusPanel;
     ControlPanel* m_controlPanel;
     EventLogWidget* m_eventLog;
+    QLabel* m_updateRateLabel;
+
+    UpdateCoalescer* m_updateCoalescer;
 
     int m_selectedDevice = -1;
+    QString m_selectedDeviceId;
+
+    static constexpr const char* ALARM_JOURNAL_FILE = "rcms-ga-alarms.db";
+    static constexpr const char* TELEMETRY_FILE = "rcms-ga-telemetry.db";
+    static constexpr const char* TELEMETRY_ARCHIVE_FILE = "rcms-ga-telemetry.rta";
 };
 
 } // namespace rcms
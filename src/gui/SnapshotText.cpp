@@ -0,0 +1,40 @@
+#include "SnapshotText.h"
+#include <QDateTime>
+
+namespace rcms {
+namespace snapshot_text {
+
+QString controlMode(ControlMode mode) {
+    return mode == ControlMode::Remote ? QStringLiteral("ДУ") : QStringLiteral("МУ");
+}
+
+QString workMode(WorkMode mode) {
+    return mode == WorkMode::Data ? QStringLiteral("ДАН") : QStringLiteral("ТЛФ");
+}
+
+QString lineType(LineType type) {
+    return type == LineType::FourWire ? QStringLiteral("4-х") : QStringLiteral("2-х");
+}
+
+QString frequency(uint32_t frequencyHz) {
+    return QString("%1 МГц").arg(frequencyHz / 1e6, 0, 'f', 3);
+}
+
+QString voltage(int16_t decivolts) {
+    return QString("%1 В").arg(decivolts / 10.0, 0, 'f', 1);
+}
+
+QString temperature(int16_t decidegrees) {
+    return QString("%1 °C").arg(decidegrees / 10.0, 0, 'f', 1);
+}
+
+QString time(int64_t timestampNs) {
+    if (timestampNs == 0) {
+        return "-";
+    }
+    return QDateTime::fromMSecsSinceEpoch(snapshot_clock::toEpochMs(timestampNs))
+        .toString("hh:mm:ss");
+}
+
+} // namespace snapshot_text
+} // namespace rcms
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QString>
+#include "protocol/DeviceSnapshot.h"
+
+namespace rcms {
+
+/**
+ * @brief Operator-facing text for DeviceSnapshot values
+ *
+ * The only place snapshot fields become strings; called by widgets for
+ * the cells and labels they actually redraw.
+ */
+namespace snapshot_text {
+
+QString controlMode(ControlMode mode);
+QString workMode(WorkMode mode);
+QString lineType(LineType type);
+
+/**
+ * @brief "123.456 МГц"
+ */
+QString frequency(uint32_t frequencyHz);
+
+QString voltage(int16_t decivolts);
+QString temperature(int16_t decidegrees);
+
+/**
+ * @brief Local wall-clock time of a snapshot, "hh:mm:ss"
+ */
+QString time(int64_t timestampNs);
+
+} // namespace snapshot_text
+} // namespace rcms
@@ -1,4 +1,5 @@
 #include "StatusPanel.h"
+#include "SnapshotText.h"
 #include <QVBoxLayout>
 #include <QGridLayout>
 #include <QFormLayout>
@@ -82,39 +83,62 @@ void StatusPanel::setupUI() {
     mainLayout->addStretch();
 }
 
-void StatusPanel::updateStatus(const DeviceStatus& status) {
+void StatusPanel::updateStatus(const StatusDelta& delta) {
+    using namespace status_fields;
+    const DeviceSnapshot& status = delta.status;
+
     // Connection status
-    if (status.online) {
-        m_lblOnline->setText("<span style='color: green;'>Есть</span>");
-    } else {
-        m_lblOnline->setText("<span style='color: red;'>Нет</span>");
+    if (delta.has(Online)) {
+        if (status.online) {
+            m_lblOnline->setText("<span style='color: green;'>Есть</span>");
+        } else {
+            m_lblOnline->setText("<span style='color: red;'>Нет</span>");
+        }
     }
 
     // Frequency
-    m_lblFrequency->setText(formatFrequency(status.frequencyMHz));
+    if (delta.has(Frequency)) {
+        m_lblFrequency->setText(snapshot_text::frequency(status.frequencyHz));
+    }
 
     // Modes
-    m_lblMode->setText(status.mode);
-    m_lblWorkMode->setText(status.workMode);
-    m_lblLineType->setText(status.lineType);
+    if (delta.has(Mode)) {
+        m_lblMode->setText(snapshot_text::controlMode(status.controlMode));
+        m_lblWorkMode->setText(snapshot_text::workMode(status.workMode));
+        m_lblLineType->setText(snapshot_text::lineType(status.lineType));
+    }
 
     // TX status
-    if (status.isTransmitting) {
-        m_lblTransmitting->setText("<span style='color: red; font-weight: bold;'>ВКЛ</span>");
-    } else {
-        m_lblTransmitting->setText("ВЫКЛ");
+    if (delta.has(Transmitting)) {
+        if (status.isTransmitting) {
+            m_lblTransmitting->setText("<span style='color: red; font-weight: bold;'>ВКЛ</span>");
+        } else {
+            m_lblTransmitting->setText("ВЫКЛ");
+        }
     }
 
     // Squelch
-    m_lblSquelch->setText(status.squelchEnabled ?
-                          QString("ВКЛ (ур. %1)").arg(status.squelchLevel) : "ВЫКЛ");
+    if (delta.has(Squelch)) {
+        m_lblSquelch->setText(status.squelchEnabled ?
+                              QString("ВКЛ (ур. %1)").arg(status.squelchLevel) : "ВЫКЛ");
+    }
 
     // Parameters
-    m_lblSignalLevel->setText(QString::number(status.signalLevel));
-    m_lblVoltage->setText(QString("%1 В").arg(status.voltage24V, 0, 'f', 1));
-    m_lblTemperature->setText(QString("%1 °C").arg(status.temperature, 0, 'f', 1));
-    m_lblOperatingHours->setText(QString("%1 ч").arg(status.operatingHours));
-    m_lblLastUpdate->setText(status.lastUpdate.toString("hh:mm:ss"));
+    if (delta.has(SignalLevel)) {
+        m_lblSignalLevel->setText(QString::number(status.signalLevel));
+    }
+    if (delta.has(Voltage)) {
+        m_lblVoltage->setText(snapshot_text::voltage(status.voltage24dV));
+    }
+    if (delta.has(Temperature)) {
+        m_lblTemperature->setText(snapshot_text::temperature(status.temperaturedC));
+    }
+    if (delta.has(OperatingHours)) {
+        m_lblOperatingHours->setText(QString("%1 ч").arg(status.operatingHours));
+    }
+    if (delta.has(LastUpdate)) {
+        m_lblLastUpdate->setText(snapshot_text::time(status.timestampNs));
+    }
 }
 
 void StatusPanel::clear() {
@@ -132,8 +156,4 @@ void StatusPanel::clear() {
     m_lblLastUpdate->setText("-");
 }
 
-QString StatusPanel::formatFrequency(double freqMHz) {
-    return QString("%1 МГц").arg(freqMHz, 0, 'f', 3);
-}
-
 } // namespace rcms
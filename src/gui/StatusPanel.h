@@ -3,7 +3,7 @@
 #include <QWidget>
 #include <QLabel>
 #include <QGroupBox>
-#include "protocol/IRadioDevice.h"
+#include "core/StatusDelta.h"
 
 namespace rcms {
 
@@ -17,9 +17,9 @@ public:
     explicit StatusPanel(QWidget* parent = nullptr);
 
     /**
-     * @brief Update display with new status
+     * @brief Update the labels of the changed fields
      */
-    void updateStatus(const DeviceStatus& status);
+    void updateStatus(const StatusDelta& delta);
 
     /**
      * @brief Clear all displayed values
@@ -28,7 +28,6 @@ public:
 
 private:
     void setupUI();
-    QString formatFrequency(double freqMHz);
 
     // Labels for status values
     QLabel* m_lblOnline;
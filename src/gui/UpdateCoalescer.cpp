@@ -0,0 +1,110 @@
+#include "UpdateCoalescer.h"
+#include <algorithm>
+
+namespace rcms {
+
+UpdateCoalescer::UpdateCoalescer(QObject* parent)
+    : QObject(parent)
+    , m_frameTimer(new QTimer(this))
+    , m_statsTimer(new QTimer(this))
+{
+    // Armed by the first update after a flush: no wakeups while idle
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setInterval(1000 / m_refreshRate);
+    connect(m_frameTimer, &QTimer::timeout, this, &UpdateCoalescer::flush);
+
+    m_statsTimer->setInterval(STATS_INTERVAL_MS);
+    connect(m_statsTimer, &QTimer::timeout, this, &UpdateCoalescer::onStatsTimer);
+    m_statsTimer->start();
+}
+
+void UpdateCoalescer::setRefreshRate(int hz) {
+    m_refreshRate = std::clamp(hz, 1, 60);
+    m_frameTimer->setInterval(1000 / m_refreshRate);
+}
+
+void UpdateCoalescer::postStatus(const QString& deviceId, const StatusDelta& delta) {
+    ++m_receivedTotal;
+    ++m_receivedWindow;
+
+    PendingStatus& pending = m_status[deviceId];
+    if (pending.dirty) {
+        pending.delta.merge(delta);
+    } else {
+        pending.delta = delta;
+        pending.dirty = true;
+        m_dirty.push_back(deviceId);
+    }
+    schedule();
+}
+
+void UpdateCoalescer::discardStatus(const QString& deviceId) {
+    // Its id may still sit in m_dirty; flush skips ids it can't find
+    m_status.remove(deviceId);
+}
+
+void UpdateCoalescer::postAlarm(const AlarmEvent& event) {
+    ++m_receivedTotal;
+    ++m_receivedWindow;
+
+    m_alarms.push_back(event);
+    if (event.alarm.severity == AlarmSeverity::Critical) {
+        flush();
+    } else {
+        schedule();
+    }
+}
+
+void UpdateCoalescer::flush() {
+    if (m_flushing) {
+        m_flushAgain = true;    // Called from a slot we are delivering to
+        return;
+    }
+    m_flushing = true;
+
+    do {
+        m_flushAgain = false;
+        m_frameTimer->stop();
+
+        // Swap out first: slots may post again while we deliver
+        m_deliveringStatus.swap(m_dirty);
+        m_deliveringAlarms.swap(m_alarms);
+
+        for (const QString& deviceId : m_deliveringStatus) {
+            auto it = m_status.find(deviceId);
+            if (it == m_status.end() || !it->dirty) {
+                continue;
+            }
+            StatusDelta delta = it->delta;
+            it->dirty = false;
+            ++m_deliveredTotal;
+            ++m_deliveredWindow;
+            emit statusReady(deviceId, delta);
+        }
+
+        for (const AlarmEvent& event : m_deliveringAlarms) {
+            ++m_deliveredTotal;
+            ++m_deliveredWindow;
+            emit alarmReady(event);
+        }
+
+        m_deliveringStatus.clear();
+        m_deliveringAlarms.clear();
+    } while (m_flushAgain);
+
+    m_flushing = false;
+}
+
+void UpdateCoalescer::onStatsTimer() {
+    emit rateUpdated(m_receivedWindow, m_deliveredWindow);
+    m_receivedWindow = 0;
+    m_deliveredWindow = 0;
+}
+
+void UpdateCoalescer::schedule() {
+    if (!m_frameTimer->isActive()) {
+        m_frameTimer->start();
+    }
+}
+
+} // namespace rcms
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <vector>
+#include "core/AlarmManager.h"
+#include "core/StatusDelta.h"
+
+namespace rcms {
+
+/**
+ * @brief Rate-limits device status and alarm updates on their way to widgets
+ *
+ * Status updates are folded per device (latest values, accumulated change
+ * mask), keyed by the stable deviceId so adding or removing devices never
+ * redirects a pending update, and alarms queued; both are released
+ * together at most refreshRate times per second. A critical alarm flushes
+ * everything at once so it is never held back behind a frame. Counts of
+ * updates received and delivered are reported once a second.
+ */
+class UpdateCoalescer : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int DEFAULT_REFRESH_HZ = 10;
+    static constexpr int STATS_INTERVAL_MS = 1000;
+
+    explicit UpdateCoalescer(QObject* parent = nullptr);
+
+    /**
+     * @brief Frames per second; clamped to 1..60
+     */
+    void setRefreshRate(int hz);
+    int refreshRate() const { return m_refreshRate; }
+
+    /**
+     * @brief Queue a status update; replaces a pending one for the device
+     */
+    void postStatus(const QString& deviceId, const StatusDelta& delta);
+
+    /**
+     * @brief Drop a pending status update, e.g. of a removed device
+     */
+    void discardStatus(const QString& deviceId);
+
+    /**
+     * @brief Queue an alarm; Critical ones are delivered immediately
+     */
+    void postAlarm(const AlarmEvent& event);
+
+    /**
+     * @brief Deliver everything pending now
+     *
+     * Safe to call from a receiving slot: the nested call only makes the
+     * running flush go round once more.
+     */
+    void flush();
+
+    uint64_t receivedTotal() const { return m_receivedTotal; }
+    uint64_t deliveredTotal() const { return m_deliveredTotal; }
+
+signals:
+    void statusReady(const QString& deviceId, const StatusDelta& delta);
+    void alarmReady(const AlarmEvent& event);
+
+    /**
+     * @brief Updates posted vs delivered during the last second
+     */
+    void rateUpdated(int receivedPerSec, int deliveredPerSec);
+
+private slots:
+    void onStatsTimer();
+
+private:
+    struct PendingStatus {
+        StatusDelta delta;
+        bool dirty = false;
+    };
+
+    void schedule();
+
+    QHash<QString, PendingStatus> m_status;     // By deviceId
+    std::vector<QString> m_dirty;               // Ids with a pending update, arrival order
+    std::vector<AlarmEvent> m_alarms;
+
+    // Swapped with the queues while delivering; kept so their capacity is reused
+    std::vector<QString> m_deliveringStatus;
+    std::vector<AlarmEvent> m_deliveringAlarms;
+    bool m_flushing = false;
+    bool m_flushAgain = false;
+
+    QTimer* m_frameTimer;
+    QTimer* m_statsTimer;
+    int m_refreshRate = DEFAULT_REFRESH_HZ;
+
+    uint64_t m_receivedTotal = 0;
+    uint64_t m_deliveredTotal = 0;
+    int m_receivedWindow = 0;
+    int m_deliveredWindow = 0;
+};
+
+} // namespace rcms
@@ -13,6 +13,7 @@
 #include <QApplication>
 #include "gui/MainWindow.h"
 #include "core/Logger.h"
+#include "core/Trace.h"
 #include "core/ConfigManager.h"
 
 int main(int argc, char* argv[]) {
@@ -32,6 +33,12 @@ int main(int argc, char* argv[]) {
         rcms::Logger::warn("Could not load config, using defaults");
     }
 
+    // Binary per-frame trace; decode with rcms-trace
+    if (config.traceEnabled() && !rcms::Trace::start(config.traceConfig())) {
+        rcms::Logger::warn("Could not open trace file {}, tracing disabled",
+                           config.traceConfig().file);
+    }
+
     // Create and show main window
     rcms::MainWindow mainWindow;
     mainWindow.show();
@@ -41,5 +48,7 @@ int main(int argc, char* argv[]) {
     int result = app.exec();
 
     rcms::Logger::info("RCMS-GA shutting down");
+    rcms::Trace::stop();
+    rcms::Logger::shutdown();   // Drain the async queue
     return result;
 }
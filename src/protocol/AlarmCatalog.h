@@ -0,0 +1,83 @@
+#pragma once
+
+#include "IRadioDevice.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace rcms {
+
+/**
+ * @brief Static description of an alarm code
+ */
+struct AlarmCatalogEntry {
+    uint16_t code;
+    AlarmSeverity severity;
+    const char* message;        // UTF-8
+};
+
+/**
+ * @brief Alarm codes of supported devices
+ *
+ * Stored alarms keep only the code; text and severity are resolved here.
+ * Code layout: high byte = DiagVUU word (1-4), low byte = condition.
+ */
+namespace alarm_catalog {
+
+constexpr uint16_t POWER_FAIL = 0x0101;
+constexpr uint16_t PLL_UNLOCK = 0x0102;
+constexpr uint16_t PA_FAIL = 0x0103;
+constexpr uint16_t VSWR_HIGH = 0x0104;
+constexpr uint16_t TEMP_HIGH = 0x0105;
+constexpr uint16_t RX_FAIL = 0x0201;
+constexpr uint16_t BATTERY_LOW = 0x0202;
+
+constexpr AlarmCatalogEntry ENTRIES[] = {
+    {POWER_FAIL,  AlarmSeverity::Critical, "Отказ питания 24В"},
+    {PLL_UNLOCK,  AlarmSeverity::Critical, "Срыв ФАПЧ синтезатора"},
+    {PA_FAIL,     AlarmSeverity::Critical, "Отказ усилителя мощности"},
+    {VSWR_HIGH,   AlarmSeverity::Error,    "КСВ антенны превышен"},
+    {TEMP_HIGH,   AlarmSeverity::Warning,  "Перегрев устройства"},
+    {RX_FAIL,     AlarmSeverity::Error,    "Отказ приёмника"},
+    {BATTERY_LOW, AlarmSeverity::Warning,  "Низкий заряд АКБ"},
+};
+
+/**
+ * @brief Catalog entry for a code, nullptr if unknown
+ */
+constexpr const AlarmCatalogEntry* find(uint16_t code) {
+    for (const AlarmCatalogEntry& entry : ENTRIES) {
+        if (entry.code == code) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+static_assert(find(VSWR_HIGH) && find(VSWR_HIGH)->severity == AlarmSeverity::Error,
+              "catalog lookup");
+
+/**
+ * @brief Operator text for a code
+ */
+inline QString message(uint16_t code) {
+    if (const AlarmCatalogEntry* entry = find(code)) {
+        return QString::fromUtf8(entry->message);
+    }
+    return QString("Неизвестная авария 0x%1").arg(code, 4, 16, QChar('0'));
+}
+
+/**
+ * @brief AlarmInfo for a code raised now (code, severity, text, time)
+ */
+inline AlarmInfo describe(uint16_t code) {
+    const AlarmCatalogEntry* entry = find(code);
+    AlarmInfo info;
+    info.code = code;
+    info.message = message(code);
+    info.severity = entry ? entry->severity : AlarmSeverity::Error;
+    info.timestamp = QDateTime::currentDateTime();
+    return info;
+}
+
+} // namespace alarm_catalog
+} // namespace rcms
@@ -0,0 +1,288 @@
+#include "BusMaster.h"
+#include "core/Logger.h"
+#include <QHash>
+#include <algorithm>
+
+namespace rcms {
+
+namespace {
+// Control commands between latency reports
+constexpr uint64_t LATENCY_REPORT_EVERY = 100;
+
+// Period of the per-bus diagnostics log line
+constexpr int DIAGNOSTICS_LOG_INTERVAL_MS = 60000;
+
+// Live buses by key; entries expire with the last device using the bus.
+// Accessed from the GUI thread only.
+QHash<QString, std::weak_ptr<BusMaster>>& registry() {
+    static QHash<QString, std::weak_ptr<BusMaster>> buses;
+    return buses;
+}
+}
+
+BusMaster::BusMaster(const ConnectionProfile& profile)
+    : m_key(busKey(profile))
+    , m_profile(profile)
+    , m_thread(new QThread(this))
+    , m_modbus(new ModbusRTU())
+    , m_diagnosticsTimer(new QTimer(this))
+{
+    m_modbus->setTimeout(profile.responseTimeoutMs);
+    m_modbus->setTiming(profile.rtuTiming());
+    m_modbus->setSilenceTolerance(profile.silenceToleranceMs());
+
+    // Engine (with its timers) runs on the bus thread and dies with it
+    m_modbus->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_modbus, &QObject::deleteLater);
+
+    m_thread->setObjectName(QString("bus:%1").arg(m_key));
+    m_thread->start();
+
+    m_diagnosticsTimer->setInterval(DIAGNOSTICS_LOG_INTERVAL_MS);
+    connect(m_diagnosticsTimer, &QTimer::timeout, this, &BusMaster::onDiagnosticsTimer);
+}
+
+BusMaster::~BusMaster() {
+    close();
+
+    m_thread->quit();
+    m_thread->wait();
+
+    auto it = registry().find(m_key);
+    if (it != registry().end() && it->expired()) {
+        registry().erase(it);
+    }
+}
+
+std::shared_ptr<BusMaster> BusMaster::acquire(const ConnectionProfile& profile) {
+    const QString key = busKey(profile);
+
+    if (auto bus = registry().value(key).lock()) {
+        const ConnectionProfile& current = bus->profile();
+        if (current.baudRate != profile.baudRate || current.parity != profile.parity ||
+            current.dataBits != profile.dataBits || current.stopBits != profile.stopBits) {
+            Logger::warn("Bus {} already open at {} baud, ignoring {} baud",
+                         key.toStdString(), current.baudRate, profile.baudRate);
+        }
+        return bus;
+    }
+
+    std::shared_ptr<BusMaster> bus(new BusMaster(profile));
+    registry().insert(key, bus);
+    return bus;
+}
+
+QString BusMaster::busKey(const ConnectionProfile& profile) {
+    if (profile.type == ConnectionType::COM) {
+        return profile.comPort;
+    }
+    return QString("%1:%2").arg(profile.tcpHost).arg(profile.tcpPort);
+}
+
+void BusMaster::runOnWorker(const std::function<void()>& task) const {
+    if (QThread::currentThread() == m_thread) {
+        task();
+    } else {
+        QMetaObject::invokeMethod(m_modbus, task, Qt::BlockingQueuedConnection);
+    }
+}
+
+bool BusMaster::open() {
+    if (isOpen()) {
+        return true;
+    }
+
+    // Port/socket is created on the worker so its notifiers live there
+    QString error;
+    runOnWorker([this, &error]() {
+        if (!m_transport) {
+            m_transport = m_profile.createTransport();
+        }
+        if (!m_transport->open()) {
+            error = m_transport->lastError();
+            return;
+        }
+        m_modbus->setDevice(m_transport->device());
+        m_open.store(true, std::memory_order_release);
+    });
+
+    if (!isOpen()) {
+        m_lastError = error;
+        Logger::error("Failed to open bus {}: {}", m_key.toStdString(), error.toStdString());
+        return false;
+    }
+
+    Logger::info("Opened bus {} on worker thread", m_key.toStdString());
+    m_diagnosticsTimer->start();
+    return true;
+}
+
+void BusMaster::close() {
+    bool wasOpen = isOpen();
+    m_diagnosticsTimer->stop();
+    const LatencyStats::Summary poll = latency(TransactionPriority::Poll);
+
+    runOnWorker([this, wasOpen, &poll]() {
+        if (wasOpen) {
+            logDiagnostics(poll);
+        }
+        m_modbus->setDevice(nullptr);
+        if (m_transport) {
+            m_transport->close();
+            m_transport.reset();
+        }
+        m_open.store(false, std::memory_order_release);
+    });
+
+    if (wasOpen) {
+        Logger::info("Closed bus {}", m_key.toStdString());
+    }
+}
+
+void BusMaster::attach(const void* owner) {
+    m_owners.insert(owner);
+}
+
+void BusMaster::detach(const void* owner) {
+    m_owners.remove(owner);
+
+    ModbusRTU* modbus = m_modbus;
+    QMetaObject::invokeMethod(modbus, [modbus, owner]() {
+        modbus->cancel(owner);
+    }, Qt::QueuedConnection);
+}
+
+template <typename Completion>
+void BusMaster::deliver(const void* owner, TransactionPriority priority,
+                        Clock::time_point submitted, const QString& error,
+                        Completion&& completion) {
+    // Called on the worker; the handler runs on this object's thread. The
+    // completion is stored in the queued call as is, not in a std::function
+    QMetaObject::invokeMethod(this, [this, owner, priority, submitted, error,
+                                     completion = std::forward<Completion>(completion)]() {
+        const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - submitted);
+        LatencyStats& stats = m_latency[static_cast<size_t>(priority)];
+        stats.record(latency.count());
+
+        // Periodic report of operator command latency
+        if (priority == TransactionPriority::Control && stats.count() % LATENCY_REPORT_EVERY == 0) {
+            auto summary = stats.summary();
+            Logger::info("Bus {} control latency: p50 {} us, p90 {} us, p99 {} us, max {} us",
+                         m_key.toStdString(), summary.p50, summary.p90, summary.p99, summary.max);
+        }
+
+        if (!m_owners.contains(owner)) {
+            return; // Device detached while the request was in flight
+        }
+        m_lastError = error;
+        completion();
+    }, Qt::QueuedConnection);
+}
+
+void BusMaster::readHoldingRegisters(uint8_t address, uint16_t startReg, uint16_t count,
+                                     ReadHandler handler, const void* owner,
+                                     TransactionPriority priority, int timeoutMs) {
+    const auto submitted = Clock::now();
+    ModbusRTU* modbus = m_modbus;
+    QMetaObject::invokeMethod(modbus, [this, modbus, address, startReg, count, owner, priority,
+                                       timeoutMs, submitted, handler = std::move(handler)]() mutable {
+        modbus->readHoldingRegisters(address, startReg, count,
+                                     [this, modbus, owner, priority, submitted,
+                                      handler = std::move(handler)](
+                                         bool ok, ConstRegisterSpan values) mutable {
+            // Engine buffer is reused by the next transaction: copy out,
+            // into the queued call rather than a block of its own
+            RegisterBlock block;
+            if (ok) {
+                block.count = static_cast<uint16_t>(values.size());
+                std::copy(values.begin(), values.end(), block.values.begin());
+            }
+            deliver(owner, priority, submitted, ok ? QString() : modbus->lastError(),
+                    [handler = std::move(handler), ok, block]() {
+                if (handler) {
+                    handler(ok, ConstRegisterSpan(block.values.data(), block.count));
+                }
+            });
+        }, owner, priority, timeoutMs);
+    }, Qt::QueuedConnection);
+}
+
+void BusMaster::writeSingleRegister(uint8_t address, uint16_t reg, uint16_t value,
+                                    WriteHandler handler, const void* owner,
+                                    TransactionPriority priority) {
+    const auto submitted = Clock::now();
+    ModbusRTU* modbus = m_modbus;
+    QMetaObject::invokeMethod(modbus, [this, modbus, address, reg, value, owner, priority,
+                                       submitted, handler = std::move(handler)]() mutable {
+        modbus->writeSingleRegister(address, reg, value,
+                                    [this, modbus, owner, priority, submitted,
+                                     handler = std::move(handler)](bool ok) mutable {
+            deliver(owner, priority, submitted, ok ? QString() : modbus->lastError(),
+                    [handler = std::move(handler), ok]() {
+                if (handler) {
+                    handler(ok);
+                }
+            });
+        }, owner, priority);
+    }, Qt::QueuedConnection);
+}
+
+void BusMaster::writeMultipleRegisters(uint8_t address, uint16_t startReg, ConstRegisterSpan values,
+                                       WriteHandler handler, const void* owner,
+                                       TransactionPriority priority) {
+    const auto submitted = Clock::now();
+
+    // Caller's span does not outlive this call; the engine encodes the
+    // frame before the queued call ends
+    RegisterBlock block;
+    block.count = static_cast<uint16_t>(std::min<size_t>(values.size(), block.values.size()));
+    std::copy(values.begin(), values.begin() + block.count, block.values.begin());
+
+    ModbusRTU* modbus = m_modbus;
+    QMetaObject::invokeMethod(modbus, [this, modbus, address, startReg, block, owner, priority,
+                                       submitted, handler = std::move(handler)]() mutable {
+        modbus->writeMultipleRegisters(address, startReg,
+                                       ConstRegisterSpan(block.values.data(), block.count),
+                                       [this, modbus, owner, priority, submitted,
+                                        handler = std::move(handler)](bool ok) mutable {
+            deliver(owner, priority, submitted, ok ? QString() : modbus->lastError(),
+                    [handler = std::move(handler), ok]() {
+                if (handler) {
+                    handler(ok);
+                }
+            });
+        }, owner, priority);
+    }, Qt::QueuedConnection);
+}
+
+LatencyStats::Summary BusMaster::latency(TransactionPriority priority) const {
+    return m_latency[static_cast<size_t>(priority)].summary();
+}
+
+void BusMaster::onDiagnosticsTimer() {
+    // Statistics are read where the engine lives; the GUI never waits
+    const LatencyStats::Summary poll = latency(TransactionPriority::Poll);
+    QMetaObject::invokeMethod(m_modbus, [this, poll]() {
+        logDiagnostics(poll);
+    }, Qt::QueuedConnection);
+}
+
+void BusMaster::logDiagnostics(const LatencyStats::Summary& poll) const {
+    const ModbusRTU::Diagnostics& diag = m_modbus->diagnostics();
+    Logger::info("Bus {}: {} ok, {} timeouts, {} incomplete; turnaround avg {} us, "
+                 "min {} us, max {} us; poll latency p50 {} us, p99 {} us",
+                 m_key.toStdString(), diag.transactions, diag.timeouts, diag.incomplete,
+                 diag.averageTurnaroundUs(), diag.minTurnaroundUs, diag.maxTurnaroundUs,
+                 poll.p50, poll.p99);
+}
+
+ModbusRTU::Diagnostics BusMaster::diagnostics() const {
+    ModbusRTU::Diagnostics diag;
+    runOnWorker([this, &diag]() {
+        diag = m_modbus->diagnostics();
+    });
+    return diag;
+}
+
+} // namespace rcms
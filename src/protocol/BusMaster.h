@@ -0,0 +1,171 @@
+#pragma once
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include "ModbusRTU.h"
+#include "comm/ITransport.h"
+#include "core/ConnectionProfile.h"
+#include "core/LatencyStats.h"
+
+namespace rcms {
+
+/**
+ * @brief Master side of one physical RS-485 bus
+ *
+ * Owns the transport (COM port or TCP-Serial bridge) and the Modbus
+ * engine for a bus. All devices on that bus submit their requests to the
+ * same engine queue, so transactions are serialized on the line and the
+ * port is opened exactly once no matter how many devices share it.
+ *
+ * Each bus runs its transport and engine on a dedicated worker thread,
+ * so buses poll in parallel and line I/O never runs on the GUI thread.
+ * Requests are posted to the worker; completions are copied out and
+ * delivered back as queued calls on the thread that owns the BusMaster,
+ * so device code and callbacks stay single-threaded. Register values
+ * travel inside the queued completion rather than a block of their own.
+ * A transaction still allocates: the queued calls to and from the worker
+ * (functor and event each), and the engine's handler wrappers, which
+ * outgrow std::function's inline storage.
+ *
+ * Every request carries a TransactionPriority; the engine queue serves
+ * control commands first. End-to-end latency (submit to completion
+ * delivered) is tracked per priority class. While the bus is open, engine
+ * turnaround statistics and poll latency are logged once a minute, and
+ * once more when it closes.
+ *
+ * Buses are shared through acquire(): devices with the same port (or
+ * host:port) get the same BusMaster. The bus is closed when the last
+ * device releases it.
+ */
+class BusMaster : public QObject {
+    Q_OBJECT
+
+public:
+    using ReadHandler = ModbusRTU::ReadHandler;
+    using WriteHandler = ModbusRTU::WriteHandler;
+
+    ~BusMaster() override;
+
+    /**
+     * @brief Get (or create) the bus for a connection profile
+     *
+     * If the bus already exists with different line settings, the
+     * existing settings win and a warning is logged. Must be called from
+     * the GUI (main) thread.
+     */
+    static std::shared_ptr<BusMaster> acquire(const ConnectionProfile& profile);
+
+    /**
+     * @brief Registry key of a profile: port name or host:port
+     */
+    static QString busKey(const ConnectionProfile& profile);
+
+    /**
+     * @brief Open the transport on the worker thread (no-op if open)
+     * @return true if the bus is open
+     */
+    bool open();
+
+    /**
+     * @brief Close the transport and drop all queued transactions
+     */
+    void close();
+
+    bool isOpen() const { return m_open.load(std::memory_order_acquire); }
+
+    // ========== Clients ==========
+
+    /**
+     * @brief Register a device; completions are only delivered to
+     *        attached owners
+     */
+    void attach(const void* owner);
+
+    /**
+     * @brief Unregister a device and cancel its queued requests
+     */
+    void detach(const void* owner);
+
+    // ========== Transactions (see ModbusRTU) ==========
+
+    /**
+     * @brief Read holding registers; values are valid during the handler
+     */
+    void readHoldingRegisters(uint8_t address, uint16_t startReg, uint16_t count,
+                              ReadHandler handler, const void* owner,
+                              TransactionPriority priority = TransactionPriority::Poll,
+                              int timeoutMs = 0);
+
+    void writeSingleRegister(uint8_t address, uint16_t reg, uint16_t value,
+                             WriteHandler handler, const void* owner,
+                             TransactionPriority priority = TransactionPriority::Control);
+
+    void writeMultipleRegisters(uint8_t address, uint16_t startReg, ConstRegisterSpan values,
+                                WriteHandler handler, const void* owner,
+                                TransactionPriority priority = TransactionPriority::Control);
+
+    /**
+     * @brief Error text of the completion currently being delivered
+     */
+    QString lastError() const { return m_lastError; }
+
+    /**
+     * @brief End-to-end latency (us) of one priority class
+     */
+    LatencyStats::Summary latency(TransactionPriority priority) const;
+
+    /**
+     * @brief Engine turnaround statistics (waits for the worker)
+     */
+    ModbusRTU::Diagnostics diagnostics() const;
+
+    QString key() const { return m_key; }
+    const ConnectionProfile& profile() const { return m_profile; }
+
+private slots:
+    void onDiagnosticsTimer();
+
+private:
+    explicit BusMaster(const ConnectionProfile& profile);
+
+    // Values copied out of the worker's receive buffer
+    struct RegisterBlock {
+        std::array<uint16_t, ModbusFrame::MAX_READ_REGISTERS> values;
+        uint16_t count = 0;
+    };
+
+    // Run on the worker thread, waiting for completion
+    void runOnWorker(const std::function<void()>& task) const;
+
+    using Clock = std::chrono::steady_clock;
+
+    // Log engine statistics; runs on the worker thread
+    void logDiagnostics(const LatencyStats::Summary& poll) const;
+
+    // Queue a completion back to the owner's thread; called there only
+    // if the owner is still attached
+    template <typename Completion>
+    void deliver(const void* owner, TransactionPriority priority, Clock::time_point submitted,
+                 const QString& error, Completion&& completion);
+
+    QString m_key;
+    ConnectionProfile m_profile;
+    QThread* m_thread;
+    ModbusRTU* m_modbus;                        // Lives on m_thread
+    std::unique_ptr<ITransport> m_transport;    // Created and used on m_thread
+    std::atomic<bool> m_open{false};
+    QSet<const void*> m_owners;
+    QString m_lastError;
+    std::array<LatencyStats, TRANSACTION_PRIORITY_COUNT> m_latency;
+    QTimer* m_diagnosticsTimer;
+};
+
+} // namespace rcms
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace rcms {
+
+/**
+ * @brief Control mode (MR1)
+ */
+enum class ControlMode : uint8_t {
+    Local,                  // "МУ"
+    Remote                  // "ДУ"
+};
+
+/**
+ * @brief Work mode (MR1)
+ */
+enum class WorkMode : uint8_t {
+    Phone,                  // "ТЛФ"
+    Data                    // "ДАН"
+};
+
+/**
+ * @brief Audio line type (MR1)
+ */
+enum class LineType : uint8_t {
+    TwoWire,                // "2-х"
+    FourWire                // "4-х"
+};
+
+/**
+ * @brief Monotonic timestamps for snapshots
+ *
+ * Polling only reads the steady clock; wall-clock time is derived from a
+ * process-wide anchor when something is displayed or stored.
+ */
+namespace snapshot_clock {
+
+inline int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Milliseconds since the Unix epoch for a nowNs() value
+ */
+inline int64_t toEpochMs(int64_t timeNs) {
+    static const int64_t offsetNs =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count() - nowNs();
+    return (timeNs + offsetNs) / 1000000;
+}
+
+} // namespace snapshot_clock
+
+/**
+ * @brief Decoded device status, trivially copyable
+ *
+ * Filled on every poll of every device and passed by value through the
+ * manager's signals, so it holds no strings, dates or containers: modes are
+ * enums, analog values fixed-point integers as read from the registers,
+ * active faults the raw DiagVUU words. Text is produced by the GUI
+ * (SnapshotText), only for what is shown.
+ */
+struct DeviceSnapshot {
+    int64_t timestampNs = 0;                // snapshot_clock::nowNs() of the read; 0 = never
+    uint64_t diagMask = 0;                  // DiagVUU words DV1..DV4, DV1 in the low 16 bits
+    uint32_t frequencyHz = 0;               // Current frequency
+    uint32_t operatingHours = 0;            // Total operating hours
+    int16_t voltage24dV = 0;                // Power supply voltage, 0.1 V
+    int16_t batterydV = 0;                  // Battery voltage, 0.1 V
+    int16_t temperaturedC = 0;              // Temperature, 0.1 °C
+    int16_t signalLevel = 0;                // Receiver signal level (ADC)
+    uint8_t squelchLevel = 0;               // Squelch level (0-15)
+    ControlMode controlMode = ControlMode::Local;
+    WorkMode workMode = WorkMode::Phone;
+    LineType lineType = LineType::TwoWire;
+    bool online = false;                    // Communication OK
+    bool isTransmitting = false;            // PTT active
+    bool isReceiving = false;               // Squelch open
+    bool squelchEnabled = false;            // Noise suppressor ON
+
+    double frequencyMHz() const { return frequencyHz / 1e6; }
+    double voltage24V() const { return voltage24dV / 10.0; }
+    double batteryVoltage() const { return batterydV / 10.0; }
+    double temperature() const { return temperaturedC / 10.0; }
+
+    uint16_t diagWord(int n) const { return static_cast<uint16_t>(diagMask >> (16 * n)); }
+    bool hasFaults() const { return diagMask != 0; }
+};
+
+static_assert(std::is_trivially_copyable<DeviceSnapshot>::value,
+              "DeviceSnapshot is copied on every poll and signal");
+static_assert(sizeof(DeviceSnapshot) <= 48, "DeviceSnapshot should stay within a cache line");
+
+} // namespace rcms
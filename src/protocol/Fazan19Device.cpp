@@ -1,5 +1,8 @@
 #include "Fazan19Device.h"
+#include "AlarmCatalog.h"
 #include "core/Logger.h"
+#include "core/Trace.h"
+#include <algorithm>
 #include <cmath>
 
 namespace rcms {
@@ -8,7 +11,10 @@ using namespace fazan19;
 
 Fazan19Device::Fazan19Device(uint8_t address)
     : m_address(address)
-    , m_modbus(std::make_unique<ModbusRTU>())
+    , m_modeRegister([this](ModeRegisterUpdater::ReadDone done) { readModeRegister(std::move(done)); },
+                     [this](uint16_t mr1, ModeRegisterUpdater::Done done) {
+                         writeModeRegister(mr1, std::move(done));
+                     })
 {
     m_deviceId = QString("Fazan19_%1").arg(address);
 }
@@ -18,50 +24,161 @@ Fazan19Device::~Fazan19Device() {
 }
 
 bool Fazan19Device::open(const QString& portName, int baudRate) {
+    ConnectionProfile profile;
+    profile.type = ConnectionType::COM;
+    profile.comPort = portName;
+    profile.baudRate = baudRate;
+    profile.responseTimeoutMs = timing::RESPONSE_TIMEOUT_MS;
+
+    return open(profile);
+}
+
+bool Fazan19Device::open(const ConnectionProfile& profile) {
     close();
 
-    m_port = std::make_unique<QSerialPort>();
-    m_port->setPortName(portName);
-    m_port->setBaudRate(baudRate);
-    m_port->setDataBits(QSerialPort::Data8);
-    m_port->setParity(QSerialPort::NoParity);
-    m_port->setStopBits(QSerialPort::OneStop);
-    m_port->setFlowControl(QSerialPort::NoFlowControl);
-
-    if (!m_port->open(QIODevice::ReadWrite)) {
-        Logger::error("Failed to open port {}: {}",
-                      portName.toStdString(),
-                      m_port->errorString().toStdString());
+    // Devices on the same port share one bus (and one port handle)
+    auto bus = BusMaster::acquire(profile);
+    if (!bus->open()) {
+        m_lastError = bus->lastError();
         return false;
     }
 
-    m_modbus->setPort(m_port.get());
-    m_modbus->setTimeout(timing::RESPONSE_TIMEOUT_MS);
+    m_bus = std::move(bus);
+    m_bus->attach(this);
 
-    Logger::info("Opened port {} for Fazan-19 (addr: {})",
-                 portName.toStdString(), m_address);
+    Logger::info("Attached Fazan-19 (addr: {}) to bus {}",
+                 m_address, m_bus->key().toStdString());
 
     return true;
 }
 
 void Fazan19Device::close() {
-    if (m_port && m_port->isOpen()) {
-        m_port->close();
-        Logger::info("Closed port for Fazan-19 (addr: {})", m_address);
+    if (!m_bus) {
+        return;
     }
+
+    // Other devices may keep using the bus; only drop our own requests
+    m_bus->detach(this);
+
+    Logger::info("Detached Fazan-19 (addr: {}) from bus {}",
+                 m_address, m_bus->key().toStdString());
+    m_bus.reset();
+
+    // Completions of a round or poll in flight were dropped with the detach
+    m_modeRegister.reset();
+    ++m_pollGeneration;
+    m_pollCallback = nullptr;
 }
 
 bool Fazan19Device::isOpen() const {
-    return m_port && m_port->isOpen();
+    return m_bus && m_bus->isOpen();
 }
 
-bool Fazan19Device::readStatus(DeviceStatus& status) {
-    uint16_t regs[registers::TOTAL_REGISTERS];
-    if (!readAllRegisters(regs)) {
-        status.online = false;
-        return false;
+bool Fazan19Device::checkOpen() {
+    if (isOpen()) {
+        return true;
+    }
+    m_lastError = "Port not open";
+    return false;
+}
+
+void Fazan19Device::readStatus(StatusCallback callback) {
+    readAllRegisters([this, callback = std::move(callback)](bool ok, ConstRegisterSpan regs) {
+        DeviceSnapshot status;
+        if (!ok) {
+            if (m_bus) {
+                m_lastError = m_bus->lastError();
+            }
+        } else {
+            decodeStatus(regs, status);
+        }
+
+        if (callback) {
+            callback(ok, status);
+        }
+    });
+}
+
+void Fazan19Device::poll(PollCallback callback) {
+    if (!checkOpen()) {
+        if (callback) {
+            callback(false, PollSnapshot());
+        }
+        return;
+    }
+
+    if (m_pollCallback) {
+        m_lastError = "Poll already in progress";
+        if (callback) {
+            callback(false, PollSnapshot());
+        }
+        return;
+    }
+
+    // Fast tier every cycle; slow tier when due or while promoted
+    m_pollSlow = m_telemetryPromoted || m_cyclesSinceSlow >= tiers::SLOW_EVERY_CYCLES;
+    m_pollPlan = ReadPlan::build(m_pollSlow ? (tiers::FAST | tiers::SLOW) : tiers::FAST,
+                                 tiers::MERGE_GAP_REGISTERS);
+    m_pollCallback = std::move(callback);
+    readBlock(0);
+}
+
+void Fazan19Device::readBlock(uint32_t index) {
+    if (index >= m_pollPlan.size) {
+        finishPoll(true);
+        return;
+    }
+
+    // Plan and continuation stay in members: the handler holds only this,
+    // index and generation, small enough for std::function's inline storage
+    const ReadBlock& block = m_pollPlan[index];
+    const uint32_t generation = m_pollGeneration;
+    m_bus->readHoldingRegisters(m_address, block.start, block.count,
+                                [this, index, generation](bool ok, ConstRegisterSpan values) {
+        if (generation != m_pollGeneration) {
+            return; // Poll abandoned by close()
+        }
+        if (!ok) {
+            m_lastError = m_bus->lastError();
+            finishPoll(false);
+            return;
+        }
+
+        const ReadBlock& block = m_pollPlan[index];
+        size_t n = std::min<size_t>(values.size(), m_registers.size() - block.start);
+        std::copy(values.begin(), values.begin() + n, m_registers.begin() + block.start);
+        readBlock(index + 1);
+    }, this);
+}
+
+void Fazan19Device::finishPoll(bool ok) {
+    Trace::record(TraceEvent::DevicePoll, m_address, static_cast<uint32_t>(m_pollPlan.size),
+                  static_cast<uint32_t>(m_pollPlan.registerCount()), m_pollSlow, ok);
+
+    PollSnapshot snapshot;
+    if (ok) {
+        m_cyclesSinceSlow = m_pollSlow ? 1 : m_cyclesSinceSlow + 1;
+
+        // Status and alarms (DiagVUU) decoded from the same cache
+        ConstRegisterSpan regs(m_registers.data(), m_registers.size());
+        decodeStatus(regs, snapshot.status);
+        parseErrors(regs[registers::DV1], regs[registers::DV1 + 1],
+                    regs[registers::DV1 + 2], regs[registers::DV1 + 3],
+                    snapshot);
+    } else {
+        // Slow values may be stale after an outage: full refresh next time
+        m_cyclesSinceSlow = tiers::SLOW_EVERY_CYCLES;
     }
 
+    // Cleared first: the callback may start the next poll
+    PollCallback callback = std::move(m_pollCallback);
+    m_pollCallback = nullptr;
+    if (callback) {
+        callback(ok, snapshot);
+    }
+}
+
+void Fazan19Device::decodeStatus(ConstRegisterSpan regs, DeviceSnapshot& status) {
     status.online = true;
 
     // Operating hours (from CountWork register per РЭ)
@@ -71,7 +188,7 @@ bool Fazan19Device::readStatus(DeviceStatus& status) {
 
     // Frequency
     m_currentFrequency = decodeFrequency(regs[registers::FRRS]);
-    status.frequencyMHz = m_currentFrequency;
+    status.frequencyHz = static_cast<uint32_t>(std::lround(m_currentFrequency * 1e6));
 
     // Mode register
     parseModeRegister(regs[registers::MR1], status);
@@ -79,26 +196,64 @@ bool Fazan19Device::readStatus(DeviceStatus& status) {
     // ADC values (raw, need calibration)
     // AD0-AD7 contain voltage, temperature, signal level etc.
     // TODO: Apply calibration from documentation
-    status.voltage24V = regs[registers::AD0] * 0.1;  // Placeholder
-    status.temperature = regs[registers::AD1] * 0.1; // Placeholder
-    status.signalLevel = regs[registers::AD2];
+    status.voltage24dV = static_cast<int16_t>(regs[registers::AD0]);     // Placeholder, 0.1 V
+    status.temperaturedC = static_cast<int16_t>(regs[registers::AD1]);   // Placeholder, 0.1 °C
+    status.signalLevel = static_cast<int16_t>(regs[registers::AD2]);
 
-    status.lastUpdate = QDateTime::currentDateTime();
+    // Raw fault words; alarm codes are derived in parseErrors()
+    for (int i = 0; i < 4; ++i) {
+        status.diagMask |= static_cast<uint64_t>(regs[registers::DV1 + i]) << (16 * i);
+    }
 
-    return true;
+    status.timestampNs = snapshot_clock::nowNs();
 }
 
-bool Fazan19Device::readAlarms(QVector<AlarmInfo>& alarms) {
-    std::vector<uint16_t> values;
-    if (!m_modbus->readHoldingRegisters(m_address, registers::DV1, 4, values)) {
-        return false;
+void Fazan19Device::readAlarms(AlarmsCallback callback) {
+    if (!checkOpen()) {
+        if (callback) {
+            callback(false, QVector<AlarmInfo>());
+        }
+        return;
     }
 
-    if (values.size() >= 4) {
-        parseErrors(values[0], values[1], values[2], values[3], alarms);
+    m_bus->readHoldingRegisters(m_address, registers::DV1, 4,
+                                [this, callback = std::move(callback)](bool ok,
+                                                                       ConstRegisterSpan values) {
+        QVector<AlarmInfo> alarms;
+        if (!ok) {
+            m_lastError = m_bus->lastError();
+        } else {
+            PollSnapshot active;
+            parseErrors(values[0], values[1], values[2], values[3], active);
+            for (size_t i = 0; i < active.alarmCount; ++i) {
+                alarms.append(alarm_catalog::describe(active.alarmCodes[i]));
+            }
+        }
+
+        if (callback) {
+            callback(ok, alarms);
+        }
+    }, this, TransactionPriority::Alarm);
+}
+
+void Fazan19Device::probe(int timeoutMs, ResultCallback callback) {
+    if (!checkOpen()) {
+        if (callback) {
+            callback(false);
+        }
+        return;
     }
 
-    return true;
+    // Single register, short timeout
+    m_bus->readHoldingRegisters(m_address, registers::CountWork, 1,
+                                [this, callback = std::move(callback)](bool ok, ConstRegisterSpan) {
+        if (!ok) {
+            m_lastError = m_bus->lastError();
+        }
+        if (callback) {
+            callback(ok);
+        }
+    }, this, TransactionPriority::Poll, timeoutMs);
 }
 
 bool Fazan19Device::getFrequency(double& freqMHz) {
@@ -106,97 +261,139 @@ bool Fazan19Device::getFrequency(double& freqMHz) {
     return true;
 }
 
-bool Fazan19Device::setFrequency(double freqMHz) {
+void Fazan19Device::setFrequency(double freqMHz, ResultCallback callback) {
     // Validate frequency range (118.000 - 136.975 MHz)
     if (freqMHz < frequency::MIN_MHZ || freqMHz > frequency::MAX_MHZ) {
         Logger::error("Frequency {} MHz out of range", freqMHz);
-        return false;
+        m_lastError = QString("Frequency %1 MHz out of range").arg(freqMHz);
+        if (callback) {
+            callback(false);
+        }
+        return;
     }
 
-    uint16_t frrs = encodeFrequency(freqMHz);
-
-    if (!m_modbus->writeSingleRegister(m_address, registers::FRRS, frrs)) {
-        Logger::error("Failed to set frequency: {}", m_modbus->lastError().toStdString());
-        return false;
+    if (!checkOpen()) {
+        if (callback) {
+            callback(false);
+        }
+        return;
     }
 
-    m_currentFrequency = freqMHz;
-    Logger::info("Set frequency to {} MHz (reg: 0x{:04X})", freqMHz, frrs);
+    uint16_t frrs = encodeFrequency(freqMHz);
 
-    return true;
+    m_bus->writeSingleRegister(m_address, registers::FRRS, frrs,
+                               [this, freqMHz, frrs, callback = std::move(callback)](bool ok) {
+        Trace::record(TraceEvent::FrequencySet, m_address, frrs,
+                      static_cast<uint32_t>(std::lround(freqMHz * 1000.0)), ok);
+        if (!ok) {
+            m_lastError = m_bus->lastError();
+            Logger::error("Failed to set frequency: {}", m_lastError.toStdString());
+        } else {
+            m_currentFrequency = freqMHz;
+            Logger::info("Set frequency to {} MHz (reg: 0x{:04X})", freqMHz, frrs);
+        }
+
+        if (callback) {
+            callback(ok);
+        }
+    }, this);
 }
 
-bool Fazan19Device::setSquelch(bool enabled, int level) {
-    // Read current MR1 register
-    std::vector<uint16_t> values;
-    if (!m_modbus->readHoldingRegisters(m_address, registers::MR1, 1, values)) {
-        return false;
-    }
-
-    uint16_t mr1 = values[0];
-
+void Fazan19Device::setSquelch(bool enabled, int level, ResultCallback callback) {
     // Set/clear squelch bit (bit 7)
-    if (enabled) {
-        mr1 |= modes::MR1_SQUELCH;
-    } else {
-        mr1 &= ~modes::MR1_SQUELCH;
-    }
-
-    if (!m_modbus->writeSingleRegister(m_address, registers::MR1, mr1)) {
-        Logger::error("Failed to set squelch: {}", m_modbus->lastError().toStdString());
-        return false;
-    }
-
-    m_squelchEnabled = enabled;
-    m_squelchLevel = level;
+    updateModeRegister(modes::MR1_SQUELCH, enabled,
+                       [this, enabled, level, callback = std::move(callback)](bool ok) {
+        Trace::record(TraceEvent::SquelchSet, m_address, enabled, static_cast<uint32_t>(level), ok);
+        if (!ok) {
+            Logger::error("Failed to set squelch: {}", m_lastError.toStdString());
+        } else {
+            m_squelchEnabled = enabled;
+            m_squelchLevel = level;
+            Logger::info("Set squelch: {} (level: {})", enabled ? "ON" : "OFF", level);
+        }
+
+        if (callback) {
+            callback(ok);
+        }
+    });
+}
 
-    Logger::info("Set squelch: {} (level: {})", enabled ? "ON" : "OFF", level);
+void Fazan19Device::setPTT(bool enabled, ResultCallback callback) {
+    // PTT control via MR1 register
+    updateModeRegister(modes::MR1_TX, enabled,
+                       [this, enabled, callback = std::move(callback)](bool ok) {
+        Trace::record(TraceEvent::PttSet, m_address, enabled, ok);
+        if (!ok) {
+            Logger::error("Failed to set PTT: {}", m_lastError.toStdString());
+        } else {
+            Logger::info("Set PTT: {}", enabled ? "ON" : "OFF");
+        }
+
+        if (callback) {
+            callback(ok);
+        }
+    });
+}
 
+bool Fazan19Device::runSelfTest() {
+    // TODO: Implement self-test command if supported
+    Logger::info("Running self-test for Fazan-19 (addr: {})", m_address);
     return true;
 }
 
-bool Fazan19Device::setPTT(bool enabled) {
-    // PTT control via MR1 register
-    std::vector<uint16_t> values;
-    if (!m_modbus->readHoldingRegisters(m_address, registers::MR1, 1, values)) {
-        return false;
+void Fazan19Device::readAllRegisters(BusMaster::ReadHandler handler) {
+    if (!checkOpen()) {
+        if (handler) {
+            handler(false, ConstRegisterSpan());
+        }
+        return;
     }
 
-    uint16_t mr1 = values[0];
-
-    if (enabled) {
-        mr1 |= modes::MR1_TX;
-    } else {
-        mr1 &= ~modes::MR1_TX;
-    }
+    // Values are decoded into the engine's buffer and handed out as a span
+    m_bus->readHoldingRegisters(m_address, 0, registers::TOTAL_REGISTERS,
+                                std::move(handler), this);
+}
 
-    if (!m_modbus->writeSingleRegister(m_address, registers::MR1, mr1)) {
-        Logger::error("Failed to set PTT: {}", m_modbus->lastError().toStdString());
-        return false;
+void Fazan19Device::updateModeRegister(uint16_t bits, bool set, ResultCallback callback) {
+    if (!checkOpen()) {
+        if (callback) {
+            callback(false);
+        }
+        return;
     }
 
-    Logger::info("Set PTT: {}", enabled ? "ON" : "OFF");
-
-    return true;
-}
-
-bool Fazan19Device::runSelfTest() {
-    // TODO: Implement self-test command if supported
-    Logger::info("Running self-test for Fazan-19 (addr: {})", m_address);
-    return true;
+    // One MR1 read-modify-write on the bus at a time, later ones merged
+    m_modeRegister.update(bits, set, std::move(callback));
 }
 
-bool Fazan19Device::readAllRegisters(uint16_t* registers) {
-    std::vector<uint16_t> values;
-    if (!m_modbus->readHoldingRegisters(m_address, 0, registers::TOTAL_REGISTERS, values)) {
-        return false;
+void Fazan19Device::readModeRegister(ModeRegisterUpdater::ReadDone done) {
+    if (!checkOpen()) {
+        done(false, 0);
+        return;
     }
 
-    for (size_t i = 0; i < values.size() && i < registers::TOTAL_REGISTERS; ++i) {
-        registers[i] = values[i];
+    m_bus->readHoldingRegisters(m_address, registers::MR1, 1,
+                                [this, done = std::move(done)](bool ok, ConstRegisterSpan values) {
+        if (!ok) {
+            m_lastError = m_bus->lastError();
+        }
+        done(ok, ok ? values[0] : 0);
+    }, this, TransactionPriority::Control);
+}
+
+void Fazan19Device::writeModeRegister(uint16_t mr1, ResultCallback done) {
+    if (!checkOpen()) {
+        done(false);
+        return;
     }
 
-    return true;
+    m_bus->writeSingleRegister(m_address, registers::MR1, mr1,
+                               [this, done = std::move(done)](bool written) {
+        if (!written) {
+            m_lastError = m_bus->lastError();
+        }
+        done(written);
+    }, this);
 }
 
 uint16_t Fazan19Device::encodeFrequency(double freqMHz, uint8_t kf) {
@@ -214,69 +411,48 @@ uint8_t Fazan19Device::extractKF(uint16_t frrs) {
     return static_cast<uint8_t>((frrs >> 13) & 0x03);
 }
 
-void Fazan19Device::parseModeRegister(uint16_t mr1, DeviceStatus& status) {
+void Fazan19Device::parseModeRegister(uint16_t mr1, DeviceSnapshot& status) {
     status.isTransmitting = (mr1 & modes::MR1_TX) != 0;
     status.squelchEnabled = (mr1 & modes::MR1_SQUELCH) != 0;
 
-    // Control mode
-    if (mr1 & modes::MR1_REMOTE) {
-        status.mode = "ДУ";  // Remote control
-    } else {
-        status.mode = "МУ";  // Local control
-    }
-
-    // Work mode
-    if (mr1 & modes::MR1_DATA_MODE) {
-        status.workMode = "ДАН";  // Data mode
-    } else {
-        status.workMode = "ТЛФ";  // Telephone mode
-    }
-
-    // Line type
-    if (mr1 & modes::MR1_4WIRE) {
-        status.lineType = "4-х";  // 4-wire
-    } else {
-        status.lineType = "2-х";  // 2-wire
-    }
+    status.controlMode = (mr1 & modes::MR1_REMOTE) ? ControlMode::Remote : ControlMode::Local;
+    status.workMode = (mr1 & modes::MR1_DATA_MODE) ? WorkMode::Data : WorkMode::Phone;
+    status.lineType = (mr1 & modes::MR1_4WIRE) ? LineType::FourWire : LineType::TwoWire;
 }
 
 void Fazan19Device::parseErrors(uint16_t dv1, uint16_t dv2, uint16_t dv3, uint16_t dv4,
-                                 QVector<AlarmInfo>& alarms) {
+                                 PollSnapshot& snapshot) {
     // Parse error codes from DV1-DV4 registers
     // Each bit represents a specific error condition
 
-    auto addAlarm = [&alarms](uint16_t code, const QString& message, AlarmSeverity severity) {
-        AlarmInfo info;
-        info.code = code;
-        info.message = message;
-        info.severity = severity;
-        info.timestamp = QDateTime::currentDateTime();
-        alarms.append(info);
+    // Codes only; text and severity come from the alarm catalog on raise
+    auto addAlarm = [&snapshot](uint16_t code) {
+        snapshot.addAlarm(code);
     };
 
     // DV1 - Critical errors
     if (dv1 & errors::DV1_POWER_FAIL) {
-        addAlarm(0x0101, "Отказ питания 24В", AlarmSeverity::Critical);
+        addAlarm(alarm_catalog::POWER_FAIL);
     }
     if (dv1 & errors::DV1_PLL_UNLOCK) {
-        addAlarm(0x0102, "Срыв ФАПЧ синтезатора", AlarmSeverity::Critical);
+        addAlarm(alarm_catalog::PLL_UNLOCK);
     }
     if (dv1 & errors::DV1_PA_FAIL) {
-        addAlarm(0x0103, "Отказ усилителя мощности", AlarmSeverity::Critical);
+        addAlarm(alarm_catalog::PA_FAIL);
     }
     if (dv1 & errors::DV1_VSWR_HIGH) {
-        addAlarm(0x0104, "КСВ антенны превышен", AlarmSeverity::Error);
+        addAlarm(alarm_catalog::VSWR_HIGH);
     }
     if (dv1 & errors::DV1_TEMP_HIGH) {
-        addAlarm(0x0105, "Перегрев устройства", AlarmSeverity::Warning);
+        addAlarm(alarm_catalog::TEMP_HIGH);
     }
 
     // DV2 - Secondary errors
     if (dv2 & errors::DV2_RX_FAIL) {
-        addAlarm(0x0201, "Отказ приёмника", AlarmSeverity::Error);
+        addAlarm(alarm_catalog::RX_FAIL);
     }
     if (dv2 & errors::DV2_BATTERY_LOW) {
-        addAlarm(0x0202, "Низкий заряд АКБ", AlarmSeverity::Warning);
+        addAlarm(alarm_catalog::BATTERY_LOW);
     }
 
     // Additional error parsing can be added based on documentation
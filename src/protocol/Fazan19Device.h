@@ -2,8 +2,11 @@
 
 #include "IRadioDevice.h"
 #include "ModbusRTU.h"
+#include "BusMaster.h"
 #include "Fazan19Registers.h"
-#include <QSerialPort>
+#include "ReadPlan.h"
+#include "ModeRegisterUpdater.h"
+#include <array>
 #include <memory>
 
 namespace rcms {
@@ -12,7 +15,8 @@ namespace rcms {
  * @brief Fazan-19 P5 radio device implementation
  *
  * Implements IRadioDevice interface for Fazan-19 P5 radio transmitter/receiver
- * using Modbus RTU protocol over RS-485
+ * using Modbus RTU protocol over RS-485. Several devices may share one
+ * bus: open() attaches to the BusMaster for the port.
  */
 class Fazan19Device : public IRadioDevice {
 public:
@@ -26,26 +30,34 @@ public:
     void setModbusAddress(uint8_t address) override { m_address = address; }
 
     bool open(const QString& portName, int baudRate = 9600) override;
+
+    /**
+     * @brief Attach to the bus described by a connection profile
+     */
+    bool open(const ConnectionProfile& profile);
     void close() override;
     bool isOpen() const override;
 
-    bool readStatus(DeviceStatus& status) override;
-    bool readAlarms(QVector<AlarmInfo>& alarms) override;
+    void readStatus(StatusCallback callback) override;
+    void readAlarms(AlarmsCallback callback) override;
+    void poll(PollCallback callback) override;
+    void setTelemetryPromoted(bool promoted) override { m_telemetryPromoted = promoted; }
+    void probe(int timeoutMs, ResultCallback callback) override;
 
-    bool setFrequency(double freqMHz) override;
+    void setFrequency(double freqMHz, ResultCallback callback = nullptr) override;
     bool getFrequency(double& freqMHz) override;
-    bool setSquelch(bool enabled, int level = 5) override;
-    bool setPTT(bool enabled) override;
+    void setSquelch(bool enabled, int level = 5, ResultCallback callback = nullptr) override;
+    void setPTT(bool enabled, ResultCallback callback = nullptr) override;
 
     bool runSelfTest() override;
     QString lastError() const override { return m_lastError; }
 
     /**
      * @brief Read all registers from device
-     * @param registers Output array for register values
-     * @return true on success
+     * @param handler Receives register values (valid only during the call),
+     *        invoked on the device's thread
      */
-    bool readAllRegisters(uint16_t* registers);
+    void readAllRegisters(BusMaster::ReadHandler handler);
 
     /**
      * @brief Get operating hours
@@ -65,16 +77,45 @@ private:
 
     // Error code parsing
     void parseErrors(uint16_t dv1, uint16_t dv2, uint16_t dv3, uint16_t dv4,
-                     QVector<AlarmInfo>& alarms);
+                     PollSnapshot& snapshot);
+
+    // Decode the full register block (0x00 - TOTAL_REGISTERS-1)
+    void decodeStatus(ConstRegisterSpan regs, DeviceSnapshot& status);
 
     // Parse mode registers
-    void parseModeRegister(uint16_t mr1, DeviceStatus& status);
+    void parseModeRegister(uint16_t mr1, DeviceSnapshot& status);
+
+    // Set m_lastError if not attached to an open bus
+    bool checkOpen();
+
+    // Read m_pollPlan blocks from index on into the register cache, in
+    // sequence, then finishPoll()
+    void readBlock(uint32_t index);
+    void finishPoll(bool ok);
+
+    // Set or clear bits in MR1 (serialized read-modify-write)
+    void updateModeRegister(uint16_t bits, bool set, ResultCallback callback);
+    void readModeRegister(ModeRegisterUpdater::ReadDone done);
+    void writeModeRegister(uint16_t mr1, ResultCallback done);
 
     uint8_t m_address;
     QString m_deviceId;
     QString m_lastError;
-    std::unique_ptr<QSerialPort> m_port;
-    std::unique_ptr<ModbusRTU> m_modbus;
+    std::shared_ptr<BusMaster> m_bus;
+
+    // Register cache for tiered polling; slow tier values persist between reads
+    std::array<uint16_t, fazan19::registers::TOTAL_REGISTERS> m_registers{};
+    int m_cyclesSinceSlow = fazan19::tiers::SLOW_EVERY_CYCLES;
+    bool m_telemetryPromoted = false;
+
+    // Poll in flight; close() abandons it by bumping the generation
+    ReadPlan m_pollPlan;
+    PollCallback m_pollCallback;
+    uint32_t m_pollGeneration = 0;
+    bool m_pollSlow = false;
+
+    // MR1 changes, one read-modify-write on the bus at a time
+    ModeRegisterUpdater m_modeRegister;
 
     // Cached state
     double m_currentFrequency = 0.0;
@@ -55,6 +55,39 @@ constexpr uint16_t TOTAL_REGISTERS = 0x1C; // 28 registers
 
 } // namespace registers
 
+/**
+ * @brief Register polling tiers
+ *
+ * Registers are grouped by how fast they change. The fast tier (mode,
+ * frequency, DiagVUU) is read every poll cycle; the slow tier (operating
+ * hours, power setting, ADC channels) every SLOW_EVERY_CYCLES cycles, or
+ * every cycle while promoted (device selected in the GUI).
+ * Masks have one bit per register address.
+ */
+namespace tiers {
+using RegisterMask = uint32_t;
+static_assert(registers::TOTAL_REGISTERS <= 32, "RegisterMask too narrow");
+
+constexpr RegisterMask bit(uint16_t reg) { return RegisterMask(1) << reg; }
+
+constexpr RegisterMask range(uint16_t start, uint16_t count) {
+    return count == 0 ? 0 : (bit(start) | range(static_cast<uint16_t>(start + 1),
+                                                 static_cast<uint16_t>(count - 1)));
+}
+
+constexpr RegisterMask FAST = bit(registers::ModTR) | bit(registers::FrRS) |
+                              range(registers::DiagVUU, 4);
+
+constexpr RegisterMask SLOW = bit(registers::CountWork) | bit(registers::PKm) |
+                              range(registers::AD0, 8);
+
+constexpr int SLOW_EVERY_CYCLES = 10;           // Slow tier refresh, in poll cycles
+
+// Unwanted registers worth reading to save a request: a separate request
+// costs ~20 characters of framing and inter-frame gaps, a register 2
+constexpr uint16_t MERGE_GAP_REGISTERS = 10;
+}
+
 /**
  * @brief ModTR register bit definitions (per РЭ)
  *
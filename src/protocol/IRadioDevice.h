@@ -4,12 +4,14 @@
 #include <QVector>
 #include <QDateTime>
 #include <cstdint>
+#include <functional>
+#include "DeviceSnapshot.h"
 
 namespace rcms {
 /**
  * @brief Alarm severity levels
  */
-enum class AlarmSeverity {
+enum class AlarmSeverity : uint8_t {
     Info,
     Warning,
     Error,
@@ -17,28 +19,6 @@ enum class AlarmSeverity {
 };
 
 
-/**
- * @brief Device status structure
- */
-struct DeviceStatus {
-    bool online = false;                    // Communication OK
-    double frequencyMHz = 0.0;              // Current frequency in MHz
-    bool isTransmitting = false;            // PTT active
-    bool isReceiving = false;               // Squelch open
-    bool squelchEnabled = false;            // Noise suppressor ON
-    int squelchLevel = 0;                   // Squelch level (0-15)
-    int signalLevel = 0;                    // Receiver signal level (ADC)
-    double voltage24V = 0.0;                // Power supply voltage
-    double batteryVoltage = 0.0;            // Battery voltage
-    double temperature = 0.0;               // Temperature in Celsius
-    uint32_t operatingHours = 0;            // Total operating hours
-    QString mode;                           // "МУ" (local) or "ДУ" (remote)
-    QString workMode;                       // "ТЛФ" (phone) or "ДАН" (data)
-    QString lineType;                       // "2-х" or "4-х" wire
-    QDateTime lastUpdate;                   // Last successful read time
-    QVector<uint16_t> errorCodes;           // Active error codes
-};
-
 /**
  * @brief Alarm information structure
  */
@@ -52,14 +32,43 @@ struct AlarmInfo {
     bool acknowledged = false;
 };
 
+/**
+ * @brief Status and active alarm codes decoded from one poll transaction
+ *
+ * Trivially copyable like DeviceSnapshot; alarm text and severity are
+ * looked up in the catalog only when an alarm is raised.
+ */
+struct PollSnapshot {
+    static constexpr size_t MAX_ALARMS = 16;
+
+    DeviceSnapshot status;
+    uint16_t alarmCodes[MAX_ALARMS] = {};
+    size_t alarmCount = 0;
+
+    void addAlarm(uint16_t code) {
+        if (alarmCount < MAX_ALARMS) {
+            alarmCodes[alarmCount++] = code;
+        }
+    }
+};
+
 /**
  * @brief Abstract interface for radio devices
  *
  * All radio device drivers must implement this interface.
  * This allows adding support for new devices without changing core logic.
+ *
+ * Bus operations (status, alarms, control) are asynchronous: they return
+ * immediately and report the outcome through a callback invoked from the
+ * event loop once the transaction completes.
  */
 class IRadioDevice {
 public:
+    using StatusCallback = std::function<void(bool ok, const DeviceSnapshot& status)>;
+    using AlarmsCallback = std::function<void(bool ok, const QVector<AlarmInfo>& alarms)>;
+    using ResultCallback = std::function<void(bool ok)>;
+    using PollCallback = std::function<void(bool ok, const PollSnapshot& snapshot)>;
+
     virtual ~IRadioDevice() = default;
 
     // ========== Identification ==========
@@ -113,31 +122,57 @@ public:
 
     /**
      * @brief Read device status
-     * @param status Output status structure
-     * @return true if successful
+     * @param callback Receives success flag and decoded status
      */
-    virtual bool readStatus(DeviceStatus& status) = 0;
+    virtual void readStatus(StatusCallback callback) = 0;
 
     /**
      * @brief Read active alarms
-     * @param alarms Output vector of alarms
-     * @return true if successful
+     * @param callback Receives success flag and active alarms
      */
-    virtual bool readAlarms(QVector<AlarmInfo>& alarms) = 0;
+    virtual void readAlarms(AlarmsCallback callback) = 0;
+
+    /**
+     * @brief Read status and active alarms in one bus transaction
+     *
+     * Preferred for periodic polling: a device whose status block already
+     * contains its diagnostic registers should decode alarms from the same
+     * response instead of issuing a second request.
+     * @param callback Receives success flag and the decoded snapshot
+     */
+    virtual void poll(PollCallback callback) = 0;
+
+    /**
+     * @brief Refresh slowly changing telemetry on every poll
+     *
+     * Set while the operator is looking at the device; otherwise drivers
+     * may read slow registers only every few cycles to save bus time.
+     */
+    virtual void setTelemetryPromoted(bool promoted) = 0;
+
+    /**
+     * @brief Cheap reachability check (single short request)
+     *
+     * Used to bring unreachable devices back without paying a full
+     * status poll and response timeout on every attempt.
+     * @param timeoutMs Response timeout for the probe
+     * @param callback Receives true if the device answered
+     */
+    virtual void probe(int timeoutMs, ResultCallback callback) = 0;
 
     // ========== Control ==========
 
     /**
      * @brief Set operating frequency
      * @param freqMHz Frequency in MHz (118.0 - 136.975)
-     * @return true if successful
+     * @param callback Optional completion callback
      */
-    virtual bool setFrequency(double freqMHz) = 0;
+    virtual void setFrequency(double freqMHz, ResultCallback callback = nullptr) = 0;
 
     /**
-     * @brief Get current frequency
+     * @brief Get current frequency (last value read or written)
      * @param freqMHz Output frequency in MHz
-     * @return true if successful
+     * @return true if a frequency is known
      */
     virtual bool getFrequency(double& freqMHz) = 0;
 
@@ -145,16 +180,16 @@ public:
      * @brief Set noise suppressor (squelch)
      * @param enabled Enable/disable
      * @param level Squelch level (0-15)
-     * @return true if successful
+     * @param callback Optional completion callback
      */
-    virtual bool setSquelch(bool enabled, int level = 5) = 0;
+    virtual void setSquelch(bool enabled, int level = 5, ResultCallback callback = nullptr) = 0;
 
     /**
      * @brief Set PTT (Push-To-Talk)
      * @param enabled Enable transmission
-     * @return true if successful
+     * @param callback Optional completion callback
      */
-    virtual bool setPTT(bool enabled) = 0;
+    virtual void setPTT(bool enabled, ResultCallback callback = nullptr) = 0;
 
     // ========== Diagnostics ==========
 
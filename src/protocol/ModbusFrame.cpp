@@ -0,0 +1,197 @@
+#include "ModbusFrame.h"
+#include "comm/CRC16.h"
+
+namespace rcms {
+
+// ========== ModbusFrame ==========
+
+ModbusFrame ModbusFrame::readHoldingRegisters(uint8_t address, uint16_t startReg, uint16_t count) {
+    // [addr][func][startHi][startLo][countHi][countLo][crcLo][crcHi]
+    ModbusFrame frame;
+    frame.appendByte(address);
+    frame.appendByte(FUNC_READ_HOLDING);
+    frame.appendWord(startReg);
+    frame.appendWord(count);
+    frame.appendCrc();
+    return frame;
+}
+
+ModbusFrame ModbusFrame::writeSingleRegister(uint8_t address, uint16_t reg, uint16_t value) {
+    // [addr][func][regHi][regLo][valHi][valLo][crcLo][crcHi]
+    ModbusFrame frame;
+    frame.appendByte(address);
+    frame.appendByte(FUNC_WRITE_SINGLE);
+    frame.appendWord(reg);
+    frame.appendWord(value);
+    frame.appendCrc();
+    return frame;
+}
+
+ModbusFrame ModbusFrame::writeMultipleRegisters(uint8_t address, uint16_t startReg,
+                                                ConstRegisterSpan values) {
+    const uint16_t count = static_cast<uint16_t>(
+        values.size() < MAX_WRITE_REGISTERS ? values.size() : MAX_WRITE_REGISTERS);
+
+    // [addr][func][startHi][startLo][countHi][countLo][byteCount][data...][crcLo][crcHi]
+    ModbusFrame frame;
+    frame.appendByte(address);
+    frame.appendByte(FUNC_WRITE_MULTIPLE);
+    frame.appendWord(startReg);
+    frame.appendWord(count);
+    frame.appendByte(static_cast<uint8_t>(count * 2));
+    for (uint16_t i = 0; i < count; ++i) {
+        frame.appendWord(values[i]);
+    }
+    frame.appendCrc();
+    return frame;
+}
+
+void ModbusFrame::grow(size_t count) {
+    m_size = (count > available()) ? MAX_ADU_SIZE : m_size + count;
+}
+
+bool ModbusFrame::appendByte(uint8_t value) {
+    if (m_size >= MAX_ADU_SIZE) {
+        return false;
+    }
+    m_data[m_size++] = value;
+    return true;
+}
+
+bool ModbusFrame::appendWord(uint16_t value) {
+    if (available() < 2) {
+        return false;
+    }
+    m_data[m_size++] = static_cast<uint8_t>(value >> 8);
+    m_data[m_size++] = static_cast<uint8_t>(value & 0xFF);
+    return true;
+}
+
+bool ModbusFrame::appendBytes(ByteView bytes) {
+    if (available() < bytes.size()) {
+        return false;
+    }
+    for (uint8_t b : bytes) {
+        m_data[m_size++] = b;
+    }
+    return true;
+}
+
+bool ModbusFrame::appendCrc() {
+    if (available() < 2) {
+        return false;
+    }
+    uint16_t crc = CRC16::calculate(m_data.data(), m_size);
+
+    // Little Endian order
+    m_data[m_size++] = static_cast<uint8_t>(crc & 0xFF);
+    m_data[m_size++] = static_cast<uint8_t>((crc >> 8) & 0xFF);
+    return true;
+}
+
+bool ModbusFrame::crcValid() const {
+    return CRC16::verify(m_data.data(), m_size);
+}
+
+// ========== ModbusResponse ==========
+
+ModbusResponse::Status ModbusResponse::checkHeader(ByteView frame, uint8_t address,
+                                                   uint8_t function) {
+    if (frame.size() >= EXCEPTION_LENGTH && (frame[1] & ModbusFrame::EXCEPTION_FLAG)) {
+        if (!CRC16::verify(frame.data(), EXCEPTION_LENGTH)) {
+            return Status::CrcError;
+        }
+        if (frame[0] != address) {
+            return Status::AddressMismatch;
+        }
+        if ((frame[1] & ~ModbusFrame::EXCEPTION_FLAG) != function) {
+            return Status::FunctionMismatch;
+        }
+        return Status::Exception;
+    }
+
+    if (frame.size() < EXCEPTION_LENGTH) {
+        return Status::TooShort;
+    }
+    if (frame[0] != address) {
+        return Status::AddressMismatch;
+    }
+    if (frame[1] != function) {
+        return Status::FunctionMismatch;
+    }
+    return Status::Ok;
+}
+
+ModbusResponse::Status ModbusResponse::parseReadHolding(ByteView frame, uint8_t address,
+                                                        uint16_t count, RegisterSpan values) {
+    // [addr][func][byteCount][data...][crcLo][crcHi]
+    const size_t expectedLen = readHoldingLength(count);
+
+    if (frame.size() < expectedLen && !(frame.size() >= 2 && (frame[1] & ModbusFrame::EXCEPTION_FLAG))) {
+        return Status::TooShort;
+    }
+
+    Status status = checkHeader(frame, address, ModbusFrame::FUNC_READ_HOLDING);
+    if (status != Status::Ok) {
+        return status;
+    }
+
+    if (!CRC16::verify(frame.data(), expectedLen)) {
+        return Status::CrcError;
+    }
+
+    if (frame[2] != count * 2) {
+        return Status::Malformed;
+    }
+
+    if (values.size() < count) {
+        return Status::BufferTooSmall;
+    }
+
+    const uint8_t* payload = frame.data() + 3;
+    for (uint16_t i = 0; i < count; ++i) {
+        values[i] = static_cast<uint16_t>((payload[i * 2] << 8) | payload[i * 2 + 1]);
+    }
+
+    return Status::Ok;
+}
+
+ModbusResponse::Status ModbusResponse::parseWrite(ByteView frame, uint8_t address, uint8_t function) {
+    if (frame.size() < WRITE_ECHO_LENGTH && !(frame.size() >= 2 && (frame[1] & ModbusFrame::EXCEPTION_FLAG))) {
+        return Status::TooShort;
+    }
+
+    Status status = checkHeader(frame, address, function);
+    if (status != Status::Ok) {
+        return status;
+    }
+
+    if (!CRC16::verify(frame.data(), WRITE_ECHO_LENGTH)) {
+        return Status::CrcError;
+    }
+
+    return Status::Ok;
+}
+
+uint8_t ModbusResponse::exceptionCode(ByteView frame) {
+    if (frame.size() >= 3 && (frame[1] & ModbusFrame::EXCEPTION_FLAG)) {
+        return frame[2];
+    }
+    return 0;
+}
+
+const char* ModbusResponse::statusText(Status status) {
+    switch (status) {
+        case Status::Ok: return "OK";
+        case Status::TooShort: return "Incomplete response";
+        case Status::CrcError: return "CRC error in response";
+        case Status::Exception: return "Modbus exception response";
+        case Status::AddressMismatch: return "Response from unexpected address";
+        case Status::FunctionMismatch: return "Unexpected function code in response";
+        case Status::Malformed: return "Malformed response";
+        case Status::BufferTooSmall: return "Output buffer too small";
+    }
+    return "Unknown";
+}
+
+} // namespace rcms
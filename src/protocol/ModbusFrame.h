@@ -0,0 +1,218 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace rcms {
+
+/**
+ * @brief Non-owning view over a contiguous sequence (C++17 stand-in for std::span)
+ */
+template <typename T>
+class Span {
+public:
+    constexpr Span() = default;
+    constexpr Span(T* data, size_t size) : m_data(data), m_size(size) {}
+
+    template <size_t N>
+    constexpr Span(T (&array)[N]) : m_data(array), m_size(N) {}
+
+    template <typename U, size_t N,
+              typename = std::enable_if_t<std::is_convertible<U (*)[], T (*)[]>::value>>
+    constexpr Span(std::array<U, N>& array) : m_data(array.data()), m_size(N) {}
+
+    template <typename U, size_t N,
+              typename = std::enable_if_t<std::is_convertible<const U (*)[], T (*)[]>::value>>
+    constexpr Span(const std::array<U, N>& array) : m_data(array.data()), m_size(N) {}
+
+    // Mutable span converts to const span
+    template <typename U,
+              typename = std::enable_if_t<std::is_convertible<U (*)[], T (*)[]>::value>>
+    constexpr Span(const Span<U>& other) : m_data(other.data()), m_size(other.size()) {}
+
+    constexpr T* data() const { return m_data; }
+    constexpr size_t size() const { return m_size; }
+    constexpr bool empty() const { return m_size == 0; }
+
+    constexpr T& operator[](size_t index) const { return m_data[index]; }
+
+    constexpr T* begin() const { return m_data; }
+    constexpr T* end() const { return m_data + m_size; }
+
+    /**
+     * @brief Sub-view [offset, offset + count), clamped to the view
+     */
+    constexpr Span subspan(size_t offset, size_t count = SIZE_MAX) const {
+        if (offset > m_size) {
+            offset = m_size;
+        }
+        if (count > m_size - offset) {
+            count = m_size - offset;
+        }
+        return Span(m_data + offset, count);
+    }
+
+private:
+    T* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+using ByteView = Span<const uint8_t>;
+using RegisterSpan = Span<uint16_t>;
+using ConstRegisterSpan = Span<const uint16_t>;
+
+/**
+ * @brief Fixed-capacity Modbus RTU frame (ADU)
+ *
+ * Stack-allocated storage sized for the largest RTU ADU (256 bytes),
+ * so building and receiving frames never touches the heap.
+ */
+class ModbusFrame {
+public:
+    // RTU ADU limit: address(1) + PDU(253) + CRC(2)
+    static constexpr size_t MAX_ADU_SIZE = 256;
+
+    // Register count limits per Modbus specification
+    static constexpr uint16_t MAX_READ_REGISTERS = 125;
+    static constexpr uint16_t MAX_WRITE_REGISTERS = 123;
+
+    // Modbus function codes
+    static constexpr uint8_t FUNC_READ_HOLDING = 0x03;
+    static constexpr uint8_t FUNC_WRITE_SINGLE = 0x06;
+    static constexpr uint8_t FUNC_WRITE_MULTIPLE = 0x10;
+    static constexpr uint8_t FUNC_DEVICE_ID = 0x11;
+    static constexpr uint8_t EXCEPTION_FLAG = 0x80;
+
+    ModbusFrame() = default;
+
+    // ========== Request builders ==========
+
+    /**
+     * @brief Read holding registers request (0x03)
+     */
+    static ModbusFrame readHoldingRegisters(uint8_t address, uint16_t startReg, uint16_t count);
+
+    /**
+     * @brief Write single register request (0x06)
+     */
+    static ModbusFrame writeSingleRegister(uint8_t address, uint16_t reg, uint16_t value);
+
+    /**
+     * @brief Write multiple registers request (0x10)
+     *
+     * Values beyond MAX_WRITE_REGISTERS are not encoded; check
+     * values.size() before calling.
+     */
+    static ModbusFrame writeMultipleRegisters(uint8_t address, uint16_t startReg,
+                                              ConstRegisterSpan values);
+
+    // ========== Raw access ==========
+
+    const uint8_t* data() const { return m_data.data(); }
+    uint8_t* data() { return m_data.data(); }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    ByteView view() const { return ByteView(m_data.data(), m_size); }
+
+    /**
+     * @brief Free space at the end of the buffer (for receiving)
+     */
+    size_t available() const { return MAX_ADU_SIZE - m_size; }
+
+    /**
+     * @brief Write position for receiving bytes directly into the frame
+     */
+    uint8_t* tail() { return m_data.data() + m_size; }
+
+    /**
+     * @brief Commit bytes written at tail()
+     */
+    void grow(size_t count);
+
+    void clear() { m_size = 0; }
+
+    bool appendByte(uint8_t value);
+    bool appendWord(uint16_t value);    // Big Endian (Modbus data order)
+    bool appendBytes(ByteView bytes);
+
+    /**
+     * @brief Append CRC-16 (Little Endian) over the current content
+     */
+    bool appendCrc();
+
+    /**
+     * @brief Verify trailing CRC-16
+     */
+    bool crcValid() const;
+
+    uint8_t operator[](size_t index) const { return m_data[index]; }
+
+private:
+    std::array<uint8_t, MAX_ADU_SIZE> m_data;
+    size_t m_size = 0;
+};
+
+/**
+ * @brief Modbus RTU response parsing
+ *
+ * Parses a received frame in place and decodes register data straight into
+ * caller-provided storage.
+ */
+class ModbusResponse {
+public:
+    enum class Status {
+        Ok,
+        TooShort,           // Fewer bytes than the response requires
+        CrcError,
+        Exception,          // Device returned an exception response (0x80 | fc)
+        AddressMismatch,
+        FunctionMismatch,
+        Malformed,          // Byte count / echo does not match the request
+        BufferTooSmall      // Output span cannot hold the registers
+    };
+
+    /**
+     * @brief Expected length of a read holding registers response
+     */
+    static constexpr size_t readHoldingLength(uint16_t count) {
+        return 3 + static_cast<size_t>(count) * 2 + 2;
+    }
+
+    // Exception response: [addr][0x80|fc][code][crcLo][crcHi]
+    static constexpr size_t EXCEPTION_LENGTH = 5;
+
+    // Write single/multiple response: [addr][fc][2 bytes][2 bytes][crcLo][crcHi]
+    static constexpr size_t WRITE_ECHO_LENGTH = 8;
+
+    /**
+     * @brief Parse read holding registers (0x03) response
+     * @param frame Received frame
+     * @param address Expected slave address
+     * @param count Requested register count
+     * @param values Output; must hold at least count registers
+     */
+    static Status parseReadHolding(ByteView frame, uint8_t address, uint16_t count,
+                                   RegisterSpan values);
+
+    /**
+     * @brief Parse write single (0x06) / write multiple (0x10) response
+     */
+    static Status parseWrite(ByteView frame, uint8_t address, uint8_t function);
+
+    /**
+     * @brief Exception code of an exception response (0 if not an exception)
+     */
+    static uint8_t exceptionCode(ByteView frame);
+
+    /**
+     * @brief Human-readable status description
+     */
+    static const char* statusText(Status status);
+
+private:
+    static Status checkHeader(ByteView frame, uint8_t address, uint8_t function);
+};
+
+} // namespace rcms
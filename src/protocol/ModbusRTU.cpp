@@ -1,202 +1,415 @@
 #include "ModbusRTU.h"
-#include "comm/CRC16.h"
+#include <algorithm>
 #include "core/Logger.h"
-#include <QThread>
+#include "core/Trace.h"
 
 namespace rcms {
 
-ModbusRTU::ModbusRTU() = default;
+namespace {
+// Trace arguments taken from a request or response frame
+uint32_t frameByte(const ModbusFrame& frame, size_t index) {
+    return index < frame.size() ? frame[index] : 0;
+}
+
+uint32_t frameRegister(const ModbusFrame& frame) {
+    return frame.size() >= 4 ? (static_cast<uint32_t>(frame[2]) << 8) | frame[3] : 0;
+}
+}
+
+ModbusRTU::ModbusRTU(QObject* parent)
+    : QObject(parent)
+    , m_responseTimer(new QTimer(this))
+    , m_silenceTimer(new QTimer(this))
+    , m_guardTimer(new QTimer(this))
+{
+    m_responseTimer->setSingleShot(true);
+    connect(m_responseTimer, &QTimer::timeout, this, &ModbusRTU::onResponseTimeout);
+
+    // End-of-frame detection: restarted on every received chunk
+    m_silenceTimer->setSingleShot(true);
+    m_silenceTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_silenceTimer, &QTimer::timeout, this, &ModbusRTU::onFrameSilence);
+
+    // Inter-frame guard: next request waits for t3.5 of line silence
+    m_guardTimer->setSingleShot(true);
+    m_guardTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_guardTimer, &QTimer::timeout, this, &ModbusRTU::startNext);
+
+    m_clock.start();
+}
+
 ModbusRTU::~ModbusRTU() = default;
 
-bool ModbusRTU::readHoldingRegisters(uint8_t address, uint16_t startReg,
-                                      uint16_t count, std::vector<uint16_t>& values) {
-    if (!m_port || !m_port->isOpen()) {
-        m_lastError = "Port not open";
-        return false;
+void ModbusRTU::setDevice(QIODevice* device) {
+    if (m_device == device) {
+        return;
     }
 
-    // Build request: [addr][func][startHi][startLo][countHi][countLo][crcLo][crcHi]
-    std::vector<uint8_t> request = {
-        address,
-        FUNC_READ_HOLDING,
-        static_cast<uint8_t>(startReg >> 8),
-        static_cast<uint8_t>(startReg & 0xFF),
-        static_cast<uint8_t>(count >> 8),
-        static_cast<uint8_t>(count & 0xFF)
-    };
-    CRC16::append(request);
+    cancelAll();
 
-    if (!sendRequest(request)) {
-        return false;
+    if (m_device) {
+        disconnect(m_device, nullptr, this, nullptr);
     }
 
-    // Expected response: [addr][func][byteCount][data...][crcLo][crcHi]
-    int expectedLen = 3 + count * 2 + 2;
-    std::vector<uint8_t> response;
-    if (!readResponse(response, expectedLen)) {
-        return false;
+    m_device = device;
+
+    if (m_device) {
+        connect(m_device, &QIODevice::readyRead, this, &ModbusRTU::onReadyRead);
     }
+}
 
-    // Verify CRC
-    if (!CRC16::verify(response.data(), response.size())) {
-        m_lastError = "CRC error in response";
-        Logger::error("Modbus CRC error");
-        return false;
+void ModbusRTU::transact(const ModbusFrame& request, FrameHandler handler,
+                         const void* owner, TransactionPriority priority, int timeoutMs) {
+    if (!m_device || !m_device->isOpen()) {
+        m_lastError = "Port not open";
+        if (handler) {
+            m_assembler.reset();
+            handler(Result::NotOpen, m_assembler.frame());
+        }
+        return;
     }
 
-    // Check for error response
-    if (response[1] & 0x80) {
-        m_lastError = QString("Modbus error: 0x%1").arg(response[2], 2, 16, QChar('0'));
-        Logger::error("Modbus error response: 0x{:02X}", response[2]);
-        return false;
+    Transaction t;
+    t.request = request;
+    t.handler = std::move(handler);
+    t.owner = owner;
+    t.timeoutMs = timeoutMs;
+    m_queue.push(std::move(t), priority);
+
+    if (m_state == State::Idle && !m_guardTimer->isActive()) {
+        scheduleNext();
     }
+}
 
-    // Extract register values
-    values.clear();
-    uint8_t byteCount = response[2];
-    for (int i = 0; i < byteCount / 2; ++i) {
-        uint16_t val = (static_cast<uint16_t>(response[3 + i * 2]) << 8) |
-                        response[4 + i * 2];
-        values.push_back(val);
+void ModbusRTU::readHoldingRegisters(uint8_t address, uint16_t startReg,
+                                     uint16_t count, ReadHandler handler,
+                                     const void* owner, TransactionPriority priority,
+                                     int timeoutMs) {
+    if (count == 0 || count > ModbusFrame::MAX_READ_REGISTERS) {
+        m_lastError = QString("Invalid register count: %1").arg(count);
+        if (handler) {
+            handler(false, ConstRegisterSpan());
+        }
+        return;
     }
 
-    return true;
+    // Expected response: [addr][func][byteCount][data...][crcLo][crcHi]
+    transact(ModbusFrame::readHoldingRegisters(address, startReg, count),
+             [this, address, count, handler = std::move(handler)](Result result,
+                                                                  const ModbusFrame& response) {
+        bool ok = result == Result::Ok &&
+                  checkStatus(ModbusResponse::parseReadHolding(response.view(), address, count,
+                                                               m_registers),
+                              response);
+        if (handler) {
+            handler(ok, ok ? ConstRegisterSpan(m_registers.data(), count) : ConstRegisterSpan());
+        }
+    }, owner, priority, timeoutMs);
 }
 
-bool ModbusRTU::writeSingleRegister(uint8_t address, uint16_t reg, uint16_t value) {
-    if (!m_port || !m_port->isOpen()) {
-        m_lastError = "Port not open";
-        return false;
+void ModbusRTU::writeSingleRegister(uint8_t address, uint16_t reg, uint16_t value,
+                                    WriteHandler handler, const void* owner,
+                                    TransactionPriority priority) {
+    // Echo response expected
+    transact(ModbusFrame::writeSingleRegister(address, reg, value),
+             [this, address, handler = std::move(handler)](Result result,
+                                                           const ModbusFrame& response) {
+        bool ok = result == Result::Ok &&
+                  checkStatus(ModbusResponse::parseWrite(response.view(), address,
+                                                         ModbusFrame::FUNC_WRITE_SINGLE),
+                              response);
+        if (handler) {
+            handler(ok);
+        }
+    }, owner, priority);
+}
+
+void ModbusRTU::writeMultipleRegisters(uint8_t address, uint16_t startReg,
+                                       ConstRegisterSpan values, WriteHandler handler,
+                                       const void* owner, TransactionPriority priority) {
+    if (values.empty() || values.size() > ModbusFrame::MAX_WRITE_REGISTERS) {
+        m_lastError = QString("Invalid register count: %1").arg(values.size());
+        if (handler) {
+            handler(false);
+        }
+        return;
     }
 
-    // Build request: [addr][func][regHi][regLo][valHi][valLo][crcLo][crcHi]
-    std::vector<uint8_t> request = {
-        address,
-        FUNC_WRITE_SINGLE,
-        static_cast<uint8_t>(reg >> 8),
-        static_cast<uint8_t>(reg & 0xFF),
-        static_cast<uint8_t>(value >> 8),
-        static_cast<uint8_t>(value & 0xFF)
-    };
-    CRC16::append(request);
+    // Response: [addr][func][startHi][startLo][countHi][countLo][crcLo][crcHi]
+    transact(ModbusFrame::writeMultipleRegisters(address, startReg, values),
+             [this, address, handler = std::move(handler)](Result result,
+                                                           const ModbusFrame& response) {
+        bool ok = result == Result::Ok &&
+                  checkStatus(ModbusResponse::parseWrite(response.view(), address,
+                                                         ModbusFrame::FUNC_WRITE_MULTIPLE),
+                              response);
+        if (handler) {
+            handler(ok);
+        }
+    }, owner, priority);
+}
 
-    if (!sendRequest(request)) {
-        return false;
-    }
+void ModbusRTU::cancelAll() {
+    m_queue.clear();
+    m_responseTimer->stop();
+    m_silenceTimer->stop();
+    m_guardTimer->stop();
+    m_current = Transaction();
+    m_state = State::Idle;
+}
 
-    // Echo response expected
-    std::vector<uint8_t> response;
-    if (!readResponse(response, 8)) {
-        return false;
+void ModbusRTU::cancel(const void* owner) {
+    if (!owner) {
+        return;
     }
 
-    if (!CRC16::verify(response.data(), response.size())) {
-        m_lastError = "CRC error in response";
-        return false;
+    m_queue.removeIf([owner](const Transaction& t) { return t.owner == owner; });
+
+    if (m_current.owner == owner) {
+        m_current.handler = nullptr;
     }
+}
 
-    if (response[1] & 0x80) {
-        m_lastError = QString("Modbus error: 0x%1").arg(response[2], 2, 16, QChar('0'));
-        return false;
+void ModbusRTU::scheduleNext() {
+    if (m_state != State::Idle || m_queue.empty()) {
+        return;
     }
 
-    return true;
+    // Always via the event loop: a completion handler may still be
+    // looking at the previous response when it queues the next request
+    int64_t waitNs = m_lineIdleAtNs - m_clock.nsecsElapsed();
+    m_guardTimer->start(waitNs > 0 ? nsToTimerMs(waitNs) : 0);
 }
 
-bool ModbusRTU::writeMultipleRegisters(uint8_t address, uint16_t startReg,
-                                        const std::vector<uint16_t>& values) {
-    if (!m_port || !m_port->isOpen()) {
-        m_lastError = "Port not open";
-        return false;
+int ModbusRTU::nsToTimerMs(int64_t ns) {
+    return static_cast<int>((ns + 999999) / 1000000);
+}
+
+void ModbusRTU::startNext() {
+    if (m_state != State::Idle || m_queue.empty()) {
+        return;
     }
 
-    uint16_t count = static_cast<uint16_t>(values.size());
-    uint8_t byteCount = count * 2;
+    // Timer fired early (ms granularity): wait for the remainder
+    if (m_clock.nsecsElapsed() < m_lineIdleAtNs) {
+        scheduleNext();
+        return;
+    }
 
-    // Build request
-    std::vector<uint8_t> request = {
-        address,
-        FUNC_WRITE_MULTIPLE,
-        static_cast<uint8_t>(startReg >> 8),
-        static_cast<uint8_t>(startReg & 0xFF),
-        static_cast<uint8_t>(count >> 8),
-        static_cast<uint8_t>(count & 0xFF),
-        byteCount
-    };
+    m_current = m_queue.pop();
+    m_assembler.reset();
 
-    for (uint16_t val : values) {
-        request.push_back(static_cast<uint8_t>(val >> 8));
-        request.push_back(static_cast<uint8_t>(val & 0xFF));
+    if (!m_device || !m_device->isOpen()) {
+        m_lastError = "Port not open";
+        finish(Result::NotOpen);
+        return;
     }
-    CRC16::append(request);
 
-    if (!sendRequest(request)) {
-        return false;
+    // Drop stale bytes left over from a previous (late) response
+    if (m_device->bytesAvailable() > 0) {
+        m_device->skip(m_device->bytesAvailable());
     }
 
-    // Response: [addr][func][startHi][startLo][countHi][countLo][crcLo][crcHi]
-    std::vector<uint8_t> response;
-    if (!readResponse(response, 8)) {
-        return false;
+    qint64 written = m_device->write(reinterpret_cast<const char*>(m_current.request.data()),
+                                     static_cast<qint64>(m_current.request.size()));
+
+    if (written != static_cast<qint64>(m_current.request.size())) {
+        m_lastError = "Failed to write request";
+        finish(Result::WriteError);
+        return;
     }
 
-    if (!CRC16::verify(response.data(), response.size())) {
-        m_lastError = "CRC error in response";
-        return false;
+    // Response can't start before the request has left the wire
+    const int64_t txNs = m_timing.transmitNs(m_current.request.size());
+    m_sentAtNs = m_clock.nsecsElapsed();
+    m_txEndNs = m_sentAtNs + txNs;
+    m_firstByteNs = -1;
+    m_lineIdleAtNs = m_txEndNs + m_timing.t35Ns();
+
+    Trace::record(TraceEvent::ModbusRequest, frameByte(m_current.request, 0),
+                  frameByte(m_current.request, 1), frameRegister(m_current.request),
+                  static_cast<uint32_t>(m_current.request.size()));
+
+    m_state = State::Sent;
+    const int timeout = m_current.timeoutMs > 0 ? m_current.timeoutMs : m_timeout;
+    m_responseTimer->start(timeout + nsToTimerMs(txNs));
+}
+
+void ModbusRTU::onReadyRead() {
+    if (m_state != State::Sent && m_state != State::Receiving) {
+        // Unsolicited or late bytes; discarded before the next request
+        return;
     }
 
-    if (response[1] & 0x80) {
-        m_lastError = QString("Modbus error: 0x%1").arg(response[2], 2, 16, QChar('0'));
-        return false;
+    // Read straight into the frame buffer, never past the frame end
+    size_t want;
+    while ((want = m_assembler.wanted()) > 0 && m_device->bytesAvailable() > 0) {
+        qint64 n = m_device->read(reinterpret_cast<char*>(m_assembler.tail()),
+                                  static_cast<qint64>(want));
+        if (n <= 0) {
+            break;
+        }
+        m_assembler.commit(static_cast<size_t>(n));
     }
 
-    return true;
+    // Line busy until t3.5 after the last byte seen
+    const int64_t nowNs = m_clock.nsecsElapsed();
+    if (m_firstByteNs < 0 && m_assembler.size() > 0) {
+        m_firstByteNs = nowNs;
+    }
+    m_lineIdleAtNs = nowNs + m_timing.t35Ns();
+
+    switch (m_assembler.state()) {
+        case RtuFrameAssembler::State::Complete:
+            m_state = State::Complete;
+            recordTurnaround();
+            finish(Result::Ok);
+            return;
+
+        case RtuFrameAssembler::State::Overflow:
+            m_lastError = "Response exceeds maximum frame size";
+            m_state = State::Complete;
+            finish(Result::Overflow);
+            return;
+
+        case RtuFrameAssembler::State::Collecting:
+            // Restarted by every chunk: adapters and TCP bridges deliver a
+            // frame with gaps far longer than t3.5, but never longer than
+            // the silence tolerance
+            m_state = State::Receiving;
+            m_silenceTimer->start(silenceTimeoutMs());
+            return;
+
+        case RtuFrameAssembler::State::Empty:
+            return;
+    }
 }
 
-bool ModbusRTU::sendRequest(const std::vector<uint8_t>& request) {
-    m_port->clear();
-
-    qint64 written = m_port->write(reinterpret_cast<const char*>(request.data()),
-                                    static_cast<qint64>(request.size()));
+void ModbusRTU::onFrameSilence() {
+    if (m_state != State::Receiving) {
+        return;
+    }
 
-    if (written != static_cast<qint64>(request.size())) {
-        m_lastError = "Failed to write request";
-        return false;
+    // Bytes may have arrived without readyRead being processed yet
+    if (m_device && m_device->bytesAvailable() > 0) {
+        onReadyRead();
+        return;
     }
 
-    m_port->flush();
+    // Silence ends an open-ended frame; a known-length one is truncated
+    // (slave dropped mid-frame, noise burst) and fails now rather than
+    // on the response timeout
+    if (m_assembler.markSilence() == RtuFrameAssembler::State::Complete) {
+        m_state = State::Complete;
+        recordTurnaround();
+        finish(Result::Ok);
+        return;
+    }
 
-    // Inter-frame delay (3.5 char times at 9600 baud ≈ 4ms)
-    QThread::msleep(5);
+    m_lastError = QString("Incomplete response: got %1 bytes, expected %2")
+                      .arg(m_assembler.size()).arg(m_assembler.expectedLength());
+    m_state = State::Timeout;
+    finish(Result::Incomplete);
+}
 
-    return true;
+int ModbusRTU::silenceTimeoutMs() const {
+    return std::max({1, nsToTimerMs(m_timing.t35Ns()), m_silenceToleranceMs});
 }
 
-bool ModbusRTU::readResponse(std::vector<uint8_t>& response, int expectedLen) {
-    response.clear();
+void ModbusRTU::onResponseTimeout() {
+    if (m_state != State::Sent && m_state != State::Receiving) {
+        return;
+    }
 
-    if (!m_port->waitForReadyRead(m_timeout)) {
+    Result result;
+    if (m_state == State::Sent) {
         m_lastError = "Response timeout";
         Logger::warn("Modbus response timeout");
-        return false;
+        result = Result::Timeout;
+    } else {
+        m_lastError = QString("Incomplete response: got %1 bytes, expected %2")
+                          .arg(m_assembler.size()).arg(m_assembler.expectedLength());
+        result = Result::Incomplete;
     }
 
-    QByteArray data = m_port->readAll();
+    m_state = State::Timeout;
+    finish(result);
+}
+
+void ModbusRTU::recordTurnaround() {
+    const int64_t turnaroundUs = (m_firstByteNs - m_txEndNs) / 1000;
+    const int64_t transactionUs = (m_clock.nsecsElapsed() - m_sentAtNs) / 1000;
 
-    // Wait for more data if needed
-    while (data.size() < expectedLen && m_port->waitForReadyRead(100)) {
-        data.append(m_port->readAll());
+    if (m_diag.transactions == 0 || turnaroundUs < m_diag.minTurnaroundUs) {
+        m_diag.minTurnaroundUs = turnaroundUs;
+    }
+    if (m_diag.transactions == 0 || turnaroundUs > m_diag.maxTurnaroundUs) {
+        m_diag.maxTurnaroundUs = turnaroundUs;
     }
+    m_diag.lastTurnaroundUs = turnaroundUs;
+    m_diag.totalTurnaroundUs += turnaroundUs;
+    m_diag.lastTransactionUs = transactionUs;
+    ++m_diag.transactions;
+}
 
-    response.assign(data.begin(), data.end());
+void ModbusRTU::finish(Result result) {
+    m_responseTimer->stop();
+    m_silenceTimer->stop();
 
-    if (static_cast<int>(response.size()) < expectedLen) {
-        m_lastError = QString("Incomplete response: got %1 bytes, expected %2")
-                          .arg(response.size()).arg(expectedLen);
-        return false;
+    if (result == Result::Timeout) {
+        ++m_diag.timeouts;
+    } else if (result == Result::Incomplete || result == Result::Overflow) {
+        ++m_diag.incomplete;
     }
 
-    return true;
+    const bool sent = result != Result::NotOpen && result != Result::WriteError;
+    Trace::record(TraceEvent::ModbusTransaction, frameByte(m_current.request, 0),
+                  frameByte(m_current.request, 1), frameRegister(m_current.request),
+                  sent ? static_cast<uint32_t>((m_clock.nsecsElapsed() - m_sentAtNs) / 1000) : 0,
+                  static_cast<uint32_t>(result));
+
+    // Take the handler out first: it may queue the next transaction
+    FrameHandler handler = std::move(m_current.handler);
+    m_current.handler = nullptr;
+    m_state = State::Idle;
+
+    if (result != Result::Ok && result != Result::Incomplete) {
+        m_assembler.reset();
+    }
+
+    // Inter-frame silence before whatever is sent next
+    scheduleNext();
+
+    if (handler) {
+        handler(result, m_assembler.frame());
+    }
+}
+
+bool ModbusRTU::checkStatus(ModbusResponse::Status status, const ModbusFrame& response) {
+    switch (status) {
+        case ModbusResponse::Status::Ok:
+            return true;
+
+        case ModbusResponse::Status::Exception: {
+            uint8_t code = ModbusResponse::exceptionCode(response.view());
+            Trace::record(TraceEvent::ModbusException, frameByte(response, 0),
+                          frameByte(response, 1) & 0x7F, code);
+            m_lastError = QString("Modbus error: 0x%1").arg(code, 2, 16, QChar('0'));
+            Logger::error("Modbus error response: 0x{:02X}", code);
+            return false;
+        }
+
+        case ModbusResponse::Status::CrcError:
+            m_lastError = "CRC error in response";
+            Trace::record(TraceEvent::ModbusCrcError, frameByte(response, 0),
+                          frameByte(response, 1));
+            Logger::error("Modbus CRC error");
+            return false;
+
+        default:
+            m_lastError = ModbusResponse::statusText(status);
+            return false;
+    }
 }
 
 } // namespace rcms
@@ -1,8 +1,15 @@
 #pragma once
 
 #include <cstdint>
-#include <vector>
-#include <QSerialPort>
+#include <functional>
+#include <QObject>
+#include <QIODevice>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "ModbusFrame.h"
+#include "RtuFrameAssembler.h"
+#include "RtuTiming.h"
+#include "TransactionQueue.h"
 
 namespace rcms {
 
@@ -10,15 +17,45 @@ namespace rcms {
  * @brief Modbus RTU protocol implementation
  *
  * Implements Modbus RTU protocol for RS-485 communication
- * with radio devices like Fazan-19
+ * with radio devices like Fazan-19.
+ *
+ * Requests and responses live in fixed-capacity ModbusFrame buffers and
+ * register values are decoded straight into caller storage, so a
+ * transaction performs no heap allocations for frame data.
+ *
+ * The engine is event-driven: requests are queued, written to the
+ * QIODevice and completed from its readyRead() signal or a timeout timer.
+ * No call ever blocks or sleeps. Responses are assembled by
+ * RtuFrameAssembler, which knows the exact frame length from the header,
+ * so exception replies complete as soon as their 5 bytes arrive. Line
+ * silence is measured against max(t3.5, silence tolerance), not bare
+ * t3.5: USB-RS485 adapters and TCP bridges deliver a response in chunks
+ * with gaps well over t3.5. That much silence ends a frame of unknown
+ * length and fails a truncated known-length one as Incomplete.
+ *
+ * Line timing (t3.5, request transmit time) is derived from the port's
+ * baud rate and frame format. The next request is scheduled against a
+ * monotonic clock at last line activity + t3.5 rather than after a fixed
+ * sleep.
+ *
+ * Queued transactions are ordered by TransactionPriority: control commands
+ * go out at the next frame boundary, ahead of alarm reads and routine
+ * polls. Each transaction runs through
+ *
+ *   Idle -> Sent -> Receiving -> Complete | Timeout -> Idle
+ *
+ * and finishes by invoking its completion callback on the thread the
+ * engine lives in.
  */
-class ModbusRTU {
+class ModbusRTU : public QObject {
+    Q_OBJECT
+
 public:
     // Modbus function codes
-    static constexpr uint8_t FUNC_READ_HOLDING = 0x03;
-    static constexpr uint8_t FUNC_WRITE_SINGLE = 0x06;
-    static constexpr uint8_t FUNC_WRITE_MULTIPLE = 0x10;
-    static constexpr uint8_t FUNC_DEVICE_ID = 0x11;
+    static constexpr uint8_t FUNC_READ_HOLDING = ModbusFrame::FUNC_READ_HOLDING;
+    static constexpr uint8_t FUNC_WRITE_SINGLE = ModbusFrame::FUNC_WRITE_SINGLE;
+    static constexpr uint8_t FUNC_WRITE_MULTIPLE = ModbusFrame::FUNC_WRITE_MULTIPLE;
+    static constexpr uint8_t FUNC_DEVICE_ID = ModbusFrame::FUNC_DEVICE_ID;
 
     // Error codes
     static constexpr uint8_t ERR_ILLEGAL_FUNCTION = 0x01;
@@ -26,61 +63,229 @@ public:
     static constexpr uint8_t ERR_ILLEGAL_VALUE = 0x03;
     static constexpr uint8_t ERR_DEVICE_FAILURE = 0x04;
 
-    ModbusRTU();
-    ~ModbusRTU();
+    /**
+     * @brief Transaction state machine
+     */
+    enum class State {
+        Idle,       // No transaction in flight
+        Sent,       // Request written, waiting for the first response byte
+        Receiving,  // Response bytes arriving
+        Complete,   // Response frame received
+        Timeout     // No (complete) response within the timeout
+    };
 
     /**
-     * @brief Set serial port for communication
+     * @brief Outcome of a raw transaction
      */
-    void setPort(QSerialPort* port) { m_port = port; }
+    enum class Result {
+        Ok,             // Frame received (content not yet validated)
+        Timeout,        // No response at all
+        Incomplete,     // Some bytes, then silence or the timeout before a full frame
+        Overflow,       // Response longer than an RTU ADU
+        WriteError,     // Request could not be written
+        NotOpen         // Device not set or not open
+    };
+
+    /**
+     * @brief Line turnaround statistics
+     *
+     * Turnaround is measured from the end of request transmission
+     * (write time + transmit time at the line rate) to the first
+     * response byte.
+     */
+    struct Diagnostics {
+        uint64_t transactions = 0;      // Completed with a full frame
+        uint64_t timeouts = 0;          // No response
+        uint64_t incomplete = 0;        // Truncated or oversized response
+        int64_t lastTurnaroundUs = 0;
+        int64_t minTurnaroundUs = 0;
+        int64_t maxTurnaroundUs = 0;
+        int64_t totalTurnaroundUs = 0;
+        int64_t lastTransactionUs = 0;  // Request write to frame complete
+
+        int64_t averageTurnaroundUs() const {
+            return transactions ? totalTurnaroundUs / static_cast<int64_t>(transactions) : 0;
+        }
+    };
+
+    using FrameHandler = std::function<void(Result result, const ModbusFrame& response)>;
+    using ReadHandler = std::function<void(bool ok, ConstRegisterSpan values)>;
+    using WriteHandler = std::function<void(bool ok)>;
+
+    explicit ModbusRTU(QObject* parent = nullptr);
+    ~ModbusRTU() override;
+
+    /**
+     * @brief Set I/O device (serial port or socket) for communication
+     *
+     * Pending transactions are dropped when the device changes.
+     */
+    void setDevice(QIODevice* device);
+    QIODevice* device() const { return m_device; }
 
     /**
      * @brief Set response timeout in milliseconds
      */
     void setTimeout(int ms) { m_timeout = ms; }
+    int timeout() const { return m_timeout; }
+
+    /**
+     * @brief Set line timing (baud rate and frame format)
+     */
+    void setTiming(const RtuTiming& timing) { m_timing = timing; }
+    const RtuTiming& timing() const { return m_timing; }
+
+    /**
+     * @brief Shortest line silence that ends a frame of unknown length
+     *        (or fails a truncated one), ms
+     *
+     * Covers the transport's delivery jitter (adapter latency timer,
+     * TCP segmentation); t3.5 is used when it is longer.
+     */
+    void setSilenceTolerance(int ms) { m_silenceToleranceMs = ms; }
+    int silenceTolerance() const { return m_silenceToleranceMs; }
+
+    /**
+     * @brief Turnaround statistics since the last reset
+     */
+    const Diagnostics& diagnostics() const { return m_diag; }
+    void resetDiagnostics() { m_diag = Diagnostics(); }
+
+    /**
+     * @brief Current transaction state
+     */
+    State state() const { return m_state; }
+
+    /**
+     * @brief Transaction in flight or queued
+     */
+    bool isBusy() const { return m_state != State::Idle || !m_queue.empty(); }
+
+    /**
+     * @brief Number of queued (not yet sent) transactions
+     */
+    size_t pendingCount() const { return m_queue.size(); }
+
+    /**
+     * @brief Queue a raw request
+     * @param request Complete RTU frame including CRC
+     * @param handler Completion callback
+     * @param owner Tag for cancel(owner), e.g. the submitting device
+     * @param priority Scheduling class
+     * @param timeoutMs Response timeout for this request, 0 for timeout()
+     */
+    void transact(const ModbusFrame& request, FrameHandler handler,
+                  const void* owner = nullptr,
+                  TransactionPriority priority = TransactionPriority::Poll,
+                  int timeoutMs = 0);
 
     /**
      * @brief Read holding registers (function 0x03)
      * @param address Device address
      * @param startReg Starting register address
-     * @param count Number of registers to read
-     * @param values Output vector for register values
-     * @return true on success
+     * @param count Number of registers to read (1-125)
+     * @param handler Receives the decoded values (valid during the call)
+     * @param owner Tag for cancel(owner)
+     * @param priority Scheduling class
+     * @param timeoutMs Response timeout for this request, 0 for timeout()
      */
-    bool readHoldingRegisters(uint8_t address, uint16_t startReg,
-                              uint16_t count, std::vector<uint16_t>& values);
+    void readHoldingRegisters(uint8_t address, uint16_t startReg,
+                              uint16_t count, ReadHandler handler,
+                              const void* owner = nullptr,
+                              TransactionPriority priority = TransactionPriority::Poll,
+                              int timeoutMs = 0);
 
     /**
      * @brief Write single register (function 0x06)
      * @param address Device address
      * @param reg Register address
      * @param value Value to write
-     * @return true on success
+     * @param handler Completion callback
+     * @param owner Tag for cancel(owner)
+     * @param priority Scheduling class
      */
-    bool writeSingleRegister(uint8_t address, uint16_t reg, uint16_t value);
+    void writeSingleRegister(uint8_t address, uint16_t reg, uint16_t value,
+                             WriteHandler handler, const void* owner = nullptr,
+                             TransactionPriority priority = TransactionPriority::Control);
 
     /**
      * @brief Write multiple registers (function 0x10)
      * @param address Device address
      * @param startReg Starting register address
-     * @param values Values to write
-     * @return true on success
+     * @param values Values to write (1-123)
+     * @param handler Completion callback
+     * @param owner Tag for cancel(owner)
+     * @param priority Scheduling class
+     */
+    void writeMultipleRegisters(uint8_t address, uint16_t startReg,
+                                ConstRegisterSpan values, WriteHandler handler,
+                                const void* owner = nullptr,
+                                TransactionPriority priority = TransactionPriority::Control);
+
+    /**
+     * @brief Drop the transaction in flight and all queued ones
+     *
+     * Handlers of dropped transactions are not called.
+     */
+    void cancelAll();
+
+    /**
+     * @brief Drop queued transactions submitted by one owner
+     *
+     * A transaction of that owner already on the bus runs to completion
+     * (the line stays in sync) but its handler is not called.
      */
-    bool writeMultipleRegisters(uint8_t address, uint16_t startReg,
-                                const std::vector<uint16_t>& values);
+    void cancel(const void* owner);
 
     /**
      * @brief Get last error message
      */
     const QString& lastError() const { return m_lastError; }
 
+private slots:
+    void onReadyRead();
+    void onResponseTimeout();
+    void onFrameSilence();
+    void startNext();
+
 private:
-    bool sendRequest(const std::vector<uint8_t>& request);
-    bool readResponse(std::vector<uint8_t>& response, int expectedLen);
+    struct Transaction {
+        ModbusFrame request;
+        FrameHandler handler;
+        const void* owner = nullptr;
+        int timeoutMs = 0;
+    };
+
+    void finish(Result result);
+    void scheduleNext();
+    void recordTurnaround();
+    static int nsToTimerMs(int64_t ns);
+    int silenceTimeoutMs() const;
+    bool checkStatus(ModbusResponse::Status status, const ModbusFrame& response);
 
-    QSerialPort* m_port = nullptr;
+    QIODevice* m_device = nullptr;
     int m_timeout = 2000; // Default 2 seconds
+    RtuTiming m_timing;
+    int m_silenceToleranceMs = 20;  // USB-RS485 latency timer is 16 ms
     QString m_lastError;
+
+    State m_state = State::Idle;
+    TransactionQueue<Transaction> m_queue;
+    Transaction m_current;
+    RtuFrameAssembler m_assembler;
+    std::array<uint16_t, ModbusFrame::MAX_READ_REGISTERS> m_registers{};
+
+    QTimer* m_responseTimer;
+    QTimer* m_silenceTimer;
+    QTimer* m_guardTimer;
+
+    // Monotonic clock for line timing (ns since engine creation)
+    QElapsedTimer m_clock;
+    int64_t m_lineIdleAtNs = 0;     // Earliest time the next request may start
+    int64_t m_sentAtNs = 0;         // Request handed to the device
+    int64_t m_txEndNs = 0;          // Request fully on the wire (estimated)
+    int64_t m_firstByteNs = -1;     // First response byte of current transaction
+    Diagnostics m_diag;
 };
 
 } // namespace rcms
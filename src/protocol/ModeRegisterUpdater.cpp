@@ -0,0 +1,83 @@
+#include "ModeRegisterUpdater.h"
+#include <iterator>
+#include <utility>
+
+namespace rcms {
+
+ModeRegisterUpdater::ModeRegisterUpdater(ReadFn read, WriteFn write)
+    : m_read(std::move(read))
+    , m_write(std::move(write))
+{
+}
+
+void ModeRegisterUpdater::update(uint16_t bits, bool set, Done done) {
+    m_queue.push_back(Change{bits, set, std::move(done)});
+    if (!m_busy) {
+        startRound();
+    }
+}
+
+void ModeRegisterUpdater::reset() {
+    ++m_generation;
+    std::vector<Change> failed;
+    failed.swap(m_round);
+    failed.insert(failed.end(), std::make_move_iterator(m_queue.begin()),
+                  std::make_move_iterator(m_queue.end()));
+    m_queue.clear();
+    m_busy = false;
+
+    // Callbacks may request new changes; those start a fresh round
+    for (const Change& change : failed) {
+        if (change.done) {
+            change.done(false);
+        }
+    }
+}
+
+void ModeRegisterUpdater::startRound() {
+    m_busy = true;
+    m_round.swap(m_queue);
+    const uint32_t generation = m_generation;
+
+    m_read([this, generation](bool ok, uint16_t value) {
+        if (generation != m_generation) {
+            return; // Round abandoned by reset()
+        }
+        if (!ok) {
+            finishRound(false);
+            return;
+        }
+
+        for (const Change& change : m_round) {
+            if (change.set) {
+                value |= change.bits;
+            } else {
+                value &= static_cast<uint16_t>(~change.bits);
+            }
+        }
+        m_write(value, [this, generation](bool written) {
+            if (generation == m_generation) {
+                finishRound(written);
+            }
+        });
+    });
+}
+
+void ModeRegisterUpdater::finishRound(bool ok) {
+    std::vector<Change> round;
+    round.swap(m_round);
+    m_busy = false;
+
+    // Callbacks may request more changes; they queue behind what is waiting
+    for (const Change& change : round) {
+        if (change.done) {
+            change.done(ok);
+        }
+    }
+
+    if (!m_busy && !m_queue.empty()) {
+        startRound();
+    }
+}
+
+} // namespace rcms
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace rcms {
+
+/**
+ * @brief Serialized read-modify-write of a bit-field register (MR1)
+ *
+ * Independent controls (PTT, squelch, ...) share one register. Two
+ * overlapping read-modify-writes would run read, read, write, write and
+ * the second write would undo the first one's bit. Here only one round is
+ * on the bus at a time; changes requested meanwhile are queued and applied
+ * together in the next round: one read, every queued change in request
+ * order, one write.
+ *
+ * The transport is injected, so the sequencing is independent of the bus.
+ */
+class ModeRegisterUpdater {
+public:
+    using Done = std::function<void(bool ok)>;
+    using ReadDone = std::function<void(bool ok, uint16_t value)>;
+    using ReadFn = std::function<void(ReadDone done)>;
+    using WriteFn = std::function<void(uint16_t value, Done done)>;
+
+    ModeRegisterUpdater(ReadFn read, WriteFn write);
+
+    /**
+     * @brief Set or clear bits; done reports whether the write succeeded
+     */
+    void update(uint16_t bits, bool set, Done done);
+
+    /**
+     * @brief Abandon the round in flight and everything queued
+     *
+     * For a closed connection, whose completions never arrive: every
+     * pending callback gets false, and a late completion of the abandoned
+     * round is ignored.
+     */
+    void reset();
+
+    /**
+     * @brief A round is on the bus
+     */
+    bool busy() const { return m_busy; }
+
+    /**
+     * @brief Changes waiting for the next round
+     */
+    size_t queued() const { return m_queue.size(); }
+
+private:
+    struct Change {
+        uint16_t bits;
+        bool set;
+        Done done;
+    };
+
+    void startRound();
+    void finishRound(bool ok);
+
+    ReadFn m_read;
+    WriteFn m_write;
+    std::vector<Change> m_queue;        // Requested, not yet started
+    std::vector<Change> m_round;        // Applied by the round in flight
+    bool m_busy = false;
+    uint32_t m_generation = 0;          // Bumped by reset(); stale completions compare unequal
+};
+
+} // namespace rcms
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace rcms {
+
+/**
+ * @brief Contiguous holding register range for one read request
+ */
+struct ReadBlock {
+    uint16_t start = 0;
+    uint16_t count = 0;
+};
+
+/**
+ * @brief Minimal set of read requests covering a register mask
+ *
+ * Bit n of the mask selects register n. Neighbouring runs are merged into
+ * one request when the registers between them number at most maxGap,
+ * trading a few unwanted registers for a request's framing and
+ * turnaround. Fixed capacity: a 32-bit mask has at most 16 runs.
+ */
+struct ReadPlan {
+    static constexpr size_t MAX_BLOCKS = 16;
+
+    std::array<ReadBlock, MAX_BLOCKS> blocks{};
+    size_t size = 0;
+
+    const ReadBlock* begin() const { return blocks.data(); }
+    const ReadBlock* end() const { return blocks.data() + size; }
+    const ReadBlock& operator[](size_t i) const { return blocks[i]; }
+    bool empty() const { return size == 0; }
+
+    /**
+     * @brief Registers read in total, requested or not
+     */
+    size_t registerCount() const {
+        size_t total = 0;
+        for (const ReadBlock& block : *this) {
+            total += block.count;
+        }
+        return total;
+    }
+
+    /**
+     * @brief Wire bytes for all requests and responses (FC 0x03)
+     *
+     * Request is 8 bytes, response 5 plus 2 per register.
+     */
+    size_t wireBytes() const {
+        return size * (8 + 5) + registerCount() * 2;
+    }
+
+    static ReadPlan build(uint32_t mask, uint16_t maxGap) {
+        ReadPlan plan;
+        uint16_t reg = 0;
+
+        while (mask >> reg) {
+            if (!(mask & (uint32_t(1) << reg))) {
+                ++reg;
+                continue;
+            }
+
+            // Run of wanted registers starting at reg
+            uint16_t end = reg;
+            while (end < 32 && (mask & (uint32_t(1) << end))) {
+                ++end;
+            }
+
+            ReadBlock* last = plan.size ? &plan.blocks[plan.size - 1] : nullptr;
+            if (last && reg - (last->start + last->count) <= maxGap) {
+                last->count = static_cast<uint16_t>(end - last->start);
+            } else {
+                plan.blocks[plan.size++] = ReadBlock{reg, static_cast<uint16_t>(end - reg)};
+            }
+
+            reg = end;
+            if (reg >= 32) {
+                break;
+            }
+        }
+        return plan;
+    }
+};
+
+} // namespace rcms
@@ -0,0 +1,151 @@
+#include "RtuFrameAssembler.h"
+
+namespace rcms {
+
+namespace {
+// Header bytes: [addr][fc] (+ [byteCount] for variable-length replies)
+constexpr size_t HEADER_SIZE = 2;
+constexpr size_t CRC_SIZE = 2;
+}
+
+void RtuFrameAssembler::reset() {
+    m_frame.clear();
+    m_expected = 0;
+    m_state = State::Empty;
+}
+
+size_t RtuFrameAssembler::wanted() const {
+    if (m_state == State::Complete || m_state == State::Overflow) {
+        return 0;
+    }
+    if (m_expected > 0) {
+        return m_expected - m_frame.size();
+    }
+    // Length unknown yet: read just enough to learn it, unless the
+    // function code has no fixed layout
+    if (m_frame.size() >= HEADER_SIZE && !isKnownFunction(m_frame[1])) {
+        return m_frame.available();
+    }
+    return m_frame.size() < HEADER_SIZE ? HEADER_SIZE - m_frame.size() : 1;
+}
+
+RtuFrameAssembler::State RtuFrameAssembler::commit(size_t count) {
+    if (count > m_frame.available()) {
+        m_frame.grow(m_frame.available());
+        m_state = State::Overflow;
+        return m_state;
+    }
+    m_frame.grow(count);
+    update();
+    return m_state;
+}
+
+size_t RtuFrameAssembler::feed(ByteView bytes) {
+    size_t consumed = 0;
+    while (consumed < bytes.size()) {
+        size_t n = wanted();
+        if (n == 0) {
+            break;
+        }
+        if (n > bytes.size() - consumed) {
+            n = bytes.size() - consumed;
+        }
+        m_frame.appendBytes(bytes.subspan(consumed, n));
+        consumed += n;
+        update();
+    }
+    return consumed;
+}
+
+RtuFrameAssembler::State RtuFrameAssembler::markSilence() {
+    if (m_state == State::Collecting && isOpenEnded()) {
+        m_state = State::Complete;
+    }
+    return m_state;
+}
+
+bool RtuFrameAssembler::isOpenEnded() const {
+    return m_expected == 0 && m_frame.size() >= HEADER_SIZE && !isKnownFunction(m_frame[1]);
+}
+
+bool RtuFrameAssembler::isTruncated() const {
+    return m_state == State::Collecting && m_expected > 0 && m_frame.size() < m_expected;
+}
+
+void RtuFrameAssembler::update() {
+    if (m_frame.empty()) {
+        m_state = State::Empty;
+        return;
+    }
+
+    if (m_expected == 0) {
+        m_expected = frameLength(m_frame.view());
+        if (m_expected > ModbusFrame::MAX_ADU_SIZE) {
+            m_state = State::Overflow;
+            return;
+        }
+    }
+
+    if (m_expected > 0 && m_frame.size() >= m_expected) {
+        m_state = State::Complete;
+    } else if (m_frame.available() == 0) {
+        m_state = State::Overflow;
+    } else {
+        m_state = State::Collecting;
+    }
+}
+
+bool RtuFrameAssembler::isKnownFunction(uint8_t function) {
+    switch (function & ~ModbusFrame::EXCEPTION_FLAG) {
+        case 0x01: // Read coils
+        case 0x02: // Read discrete inputs
+        case 0x03: // Read holding registers
+        case 0x04: // Read input registers
+        case 0x05: // Write single coil
+        case 0x06: // Write single register
+        case 0x0F: // Write multiple coils
+        case 0x10: // Write multiple registers
+        case 0x11: // Report slave ID
+            return true;
+        default:
+            return (function & ModbusFrame::EXCEPTION_FLAG) != 0;
+    }
+}
+
+size_t RtuFrameAssembler::frameLength(ByteView prefix) {
+    if (prefix.size() < HEADER_SIZE) {
+        return 0;
+    }
+
+    const uint8_t function = prefix[1];
+
+    // Exception: [addr][0x80|fc][code][crcLo][crcHi]
+    if (function & ModbusFrame::EXCEPTION_FLAG) {
+        return ModbusResponse::EXCEPTION_LENGTH;
+    }
+
+    switch (function) {
+        // [addr][fc][byteCount][data...][crcLo][crcHi]
+        case 0x01:
+        case 0x02:
+        case 0x03:
+        case 0x04:
+        case 0x11:
+            if (prefix.size() < HEADER_SIZE + 1) {
+                return 0;
+            }
+            return HEADER_SIZE + 1 + prefix[2] + CRC_SIZE;
+
+        // Echo: [addr][fc][2 bytes][2 bytes][crcLo][crcHi]
+        case 0x05:
+        case 0x06:
+        case 0x0F:
+        case 0x10:
+            return ModbusResponse::WRITE_ECHO_LENGTH;
+
+        default:
+            return 0;
+    }
+}
+
+} // namespace rcms
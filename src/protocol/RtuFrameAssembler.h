@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include "ModbusFrame.h"
+
+namespace rcms {
+
+/**
+ * @brief Streaming Modbus RTU response assembler
+ *
+ * Collects response bytes as they arrive and works out the exact frame
+ * length from the header (function code and, where present, byte count),
+ * so a frame is complete the moment its last byte is received. Exception
+ * responses (0x80 | fc) are recognised after two bytes and complete at
+ * five.
+ *
+ * For function codes whose length cannot be derived from the header the
+ * caller ends the frame on t3.5 silence (see markSilence()).
+ *
+ * Bytes are received straight into the internal frame buffer via
+ * tail()/commit(), so assembling performs no heap allocations.
+ */
+class RtuFrameAssembler {
+public:
+    enum class State {
+        Empty,          // No bytes yet
+        Collecting,     // Header seen, frame not complete
+        Complete,       // Exact length reached, or ended by silence
+        Overflow        // More bytes than an RTU ADU can hold
+    };
+
+    RtuFrameAssembler() = default;
+
+    /**
+     * @brief Discard collected bytes and start a new frame
+     */
+    void reset();
+
+    /**
+     * @brief Write position for receiving bytes directly
+     */
+    uint8_t* tail() { return m_frame.tail(); }
+
+    /**
+     * @brief How many bytes may be written at tail()
+     *
+     * Limited to the remaining bytes of the current frame once its length
+     * is known, so bytes of a following frame are left in the device.
+     */
+    size_t wanted() const;
+
+    /**
+     * @brief Commit bytes written at tail()
+     * @return Current state
+     */
+    State commit(size_t count);
+
+    /**
+     * @brief Copy bytes in (for sources that can't read into tail())
+     * @return Number of bytes consumed
+     */
+    size_t feed(ByteView bytes);
+
+    /**
+     * @brief Inter-frame silence (t3.5) detected on the line
+     *
+     * Ends an open-ended frame (see isOpenEnded()). A frame whose length
+     * is known, or still to be learnt from the header, stays in
+     * Collecting; check isTruncated().
+     */
+    State markSilence();
+
+    State state() const { return m_state; }
+    bool isComplete() const { return m_state == State::Complete; }
+
+    /**
+     * @brief Bytes received but fewer than the header announced
+     */
+    bool isTruncated() const;
+
+    /**
+     * @brief Exact frame length, 0 while not yet known
+     */
+    size_t expectedLength() const { return m_expected; }
+
+    /**
+     * @brief Function code has no fixed layout: only silence ends the frame
+     */
+    bool isOpenEnded() const;
+
+    const ModbusFrame& frame() const { return m_frame; }
+    size_t size() const { return m_frame.size(); }
+
+    /**
+     * @brief Exact RTU frame length derived from a frame prefix
+     * @param prefix First bytes of a response
+     * @return Frame length, 0 if more bytes are needed or the function
+     *         code has no fixed layout
+     */
+    static size_t frameLength(ByteView prefix);
+
+    /**
+     * @brief Function codes whose response length frameLength() knows
+     */
+    static bool isKnownFunction(uint8_t function);
+
+private:
+    void update();
+
+    ModbusFrame m_frame;
+    size_t m_expected = 0;
+    State m_state = State::Empty;
+};
+
+} // namespace rcms
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rcms {
+
+/**
+ * @brief Modbus RTU character timing for a serial frame format
+ *
+ * Derives character time, t1.5 (max inter-character gap) and t3.5
+ * (inter-frame silence) from baud rate and frame format, following the
+ * Modbus over serial line specification: above 19200 baud the timers are
+ * fixed at 750 us and 1.75 ms.
+ *
+ * All times are in nanoseconds to match monotonic clock readings.
+ */
+struct RtuTiming {
+    int baudRate = 9600;
+    int dataBits = 8;
+    bool parity = false;        // Even or odd parity bit present
+    int stopBits = 1;
+
+    // Spec values above 19200 baud
+    static constexpr int64_t FIXED_T15_NS = 750000;
+    static constexpr int64_t FIXED_T35_NS = 1750000;
+    static constexpr int FIXED_TIMING_BAUD = 19200;
+
+    /**
+     * @brief Bits on the wire per character (start + data + parity + stop)
+     */
+    constexpr int bitsPerCharacter() const {
+        return 1 + dataBits + (parity ? 1 : 0) + stopBits;
+    }
+
+    /**
+     * @brief Time to transmit one character
+     */
+    constexpr int64_t characterNs() const {
+        return baudRate > 0 ? (bitsPerCharacter() * 1000000000LL + baudRate - 1) / baudRate : 0;
+    }
+
+    /**
+     * @brief Maximum silence between characters of one frame
+     */
+    constexpr int64_t t15Ns() const {
+        return baudRate > FIXED_TIMING_BAUD ? FIXED_T15_NS : characterNs() * 3 / 2;
+    }
+
+    /**
+     * @brief Minimum silence between frames
+     */
+    constexpr int64_t t35Ns() const {
+        return baudRate > FIXED_TIMING_BAUD ? FIXED_T35_NS : characterNs() * 7 / 2;
+    }
+
+    /**
+     * @brief Time to transmit a frame of the given length
+     */
+    constexpr int64_t transmitNs(size_t bytes) const {
+        return characterNs() * static_cast<int64_t>(bytes);
+    }
+};
+
+} // namespace rcms
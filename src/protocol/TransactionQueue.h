@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <utility>
+
+namespace rcms {
+
+/**
+ * @brief Scheduling class of a bus transaction
+ *
+ * Lower value runs first. Control commands (PTT, frequency, squelch) go
+ * out at the next frame boundary ahead of any queued background traffic.
+ */
+enum class TransactionPriority {
+    Control = 0,    // Operator commands
+    Alarm = 1,      // Alarm register reads
+    Poll = 2        // Routine status polling
+};
+
+constexpr size_t TRANSACTION_PRIORITY_COUNT = 3;
+
+inline const char* priorityName(TransactionPriority priority) {
+    switch (priority) {
+        case TransactionPriority::Control: return "control";
+        case TransactionPriority::Alarm: return "alarm";
+        case TransactionPriority::Poll: return "poll";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Per-bus transaction queue with priority classes
+ *
+ * One FIFO per class; pop() takes from the highest non-empty class, so
+ * ordering within a class is preserved. An in-flight transaction is never
+ * preempted - a frame on the wire always completes.
+ */
+template <typename T>
+class TransactionQueue {
+public:
+    void push(T item, TransactionPriority priority) {
+        m_queues[index(priority)].push_back(std::move(item));
+    }
+
+    /**
+     * @brief Remove and return the next item
+     * @pre !empty()
+     */
+    T pop() {
+        for (auto& queue : m_queues) {
+            if (!queue.empty()) {
+                T item = std::move(queue.front());
+                queue.pop_front();
+                return item;
+            }
+        }
+        return T();
+    }
+
+    /**
+     * @brief Priority of the item pop() would return
+     * @pre !empty()
+     */
+    TransactionPriority nextPriority() const {
+        for (size_t i = 0; i < m_queues.size(); ++i) {
+            if (!m_queues[i].empty()) {
+                return static_cast<TransactionPriority>(i);
+            }
+        }
+        return TransactionPriority::Poll;
+    }
+
+    bool empty() const {
+        for (const auto& queue : m_queues) {
+            if (!queue.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& queue : m_queues) {
+            total += queue.size();
+        }
+        return total;
+    }
+
+    size_t size(TransactionPriority priority) const {
+        return m_queues[index(priority)].size();
+    }
+
+    /**
+     * @brief Remove all items matching a predicate
+     * @return Number of items removed
+     */
+    template <typename Pred>
+    size_t removeIf(Pred pred) {
+        size_t removed = 0;
+        for (auto& queue : m_queues) {
+            for (auto it = queue.begin(); it != queue.end();) {
+                if (pred(*it)) {
+                    it = queue.erase(it);
+                    ++removed;
+                } else {
+                    ++it;
+                }
+            }
+        }
+        return removed;
+    }
+
+    void clear() {
+        for (auto& queue : m_queues) {
+            queue.clear();
+        }
+    }
+
+private:
+    static size_t index(TransactionPriority priority) {
+        size_t i = static_cast<size_t>(priority);
+        return i < TRANSACTION_PRIORITY_COUNT ? i : TRANSACTION_PRIORITY_COUNT - 1;
+    }
+
+    std::array<std::deque<T>, TRANSACTION_PRIORITY_COUNT> m_queues;
+};
+
+} // namespace rcms
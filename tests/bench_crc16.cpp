@@ -0,0 +1,111 @@
+/**
+ * @file bench_crc16.cpp
+ * @brief Micro-benchmark for CRC-16 Modbus kernels
+ *
+ * Measures every kernel on typical Modbus frame sizes and on a bulk buffer,
+ * and reports the speedup over the bitwise reference loop.
+ * Exit code is non-zero if the selected kernel is not faster than the
+ * reference or produces a different checksum.
+ */
+
+#include "comm/CRC16.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace rcms;
+
+namespace {
+
+struct Workload {
+    const char* name;
+    size_t frameSize;
+    size_t iterations;
+};
+
+volatile uint16_t g_sink = 0;
+
+double measureNsPerFrame(CRC16::Kernel kernel, const std::vector<uint8_t>& data,
+                         size_t iterations) {
+    using Clock = std::chrono::steady_clock;
+
+    // Warm-up (tables into cache)
+    for (size_t i = 0; i < iterations / 10 + 1; ++i) {
+        g_sink = CRC16::calculate(kernel, data.data(), data.size());
+    }
+
+    auto start = Clock::now();
+    uint16_t acc = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        acc ^= CRC16::calculate(kernel, data.data(), data.size());
+    }
+    auto elapsed = Clock::now() - start;
+    g_sink = acc;
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           static_cast<double>(iterations);
+}
+
+} // anonymous namespace
+
+int main() {
+    const Workload workloads[] = {
+        {"request (8 B)", 8, 2000000},
+        {"status response (61 B)", 61, 500000},
+        {"bulk (4 KiB)", 4096, 20000},
+        {"capture replay (64 KiB)", 65536, 2000},
+    };
+
+    const CRC16::Kernel kernels[] = {
+        CRC16::Kernel::Bitwise,
+        CRC16::Kernel::Table,
+        CRC16::Kernel::Slice4,
+        CRC16::Kernel::Slice8,
+        CRC16::Kernel::Clmul,
+    };
+
+    const CRC16::Kernel selected = CRC16::activeKernel();
+    std::printf("Selected kernel: %s\n\n", CRC16::kernelName(selected));
+    std::printf("%-24s %-10s %12s %10s %9s\n", "workload", "kernel", "ns/frame", "MB/s", "speedup");
+
+    bool ok = true;
+
+    for (const auto& w : workloads) {
+        std::vector<uint8_t> data(w.frameSize);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<uint8_t>(i * 31 + 7);
+        }
+
+        const uint16_t reference = CRC16::calculateBitwise(data.data(), data.size());
+        double baseline = 0.0;
+
+        for (auto kernel : kernels) {
+            if (!CRC16::isSupported(kernel)) {
+                std::printf("%-24s %-10s not supported on this CPU\n", w.name, CRC16::kernelName(kernel));
+                continue;
+            }
+            if (CRC16::calculate(kernel, data.data(), data.size()) != reference) {
+                std::printf("%-24s %-10s checksum mismatch\n", w.name, CRC16::kernelName(kernel));
+                ok = false;
+                continue;
+            }
+
+            double ns = measureNsPerFrame(kernel, data, w.iterations);
+            if (kernel == CRC16::Kernel::Bitwise) {
+                baseline = ns;
+            }
+
+            double mbps = static_cast<double>(w.frameSize) * 1000.0 / ns;
+            double speedup = baseline / ns;
+            std::printf("%-24s %-10s %12.1f %10.1f %8.2fx\n",
+                        w.name, CRC16::kernelName(kernel), ns, mbps, speedup);
+
+            if (kernel == selected && kernel != CRC16::Kernel::Bitwise && speedup <= 1.0) {
+                ok = false;
+            }
+        }
+        std::printf("\n");
+    }
+
+    return ok ? 0 : 1;
+}
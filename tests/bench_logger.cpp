@@ -0,0 +1,115 @@
+/**
+ * @file bench_logger.cpp
+ * @brief Hot-path latency of Logger calls: sync vs async, runtime vs
+ *        compile-time format strings
+ *
+ * Logs a typical per-timeout message from a polling loop and reports the
+ * per-call latency distribution seen by the caller. File sink only, as in
+ * production without a console.
+ * Exit code is non-zero if async logging is not faster at the median than
+ * the old synchronous runtime-format path.
+ */
+
+#include "core/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace rcms;
+
+namespace {
+
+constexpr size_t CALLS = 200000;
+
+struct Result {
+    double p50;
+    double p99;
+    double max;
+};
+
+enum class Path {
+    RuntimeFormat,      // Former wrapper: const std::string& fmt, parsed per call
+    CompileTimeFormat
+};
+
+Result measure(const Logger::Config& config, Path path) {
+    using Clock = std::chrono::steady_clock;
+
+    Logger::init(config);
+    std::vector<double> ns(CALLS);
+
+    for (size_t i = 0; i < CALLS; ++i) {
+        const uint8_t address = static_cast<uint8_t>(i % 32 + 1);
+        const int elapsedUs = static_cast<int>(i % 500);
+
+        auto start = Clock::now();
+        if (path == Path::RuntimeFormat) {
+            const std::string fmt = "Modbus response timeout (addr: {}, fc: 0x{:02X}, {} us)";
+            spdlog::warn(fmt::runtime(fmt), address, 0x03, elapsedUs);
+        } else {
+            Logger::warn("Modbus response timeout (addr: {}, fc: 0x{:02X}, {} us)",
+                         address, 0x03, elapsedUs);
+        }
+        ns[i] = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    Logger::shutdown();
+
+    std::sort(ns.begin(), ns.end());
+    return Result{ns[CALLS / 2], ns[CALLS * 99 / 100], ns.back()};
+}
+
+} // anonymous namespace
+
+int main() {
+    const std::string file = "bench_logger.log";
+
+    Logger::Config sync;
+    sync.file = file;
+    sync.console = false;
+    sync.async = false;
+
+    Logger::Config asyncBlock = sync;
+    asyncBlock.async = true;
+    asyncBlock.overflow = Logger::OverflowPolicy::Block;
+
+    Logger::Config asyncDrop = asyncBlock;
+    asyncDrop.overflow = Logger::OverflowPolicy::DropOldest;
+
+    struct Case {
+        const char* name;
+        const Logger::Config* config;
+        Path path;
+    };
+    const Case cases[] = {
+        {"sync, runtime fmt", &sync, Path::RuntimeFormat},
+        {"sync, compile-time fmt", &sync, Path::CompileTimeFormat},
+        {"async block", &asyncBlock, Path::CompileTimeFormat},
+        {"async drop-oldest", &asyncDrop, Path::CompileTimeFormat},
+    };
+
+    std::printf("%zu calls per case, queue %zu\n\n", CALLS, asyncBlock.queueSize);
+    std::printf("%-24s %10s %10s %12s\n", "case", "p50 ns", "p99 ns", "max ns");
+
+    double baseline = 0.0;
+    double bestAsync = 0.0;
+
+    for (const auto& c : cases) {
+        std::remove(file.c_str());
+        Result r = measure(*c.config, c.path);
+        std::printf("%-24s %10.0f %10.0f %12.0f\n", c.name, r.p50, r.p99, r.max);
+
+        if (c.config == &sync && c.path == Path::RuntimeFormat) {
+            baseline = r.p50;
+        }
+        if (c.config->async && (bestAsync == 0.0 || r.p50 < bestAsync)) {
+            bestAsync = r.p50;
+        }
+    }
+    std::remove(file.c_str());
+
+    std::printf("\nmedian hot-path latency: %.2fx lower with async\n", baseline / bestAsync);
+    return bestAsync < baseline ? 0 : 1;
+}
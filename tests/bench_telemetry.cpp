@@ -0,0 +1,104 @@
+/**
+ * @file bench_telemetry.cpp
+ * @brief Sustained ingest benchmark for the telemetry store
+ *
+ * Replays simulated hours of 256 devices polled at 1 Hz as fast as the
+ * store accepts them, including the batched writes to disk, and reports
+ * how many times faster than real time that is.
+ * Exit code is non-zero if the store can't keep up with real time.
+ */
+
+#include "core/TelemetryStore.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace rcms;
+
+namespace {
+
+constexpr int DEVICES = 256;
+constexpr double REQUIRED_RATE = DEVICES * 1.0;    // Samples/s at 1 Hz
+
+struct Workload {
+    const char* name;
+    int seconds;            // Simulated time span
+};
+
+void removeFiles(const std::string& path) {
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+}
+
+} // anonymous namespace
+
+int main() {
+    const Workload workloads[] = {
+        {"10 minutes", 600},
+        {"1 hour", 3600},
+    };
+
+    std::vector<std::string> names;
+    for (int d = 0; d < DEVICES; ++d) {
+        names.push_back("Fazan19_" + std::to_string(d + 1));
+    }
+
+    std::printf("%d devices at 1 Hz, required %.0f samples/s\n\n", DEVICES, REQUIRED_RATE);
+    std::printf("%-12s %10s %10s %14s %12s %10s\n",
+                "workload", "samples", "seconds", "samples/s", "ingest ns", "x realtime");
+
+    bool ok = true;
+    const int64_t t0 = 1700002800000;
+
+    for (const auto& w : workloads) {
+        const std::string path = "bench_telemetry.db";
+        removeFiles(path);
+
+        TelemetryStore store;
+        if (!store.open(path)) {
+            std::printf("open failed: %s\n", store.lastError().c_str());
+            return 1;
+        }
+
+        using Clock = std::chrono::steady_clock;
+        Clock::duration ingestTime{};
+        auto start = Clock::now();
+
+        for (int s = 0; s < w.seconds; ++s) {
+            auto tickStart = Clock::now();
+            for (int d = 0; d < DEVICES; ++d) {
+                TelemetryStore::Sample sample;
+                sample.timestampMs = t0 + s * 1000LL + d;
+                sample.voltage = 24.0 + std::sin(s * 0.01 + d);
+                sample.temperature = 40.0 + (s + d) % 7;
+                sample.frequencyMHz = 30.0 + d * 0.025;
+                sample.signalLevel = (s + d) % 10;
+                sample.transmitting = (s + d) % 5 == 0;
+                store.ingest(names[d], sample);
+            }
+            ingestTime += Clock::now() - tickStart;
+        }
+        store.flush();
+
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        const double samples = static_cast<double>(w.seconds) * DEVICES;
+        const double rate = samples / elapsed;
+        const double ingestNs =
+            std::chrono::duration<double, std::nano>(ingestTime).count() / samples;
+
+        std::printf("%-12s %10.0f %10.2f %14.0f %12.1f %9.0fx\n",
+                    w.name, samples, elapsed, rate, ingestNs, rate / REQUIRED_RATE);
+
+        if (store.samplesWritten() != static_cast<uint64_t>(samples) || rate < REQUIRED_RATE) {
+            ok = false;
+        }
+
+        store.close();
+        removeFiles(path);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file bench_trace.cpp
+ * @brief Cost of a trace event on the calling thread
+ *
+ * Records per-transaction events from one and from four threads with the
+ * drain running, and reports nanoseconds per event. For comparison, the
+ * same loop with tracing disabled.
+ * Exit code is non-zero if an enabled event costs 100 ns or more.
+ */
+
+#include "core/Trace.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rcms;
+
+namespace {
+
+constexpr uint32_t EVENTS = 500000;
+
+// Paced in bursts that fit a ring, as bus threads do between frames
+double nsPerEvent(int threads) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<double> ns(static_cast<size_t>(threads));
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([t, &ns]() {
+            Clock::duration busy{};
+            for (uint32_t i = 0; i < EVENTS; i += 1024) {
+                auto start = Clock::now();
+                for (uint32_t j = i; j < i + 1024; ++j) {
+                    Trace::record(TraceEvent::ModbusTransaction, static_cast<uint32_t>(t + 1),
+                                  0x03, 0x10, j & 0xFFF, 0);
+                }
+                busy += Clock::now() - start;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            ns[static_cast<size_t>(t)] =
+                std::chrono::duration<double, std::nano>(busy).count() / EVENTS;
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    double worst = 0.0;
+    for (double v : ns) {
+        worst = std::max(worst, v);
+    }
+    return worst;
+}
+
+} // anonymous namespace
+
+int main() {
+    const std::string path = "bench_trace.bin";
+
+    const double disabled = nsPerEvent(1);
+
+    Trace::start(path);
+    const double one = nsPerEvent(1);
+    const double four = nsPerEvent(4);
+    Trace::stop();
+
+    std::printf("%-20s %10s\n", "case", "ns/event");
+    std::printf("%-20s %10.1f\n", "disabled", disabled);
+    std::printf("%-20s %10.1f\n", "enabled, 1 thread", one);
+    std::printf("%-20s %10.1f\n", "enabled, 4 threads", four);
+    std::printf("\nwritten %llu, dropped %llu\n",
+                static_cast<unsigned long long>(Trace::written()),
+                static_cast<unsigned long long>(Trace::dropped()));
+
+    std::remove(path.c_str());
+    return (one < 100.0 && four < 100.0) ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file test_alarm_journal.cpp
+ * @brief Unit tests for the SQLite alarm journal
+ */
+
+#include <gtest/gtest.h>
+#include "core/AlarmJournal.h"
+#include <sqlite3.h>
+#include <cstdio>
+#include <string>
+
+using namespace rcms;
+
+class AlarmJournalTest : public ::testing::Test {
+protected:
+    std::string path = ::testing::TempDir() + "rcms_alarm_journal_test.db";
+
+    void SetUp() override { removeFiles(); }
+    void TearDown() override { removeFiles(); }
+
+    void removeFiles() {
+        std::remove(path.c_str());
+        std::remove((path + "-wal").c_str());
+        std::remove((path + "-shm").c_str());
+    }
+
+    static AlarmJournal::Record raised(uint64_t id, uint16_t code) {
+        AlarmJournal::Record r;
+        r.id = id;
+        r.raisedMs = 1700000000000 + static_cast<int64_t>(id);
+        r.deviceName = "Fazan19_1";
+        r.groupId = "ДПК";
+        r.code = code;
+        r.deviceAddress = 1;
+        r.severity = 2;
+        return r;
+    }
+};
+
+// Transitions survive a restart; only outstanding alarms are reloaded
+TEST_F(AlarmJournalTest, ReloadOutstanding) {
+    {
+        AlarmJournal journal;
+        ASSERT_TRUE(journal.open(path)) << journal.lastError();
+
+        journal.recordRaised(raised(1, 0x0101));
+        journal.recordRaised(raised(2, 0x0104));
+        journal.recordRaised(raised(3, 0x0105));
+        journal.recordAcknowledged(1, 1700000001000);
+        journal.recordCleared(1, 1700000002000);    // Done: acked and cleared
+        journal.recordCleared(2, 1700000003000);    // Cleared, not acked
+        journal.close();
+    }
+
+    AlarmJournal journal;
+    ASSERT_TRUE(journal.open(path));
+    EXPECT_EQ(journal.maxId(), 3u);
+
+    auto records = journal.loadOutstanding();
+    ASSERT_EQ(records.size(), 2u);
+
+    EXPECT_EQ(records[0].id, 2u);
+    EXPECT_FALSE(records[0].active());
+    EXPECT_FALSE(records[0].acknowledged());
+    EXPECT_EQ(records[0].code, 0x0104);
+
+    EXPECT_EQ(records[1].id, 3u);
+    EXPECT_TRUE(records[1].active());
+    EXPECT_EQ(records[1].groupId, "ДПК");
+    EXPECT_EQ(records[1].raisedMs, 1700000000003);
+}
+
+// A burst is committed in batches; flush() waits for it
+TEST_F(AlarmJournalTest, BatchedBurst) {
+    AlarmJournal journal;
+    ASSERT_TRUE(journal.open(path));
+
+    const uint64_t count = 2000;
+    for (uint64_t id = 1; id <= count; ++id) {
+        journal.recordRaised(raised(id, 0x0104));
+    }
+    journal.flush();
+
+    EXPECT_EQ(journal.writeFailures(), 0u);
+    EXPECT_EQ(journal.maxId(), count);
+    EXPECT_EQ(journal.loadOutstanding().size(), count);
+
+    for (uint64_t id = 1; id <= count; ++id) {
+        journal.recordAcknowledged(id, 1);
+        journal.recordCleared(id, 2);
+    }
+    journal.flush();
+    EXPECT_TRUE(journal.loadOutstanding().empty());
+}
+
+// Clearing the event log is journalled: nothing before it is reloaded
+TEST_F(AlarmJournalTest, ClearedAll) {
+    {
+        AlarmJournal journal;
+        ASSERT_TRUE(journal.open(path));
+        journal.recordRaised(raised(1, 0x0101));
+        journal.recordRaised(raised(2, 0x0104));
+        journal.recordAcknowledged(2, 1700000001000);
+        journal.recordClearedAll(1700000005000);
+        journal.recordRaised(raised(3, 0x0105));
+        journal.close();
+    }
+
+    AlarmJournal journal;
+    ASSERT_TRUE(journal.open(path));
+    EXPECT_EQ(journal.maxId(), 3u);
+
+    auto records = journal.loadOutstanding();
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].id, 3u);
+    EXPECT_TRUE(records[0].active());
+}
+
+// A failed batch is rolled back as a whole and retried, not half-committed
+TEST_F(AlarmJournalTest, FailedBatchIsRetried) {
+    AlarmJournal journal;
+    ASSERT_TRUE(journal.open(path));
+    journal.recordRaised(raised(1, 0x0101));
+    journal.flush();
+
+    // Another connection holds the write lock: the journal's batch fails
+    sqlite3* blocker = nullptr;
+    ASSERT_EQ(sqlite3_open(path.c_str(), &blocker), SQLITE_OK);
+    ASSERT_EQ(sqlite3_exec(blocker, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr), SQLITE_OK);
+
+    journal.recordAcknowledged(1, 1700000001000);
+    journal.recordRaised(raised(2, 0x0104));
+    journal.flush();
+    EXPECT_EQ(journal.writeFailures(), 1u);     // One transaction, not one per entry
+    EXPECT_EQ(journal.maxId(), 1u);
+
+    sqlite3_exec(blocker, "COMMIT", nullptr, nullptr, nullptr);
+    sqlite3_close(blocker);
+
+    journal.flush();
+    EXPECT_EQ(journal.entriesDropped(), 0u);
+    EXPECT_EQ(journal.maxId(), 2u);
+    auto records = journal.loadOutstanding();
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_TRUE(records[0].acknowledged());
+}
+
+// Closed journal drops transitions instead of blocking
+TEST_F(AlarmJournalTest, NotOpen) {
+    AlarmJournal journal;
+    EXPECT_FALSE(journal.isOpen());
+    journal.recordRaised(raised(1, 0x0101));
+    journal.flush();
+    EXPECT_TRUE(journal.loadOutstanding().empty());
+    EXPECT_EQ(journal.maxId(), 0u);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
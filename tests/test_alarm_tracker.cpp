@@ -0,0 +1,119 @@
+/**
+ * @file test_alarm_tracker.cpp
+ * @brief Unit tests for the edge-triggered alarm tracker
+ */
+
+#include <gtest/gtest.h>
+#include "core/AlarmTracker.h"
+
+using namespace rcms;
+
+namespace {
+int dev1, dev2;     // Device keys
+
+constexpr uint16_t VSWR = 0x0104;
+constexpr uint16_t TEMP = 0x0105;
+
+std::vector<AlarmTracker::Transition> poll(AlarmTracker& tracker, const void* device,
+                                           std::vector<uint16_t> codes) {
+    std::vector<AlarmTracker::Transition> out;
+    tracker.observe(device, codes, out);
+    return out;
+}
+}
+
+// A stuck fault raises once, however long it stays active
+TEST(AlarmTrackerTest, PersistentFaultRaisesOnce) {
+    AlarmTracker tracker;   // raise 2, clear 3
+
+    EXPECT_TRUE(poll(tracker, &dev1, {VSWR}).empty());
+
+    auto edges = poll(tracker, &dev1, {VSWR});
+    ASSERT_EQ(edges.size(), 1u);
+    EXPECT_EQ(edges[0].code, VSWR);
+    EXPECT_EQ(edges[0].edge, AlarmTracker::Edge::Raised);
+
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(poll(tracker, &dev1, {VSWR}).empty());
+    }
+    EXPECT_TRUE(tracker.isRaised(&dev1, VSWR));
+}
+
+// Clearing needs clearCount quiet polls; a relapse restarts the count
+TEST(AlarmTrackerTest, ClearWithHysteresis) {
+    AlarmTracker tracker;
+    poll(tracker, &dev1, {TEMP});
+    poll(tracker, &dev1, {TEMP});
+    ASSERT_TRUE(tracker.isRaised(&dev1, TEMP));
+
+    EXPECT_TRUE(poll(tracker, &dev1, {}).empty());
+    EXPECT_TRUE(poll(tracker, &dev1, {}).empty());
+    EXPECT_TRUE(poll(tracker, &dev1, {TEMP}).empty());     // Relapse
+    EXPECT_TRUE(poll(tracker, &dev1, {}).empty());
+    EXPECT_TRUE(poll(tracker, &dev1, {}).empty());
+
+    auto edges = poll(tracker, &dev1, {});
+    ASSERT_EQ(edges.size(), 1u);
+    EXPECT_EQ(edges[0].edge, AlarmTracker::Edge::Cleared);
+    EXPECT_FALSE(tracker.isRaised(&dev1, TEMP));
+}
+
+// Single-poll glitches never raise; devices are independent
+TEST(AlarmTrackerTest, DebounceAndIsolation) {
+    AlarmTracker tracker;
+
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(poll(tracker, &dev1, {VSWR}).empty());
+        EXPECT_TRUE(poll(tracker, &dev1, {}).empty());
+    }
+    EXPECT_EQ(tracker.raisedCount(&dev1), 0u);
+
+    poll(tracker, &dev2, {VSWR, TEMP});
+    auto edges = poll(tracker, &dev2, {VSWR, TEMP});
+    EXPECT_EQ(edges.size(), 2u);
+    EXPECT_EQ(tracker.raisedCount(&dev2), 2u);
+    EXPECT_FALSE(tracker.isRaised(&dev1, VSWR));
+
+    tracker.remove(&dev2);
+    EXPECT_EQ(tracker.raisedCount(&dev2), 0u);
+}
+
+// raiseCount 1 reports on the first poll
+TEST(AlarmTrackerTest, ImmediateRaise) {
+    AlarmTracker::Config config;
+    config.raiseCount = 1;
+    config.clearCount = 1;
+    AlarmTracker tracker(config);
+
+    EXPECT_EQ(poll(tracker, &dev1, {VSWR}).size(), 1u);
+    auto edges = poll(tracker, &dev1, {TEMP});
+    ASSERT_EQ(edges.size(), 2u);
+    EXPECT_EQ(edges[0].code, VSWR);
+    EXPECT_EQ(edges[0].edge, AlarmTracker::Edge::Cleared);
+    EXPECT_EQ(edges[1].code, TEMP);
+    EXPECT_EQ(edges[1].edge, AlarmTracker::Edge::Raised);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+// Restored alarms: no second raise while active, normal clear once gone
+TEST(AlarmTrackerTest, SeededFromJournal) {
+    AlarmTracker tracker;   // raise 2, clear 3
+    tracker.seed(&dev1, VSWR);
+    tracker.seed(&dev1, TEMP);
+    EXPECT_EQ(tracker.raisedCount(&dev1), 2u);
+
+    for (int i = 0; i < 2; ++i) {
+        EXPECT_TRUE(poll(tracker, &dev1, {VSWR}).empty());
+    }
+    auto edges = poll(tracker, &dev1, {VSWR});
+    ASSERT_EQ(edges.size(), 1u);
+    EXPECT_EQ(edges[0].code, TEMP);
+    EXPECT_EQ(edges[0].edge, AlarmTracker::Edge::Cleared);
+
+    EXPECT_TRUE(tracker.isRaised(&dev1, VSWR));
+    EXPECT_FALSE(tracker.isRaised(&dev1, TEMP));
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include "comm/CRC16.h"
+#include <numeric>
+#include <random>
 
 using namespace rcms;
 
@@ -101,6 +103,99 @@ TEST_F(CRC16Test, Fazan19ReadRegisters) {
     EXPECT_TRUE(CRC16::verify(cmd.data(), cmd.size()));
 }
 
+// All kernels must match the bitwise reference
+TEST_F(CRC16Test, KernelsMatchReference) {
+    std::vector<uint8_t> data(1031);
+    std::iota(data.begin(), data.end(), static_cast<uint8_t>(0x5A));
+
+    const CRC16::Kernel kernels[] = {
+        CRC16::Kernel::Table, CRC16::Kernel::Slice4, CRC16::Kernel::Slice8,
+        CRC16::Kernel::Clmul
+    };
+
+    for (size_t len = 0; len <= data.size(); len += (len < 64 ? 1 : 97)) {
+        uint16_t expected = CRC16::calculateBitwise(data.data(), len);
+        for (auto kernel : kernels) {
+            EXPECT_EQ(CRC16::calculate(kernel, data.data(), len), expected)
+                << CRC16::kernelName(kernel) << ", length " << len;
+        }
+    }
+}
+
+// Incremental update over arbitrary chunks equals one-shot calculation
+TEST_F(CRC16Test, IncrementalUpdate) {
+    std::vector<uint8_t> frame = {0x01, 0x03, 0x38, 0x04, 0xD2, 0x00, 0x07,
+                                  0x01, 0x00, 0x0A, 0x14, 0x00, 0x00, 0x00};
+    uint16_t expected = CRC16::calculate(frame);
+
+    for (size_t split = 0; split <= frame.size(); ++split) {
+        uint16_t crc = CRC16::INITIAL_VALUE;
+        crc = CRC16::update(crc, frame.data(), split);
+        crc = CRC16::update(crc, frame.data() + split, frame.size() - split);
+        EXPECT_EQ(crc, expected) << "split at " << split;
+    }
+}
+
+// Kernel selection affects calculate() but not the result
+TEST_F(CRC16Test, KernelSelection) {
+    std::vector<uint8_t> data = {0x01, 0x03, 0x00, 0x00, 0x00, 0x01};
+    CRC16::Kernel original = CRC16::activeKernel();
+
+    CRC16::setKernel(CRC16::Kernel::Bitwise);
+    EXPECT_EQ(CRC16::activeKernel(), CRC16::Kernel::Bitwise);
+    EXPECT_EQ(CRC16::calculate(data), 0x0A84);
+
+    CRC16::setKernel(CRC16::Kernel::Slice8);
+    EXPECT_EQ(CRC16::calculate(data), 0x0A84);
+
+    CRC16::setKernel(original);
+}
+
+// Property test: every kernel, random data, random lengths and states
+TEST_F(CRC16Test, RandomLengthsMatchReference) {
+    std::mt19937 rng(0xC16);
+    std::uniform_int_distribution<int> byteDist(0, 255);
+    std::uniform_int_distribution<size_t> lenDist(0, 2048);
+
+    const CRC16::Kernel kernels[] = {
+        CRC16::Kernel::Table, CRC16::Kernel::Slice4, CRC16::Kernel::Slice8,
+        CRC16::Kernel::Clmul
+    };
+    const CRC16::Kernel original = CRC16::activeKernel();
+
+    for (int round = 0; round < 500; ++round) {
+        std::vector<uint8_t> data(lenDist(rng));
+        for (auto& b : data) {
+            b = static_cast<uint8_t>(byteDist(rng));
+        }
+
+        const uint16_t expected = CRC16::calculateBitwise(data.data(), data.size());
+        EXPECT_EQ(CRC16::calculate(data), expected) << "length " << data.size();
+
+        // Split point exercises update() with a non-initial state
+        const size_t split = data.empty() ? 0 : rng() % data.size();
+
+        for (auto kernel : kernels) {
+            EXPECT_EQ(CRC16::calculate(kernel, data.data(), data.size()), expected)
+                << CRC16::kernelName(kernel) << ", length " << data.size();
+
+            CRC16::setKernel(kernel);
+            uint16_t crc = CRC16::update(CRC16::INITIAL_VALUE, data.data(), split);
+            crc = CRC16::update(crc, data.data() + split, data.size() - split);
+            EXPECT_EQ(crc, expected)
+                << CRC16::kernelName(kernel) << ", split " << split << "/" << data.size();
+        }
+    }
+
+    CRC16::setKernel(original);
+}
+
+// Best kernel is always runnable
+TEST_F(CRC16Test, BestKernelSupported) {
+    EXPECT_TRUE(CRC16::isSupported(CRC16::bestKernel()));
+    EXPECT_TRUE(CRC16::isSupported(CRC16::Kernel::Bitwise));
+}
+
 int main(int argc, char** argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,83 @@
+/**
+ * @file test_device_snapshot.cpp
+ * @brief Unit tests for DeviceSnapshot and status change masks
+ */
+
+#include <gtest/gtest.h>
+#include "core/StatusDelta.h"
+#include <chrono>
+#include <cstring>
+
+using namespace rcms;
+
+namespace {
+
+DeviceSnapshot makeSnapshot() {
+    DeviceSnapshot s;
+    s.online = true;
+    s.frequencyHz = 124350000;
+    s.voltage24dV = 241;
+    s.temperaturedC = 365;
+    s.signalLevel = 812;
+    s.operatingHours = 1200;
+    s.controlMode = ControlMode::Remote;
+    s.timestampNs = snapshot_clock::nowNs();
+    return s;
+}
+
+} // anonymous namespace
+
+// Copies through signals are plain memory copies
+TEST(DeviceSnapshotTest, CopiesBytewise) {
+    DeviceSnapshot a = makeSnapshot();
+    DeviceSnapshot b;
+    std::memcpy(&b, &a, sizeof(a));
+
+    EXPECT_EQ(diffStatus(a, b), 0u);
+    EXPECT_DOUBLE_EQ(b.frequencyMHz(), 124.35);
+    EXPECT_DOUBLE_EQ(b.voltage24V(), 24.1);
+    EXPECT_DOUBLE_EQ(b.temperature(), 36.5);
+}
+
+TEST(DeviceSnapshotTest, DiffReportsChangedFields) {
+    using namespace status_fields;
+    DeviceSnapshot previous = makeSnapshot();
+    DeviceSnapshot current = previous;
+
+    current.timestampNs += 1000000000;
+    EXPECT_EQ(diffStatus(previous, current), 0u);   // Timestamp alone is not a change
+
+    current.frequencyHz += 8333;
+    current.workMode = WorkMode::Data;
+    current.diagMask = 0x0008;                      // DV1: VSWR
+    EXPECT_EQ(diffStatus(previous, current), Frequency | Mode | ErrorCodes);
+    EXPECT_TRUE(current.hasFaults());
+    EXPECT_EQ(current.diagWord(0), 0x0008);
+    EXPECT_EQ(current.diagWord(1), 0);
+}
+
+// Coalesced updates keep the newest values and every field that changed
+TEST(DeviceSnapshotTest, MergeAccumulatesChanges) {
+    using namespace status_fields;
+    DeviceSnapshot s = makeSnapshot();
+
+    StatusDelta pending{Frequency, s};
+    s.isTransmitting = true;
+    pending.merge(StatusDelta{Transmitting, s});
+
+    EXPECT_EQ(pending.changed, Frequency | Transmitting);
+    EXPECT_TRUE(pending.status.isTransmitting);
+}
+
+TEST(DeviceSnapshotTest, MonotonicTimeMapsToWallClock) {
+    const int64_t wallMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const int64_t mappedMs = snapshot_clock::toEpochMs(snapshot_clock::nowNs());
+
+    EXPECT_NEAR(static_cast<double>(mappedMs), static_cast<double>(wallMs), 50.0);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,311 @@
+/**
+ * @file test_modbus_frame.cpp
+ * @brief Unit tests for fixed-capacity Modbus frames
+ *
+ * Checks request encoding and response parsing against the emulator,
+ * streaming frame assembly, and verifies that the build/parse hot path
+ * performs no heap allocations.
+ */
+
+#include <gtest/gtest.h>
+#include "emulator/Fazan19Emulator.h"
+#include "protocol/ModbusFrame.h"
+#include "protocol/RtuFrameAssembler.h"
+#include "protocol/RtuTiming.h"
+#include "protocol/Fazan19Registers.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace rcms;
+using namespace rcms::test;
+
+// ========== Allocation counting ==========
+
+namespace {
+std::atomic<bool> g_countAllocations{false};
+std::atomic<size_t> g_allocations{0};
+
+// Out of line so the compiler does not pair the inlined free() with new
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void release(void* p) noexcept {
+    std::free(p);
+}
+}
+
+void* operator new(size_t size) {
+    if (g_countAllocations.load(std::memory_order_relaxed)) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    release(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    release(p);
+}
+
+class ModbusFrameTest : public ::testing::Test {
+protected:
+    Fazan19Emulator emulator{1};
+
+    static std::vector<uint8_t> toVector(const ModbusFrame& frame) {
+        return std::vector<uint8_t>(frame.data(), frame.data() + frame.size());
+    }
+
+    static ModbusFrame toFrame(const std::vector<uint8_t>& bytes) {
+        ModbusFrame frame;
+        frame.appendBytes(ByteView(bytes.data(), bytes.size()));
+        return frame;
+    }
+};
+
+// Read request layout and CRC match the known Fazan-19 command
+TEST_F(ModbusFrameTest, ReadRequestEncoding) {
+    auto frame = ModbusFrame::readHoldingRegisters(1, 0x0000, 0x0001);
+
+    ASSERT_EQ(frame.size(), 8u);
+    const uint8_t expected[] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x01, 0x84, 0x0A};
+    for (size_t i = 0; i < frame.size(); ++i) {
+        EXPECT_EQ(frame[i], expected[i]) << "byte " << i;
+    }
+    EXPECT_TRUE(frame.crcValid());
+}
+
+// Write multiple request carries byte count and big-endian values
+TEST_F(ModbusFrameTest, WriteMultipleEncoding) {
+    const uint16_t values[] = {0x1234, 0xABCD};
+    auto frame = ModbusFrame::writeMultipleRegisters(1, 0x0003, values);
+
+    ASSERT_EQ(frame.size(), 7u + 4u + 2u);
+    EXPECT_EQ(frame[1], ModbusFrame::FUNC_WRITE_MULTIPLE);
+    EXPECT_EQ(frame[6], 4);
+    EXPECT_EQ(frame[7], 0x12);
+    EXPECT_EQ(frame[8], 0x34);
+    EXPECT_EQ(frame[9], 0xAB);
+    EXPECT_EQ(frame[10], 0xCD);
+    EXPECT_TRUE(frame.crcValid());
+}
+
+// Frame never grows past the RTU ADU limit
+TEST_F(ModbusFrameTest, CapacityLimit) {
+    ModbusFrame frame;
+    for (size_t i = 0; i < ModbusFrame::MAX_ADU_SIZE; ++i) {
+        ASSERT_TRUE(frame.appendByte(static_cast<uint8_t>(i)));
+    }
+    EXPECT_FALSE(frame.appendByte(0));
+    EXPECT_FALSE(frame.appendCrc());
+    EXPECT_EQ(frame.size(), ModbusFrame::MAX_ADU_SIZE);
+}
+
+// Full status read decoded into a caller-provided array
+TEST_F(ModbusFrameTest, ParseReadHolding) {
+    emulator.setOperatingHours(4321);
+    emulator.setFrequency(121.5);
+
+    const uint16_t count = fazan19::registers::TOTAL_REGISTERS;
+    auto request = ModbusFrame::readHoldingRegisters(1, 0, count);
+    auto response = toFrame(emulator.processRequest(toVector(request)));
+
+    uint16_t regs[fazan19::registers::TOTAL_REGISTERS] = {};
+    auto status = ModbusResponse::parseReadHolding(response.view(), 1, count, regs);
+
+    ASSERT_EQ(status, ModbusResponse::Status::Ok);
+    EXPECT_EQ(regs[fazan19::registers::CountWork], 4321);
+    EXPECT_EQ(regs[fazan19::registers::FrRS], emulator.getRegister(fazan19::registers::FrRS));
+}
+
+// Exception response is reported with its code
+TEST_F(ModbusFrameTest, ParseException) {
+    auto request = ModbusFrame::readHoldingRegisters(1, 0xFF, 1);
+    auto response = toFrame(emulator.processRequest(toVector(request)));
+
+    uint16_t value = 0;
+    auto status = ModbusResponse::parseReadHolding(response.view(), 1, 1, RegisterSpan(&value, 1));
+
+    EXPECT_EQ(status, ModbusResponse::Status::Exception);
+    EXPECT_EQ(ModbusResponse::exceptionCode(response.view()), 0x02);
+}
+
+// Corrupted CRC and short output buffers are rejected
+TEST_F(ModbusFrameTest, ParseErrors) {
+    auto request = ModbusFrame::readHoldingRegisters(1, 0, 4);
+    auto bytes = emulator.processRequest(toVector(request));
+
+    uint16_t small[2] = {};
+    EXPECT_EQ(ModbusResponse::parseReadHolding(toFrame(bytes).view(), 1, 4, small),
+              ModbusResponse::Status::BufferTooSmall);
+
+    uint16_t regs[4] = {};
+    EXPECT_EQ(ModbusResponse::parseReadHolding(toFrame(bytes).view(), 2, 4, regs),
+              ModbusResponse::Status::AddressMismatch);
+
+    bytes[4] ^= 0xFF;
+    EXPECT_EQ(ModbusResponse::parseReadHolding(toFrame(bytes).view(), 1, 4, regs),
+              ModbusResponse::Status::CrcError);
+
+    bytes.resize(6);
+    EXPECT_EQ(ModbusResponse::parseReadHolding(toFrame(bytes).view(), 1, 4, regs),
+              ModbusResponse::Status::TooShort);
+}
+
+// Write echo parsing
+TEST_F(ModbusFrameTest, ParseWriteEcho) {
+    auto request = ModbusFrame::writeSingleRegister(1, fazan19::registers::FrRS, 2580);
+    auto response = toFrame(emulator.processRequest(toVector(request)));
+
+    EXPECT_EQ(ModbusResponse::parseWrite(response.view(), 1, ModbusFrame::FUNC_WRITE_SINGLE),
+              ModbusResponse::Status::Ok);
+    EXPECT_EQ(ModbusResponse::parseWrite(response.view(), 1, ModbusFrame::FUNC_WRITE_MULTIPLE),
+              ModbusResponse::Status::FunctionMismatch);
+}
+
+// Polling hot path: build request, receive, verify CRC, decode - no heap
+TEST_F(ModbusFrameTest, ZeroAllocationTransaction) {
+    const uint16_t count = fazan19::registers::TOTAL_REGISTERS;
+
+    // Device side (emulator allocates) prepared outside the measured region
+    auto wire = emulator.processRequest(toVector(ModbusFrame::readHoldingRegisters(1, 0, count)));
+    ASSERT_FALSE(wire.empty());
+
+    uint16_t regs[fazan19::registers::TOTAL_REGISTERS] = {};
+    int okCount = 0;
+
+    g_allocations = 0;
+    g_countAllocations = true;
+
+    for (int i = 0; i < 1000; ++i) {
+        ModbusFrame request = ModbusFrame::readHoldingRegisters(1, 0, count);
+
+        // Simulate port read straight into the frame buffer
+        ModbusFrame response;
+        for (uint8_t b : wire) {
+            *response.tail() = b;
+            response.grow(1);
+        }
+
+        if (request.crcValid() &&
+            ModbusResponse::parseReadHolding(response.view(), 1, count, regs) ==
+                ModbusResponse::Status::Ok) {
+            ++okCount;
+        }
+
+        const uint16_t values[] = {regs[fazan19::registers::ModTR]};
+        ModbusFrame write = ModbusFrame::writeMultipleRegisters(1, fazan19::registers::ModTR, values);
+        (void)write;
+    }
+
+    g_countAllocations = false;
+
+    EXPECT_EQ(okCount, 1000);
+    EXPECT_EQ(g_allocations.load(), 0u);
+}
+
+// ========== Frame assembler ==========
+
+// Exact length known from the header for normal and exception replies
+TEST_F(ModbusFrameTest, AssemblerFrameLength) {
+    const uint8_t read[] = {0x01, 0x03, 0x08};
+    const uint8_t write[] = {0x01, 0x06};
+    const uint8_t exception[] = {0x01, 0x83};
+    const uint8_t unknown[] = {0x01, 0x2B};
+
+    EXPECT_EQ(RtuFrameAssembler::frameLength(ByteView(read, 2)), 0u);
+    EXPECT_EQ(RtuFrameAssembler::frameLength(read), 3u + 8u + 2u);
+    EXPECT_EQ(RtuFrameAssembler::frameLength(write), ModbusResponse::WRITE_ECHO_LENGTH);
+    EXPECT_EQ(RtuFrameAssembler::frameLength(exception), ModbusResponse::EXCEPTION_LENGTH);
+    EXPECT_EQ(RtuFrameAssembler::frameLength(unknown), 0u);
+}
+
+// Response delivered byte by byte completes exactly at its last byte
+TEST_F(ModbusFrameTest, AssemblerByteByByte) {
+    auto wire = emulator.processRequest(toVector(ModbusFrame::readHoldingRegisters(1, 0, 4)));
+    ASSERT_EQ(wire.size(), ModbusResponse::readHoldingLength(4));
+
+    RtuFrameAssembler assembler;
+    for (size_t i = 0; i < wire.size(); ++i) {
+        EXPECT_FALSE(assembler.isComplete()) << "byte " << i;
+        EXPECT_EQ(assembler.feed(ByteView(&wire[i], 1)), 1u);
+    }
+
+    EXPECT_TRUE(assembler.isComplete());
+    EXPECT_EQ(assembler.wanted(), 0u);
+
+    uint16_t regs[4] = {};
+    EXPECT_EQ(ModbusResponse::parseReadHolding(assembler.frame().view(), 1, 4, regs),
+              ModbusResponse::Status::Ok);
+}
+
+// Exception reply completes at 5 bytes; trailing bytes are not consumed
+TEST_F(ModbusFrameTest, AssemblerException) {
+    auto wire = emulator.processRequest(toVector(ModbusFrame::readHoldingRegisters(1, 0xFF, 1)));
+    ASSERT_EQ(wire.size(), ModbusResponse::EXCEPTION_LENGTH);
+    wire.push_back(0xAA);
+
+    RtuFrameAssembler assembler;
+    EXPECT_EQ(assembler.feed(ByteView(wire.data(), wire.size())), ModbusResponse::EXCEPTION_LENGTH);
+    EXPECT_TRUE(assembler.isComplete());
+    EXPECT_EQ(ModbusResponse::exceptionCode(assembler.frame().view()), 0x02);
+}
+
+// Silence ends unknown-length frames but not truncated known ones
+TEST_F(ModbusFrameTest, AssemblerSilence) {
+    RtuFrameAssembler assembler;
+    const uint8_t unknown[] = {0x01, 0x2B, 0x0E, 0x01};
+    assembler.feed(unknown);
+    EXPECT_EQ(assembler.state(), RtuFrameAssembler::State::Collecting);
+    EXPECT_EQ(assembler.markSilence(), RtuFrameAssembler::State::Complete);
+    EXPECT_EQ(assembler.size(), sizeof(unknown));
+
+    assembler.reset();
+    const uint8_t partial[] = {0x01, 0x03, 0x08, 0x00};
+    assembler.feed(partial);
+    EXPECT_EQ(assembler.markSilence(), RtuFrameAssembler::State::Collecting);
+    EXPECT_TRUE(assembler.isTruncated());
+    EXPECT_EQ(assembler.expectedLength(), 13u);
+
+    // A gap inside the header (adapter latency) does not end the frame
+    assembler.reset();
+    const uint8_t first[] = {0x01};
+    assembler.feed(first);
+    EXPECT_FALSE(assembler.isOpenEnded());
+    EXPECT_EQ(assembler.markSilence(), RtuFrameAssembler::State::Collecting);
+    const uint8_t rest[] = {0x03, 0x02, 0x12, 0x34, 0xB5, 0x33};
+    assembler.feed(rest);
+    EXPECT_EQ(assembler.state(), RtuFrameAssembler::State::Complete);
+}
+
+// ========== Line timing ==========
+
+// t1.5/t3.5 follow the frame format up to 19200 baud, then are fixed
+TEST_F(ModbusFrameTest, RtuTimingFromFrameFormat) {
+    RtuTiming t8n1{9600, 8, false, 1};
+    EXPECT_EQ(t8n1.bitsPerCharacter(), 10);
+    EXPECT_EQ(t8n1.characterNs(), 1041667);
+    EXPECT_EQ(t8n1.t35Ns(), 1041667 * 7 / 2);
+
+    RtuTiming t8e1{9600, 8, true, 1};
+    EXPECT_EQ(t8e1.bitsPerCharacter(), 11);
+    EXPECT_GT(t8e1.t15Ns(), t8n1.t15Ns());
+
+    // 8-byte read request at 9600 8N1 takes ~8.3 ms on the wire
+    EXPECT_EQ(t8n1.transmitNs(8), 1041667 * 8);
+
+    RtuTiming fast{115200, 8, false, 1};
+    EXPECT_EQ(fast.t15Ns(), RtuTiming::FIXED_T15_NS);
+    EXPECT_EQ(fast.t35Ns(), RtuTiming::FIXED_T35_NS);
+    EXPECT_LT(fast.transmitNs(8), 1000000);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
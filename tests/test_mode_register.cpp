@@ -0,0 +1,158 @@
+/**
+ * @file test_mode_register.cpp
+ * @brief Unit tests for serialized MR1 read-modify-write
+ */
+
+#include <gtest/gtest.h>
+#include "protocol/ModeRegisterUpdater.h"
+#include "protocol/Fazan19Registers.h"
+#include <deque>
+
+using namespace rcms;
+using namespace rcms::fazan19;
+
+namespace {
+
+/**
+ * Register behind a bus whose transactions complete only when the test
+ * says so, in order
+ */
+struct FakeBus {
+    uint16_t mr1 = 0;
+    std::deque<std::function<void()>> pending;
+    int reads = 0;
+    int writes = 0;
+    int inFlight = 0;
+    int maxInFlight = 0;
+    bool failReads = false;
+
+    ModeRegisterUpdater makeUpdater() {
+        return ModeRegisterUpdater(
+            [this](ModeRegisterUpdater::ReadDone done) {
+                ++reads;
+                begin();
+                pending.push_back([this, done]() {
+                    --inFlight;
+                    done(!failReads, mr1);
+                });
+            },
+            [this](uint16_t value, ModeRegisterUpdater::Done done) {
+                ++writes;
+                begin();
+                pending.push_back([this, value, done]() {
+                    --inFlight;
+                    mr1 = value;
+                    done(true);
+                });
+            });
+    }
+
+    void begin() {
+        ++inFlight;
+        maxInFlight = std::max(maxInFlight, inFlight);
+    }
+
+    // Complete transactions until the bus is idle
+    void drain() {
+        while (!pending.empty()) {
+            auto next = std::move(pending.front());
+            pending.pop_front();
+            next();
+        }
+    }
+};
+
+} // anonymous namespace
+
+// setPTT racing setSquelch: both bits must survive
+TEST(ModeRegisterTest, OverlappingChangesKeepBothBits) {
+    FakeBus bus;
+    ModeRegisterUpdater updater = bus.makeUpdater();
+
+    int okCount = 0;
+    updater.update(modes::MR1_TX, true, [&](bool ok) { okCount += ok; });
+    updater.update(modes::MR1_SQUELCH, true, [&](bool ok) { okCount += ok; });
+    bus.drain();
+
+    EXPECT_EQ(bus.mr1, modes::MR1_TX | modes::MR1_SQUELCH);
+    EXPECT_EQ(okCount, 2);
+    EXPECT_EQ(bus.maxInFlight, 1);
+    EXPECT_FALSE(updater.busy());
+}
+
+// A burst (squelch spin box steps) is merged into one round after the current one
+TEST(ModeRegisterTest, BurstIsMergedIntoOneRound) {
+    FakeBus bus;
+    bus.mr1 = modes::MR1_TX;
+    ModeRegisterUpdater updater = bus.makeUpdater();
+
+    updater.update(modes::MR1_SQUELCH, true, nullptr);
+    for (int i = 0; i < 10; ++i) {
+        updater.update(modes::MR1_SQUELCH, i % 2 == 0, nullptr);
+    }
+    EXPECT_EQ(updater.queued(), 10u);
+    bus.drain();
+
+    EXPECT_EQ(bus.reads, 2);
+    EXPECT_EQ(bus.writes, 2);
+    EXPECT_EQ(bus.mr1, modes::MR1_TX);     // Last request cleared squelch, PTT untouched
+}
+
+TEST(ModeRegisterTest, FailedReadFailsRoundWithoutWrite) {
+    FakeBus bus;
+    bus.failReads = true;
+    ModeRegisterUpdater updater = bus.makeUpdater();
+
+    bool result = true;
+    updater.update(modes::MR1_TX, true, [&](bool ok) { result = ok; });
+    bus.drain();
+
+    EXPECT_FALSE(result);
+    EXPECT_EQ(bus.writes, 0);
+
+    // Next change starts a fresh round
+    bus.failReads = false;
+    updater.update(modes::MR1_TX, true, [&](bool ok) { result = ok; });
+    bus.drain();
+    EXPECT_TRUE(result);
+    EXPECT_EQ(bus.mr1, modes::MR1_TX);
+}
+
+// Connection closed mid-round: the read never completes, reset() unblocks
+TEST(ModeRegisterTest, ResetAbandonsStuckRound) {
+    FakeBus bus;
+    ModeRegisterUpdater updater = bus.makeUpdater();
+
+    int failed = 0;
+    updater.update(modes::MR1_TX, true, [&](bool ok) { failed += !ok; });
+    updater.update(modes::MR1_SQUELCH, true, [&](bool ok) { failed += !ok; });
+    EXPECT_TRUE(updater.busy());
+
+    auto lost = std::move(bus.pending);     // Completions dropped with the connection
+    bus.pending.clear();
+    bus.inFlight = 0;
+    updater.reset();
+    EXPECT_EQ(failed, 2);
+    EXPECT_FALSE(updater.busy());
+    EXPECT_EQ(updater.queued(), 0u);
+
+    bool result = false;
+    updater.update(modes::MR1_TX, true, [&](bool ok) { result = ok; });
+    bus.drain();
+    EXPECT_TRUE(result);
+    EXPECT_EQ(bus.mr1, modes::MR1_TX);
+
+    // A late completion of the abandoned round changes nothing
+    const int writes = bus.writes;
+    for (auto& completion : lost) {
+        completion();
+    }
+    bus.drain();
+    EXPECT_EQ(bus.writes, writes);
+    EXPECT_EQ(failed, 2);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
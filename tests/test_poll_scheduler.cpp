@@ -0,0 +1,162 @@
+/**
+ * @file test_poll_scheduler.cpp
+ * @brief Unit tests for the deadline-based poll scheduler
+ */
+
+#include <gtest/gtest.h>
+#include "core/PollScheduler.h"
+#include <limits>
+
+using namespace rcms;
+
+namespace {
+int a, b, c;    // Device keys
+
+std::vector<PollScheduler::Task> due(PollScheduler& s, int64_t now) {
+    std::vector<PollScheduler::Task> tasks;
+    s.takeDue(now, tasks);
+    return tasks;
+}
+
+PollScheduler::Config noJitter() {
+    PollScheduler::Config config;
+    config.jitter = 0.0;
+    return config;
+}
+}
+
+// Each device keeps its own interval
+TEST(PollSchedulerTest, PerDeviceCadence) {
+    PollScheduler s(noJitter());
+    s.add(&a, 100, 0);
+    s.add(&b, 0, 0);        // Default 1000 ms
+
+    EXPECT_EQ(due(s, 0).size(), 2u);
+    EXPECT_TRUE(due(s, 0).empty());     // Both in flight
+
+    s.complete(&a, true, 20);
+    s.complete(&b, true, 20);
+    EXPECT_EQ(s.deadline(&a), 100);     // Anchored to the previous deadline
+    EXPECT_EQ(s.deadline(&b), 1000);
+    EXPECT_EQ(s.nextDeadline(), 100);
+
+    auto tasks = due(s, 100);
+    ASSERT_EQ(tasks.size(), 1u);
+    EXPECT_EQ(tasks[0].key, &a);
+    EXPECT_EQ(tasks[0].action, PollScheduler::Action::Poll);
+
+    // Slow answer: missed slots are skipped, not burst
+    s.complete(&a, true, 450);
+    EXPECT_EQ(s.deadline(&a), 550);
+}
+
+// Backoff doubles up to the ceiling and stays inside the jitter bounds
+TEST(PollSchedulerTest, BackoffGrowth) {
+    PollScheduler::Config config;
+    config.maxBackoffMs = 8000;
+    config.failuresBeforeBackoff = 2;
+    config.jitter = 0.2;
+    PollScheduler s(config, 42);
+    s.add(&a, 1000, 0);
+
+    int64_t now = 0;
+    due(s, now);
+    s.complete(&a, false, now);
+    EXPECT_FALSE(s.isBackedOff(&a));
+    EXPECT_EQ(s.deadline(&a), 1000);    // First failure: plain retry
+
+    const int64_t expected[] = {2000, 4000, 8000, 8000};
+    for (int64_t base : expected) {
+        now = s.deadline(&a);
+        auto tasks = due(s, now);
+        ASSERT_EQ(tasks.size(), 1u);
+        s.complete(&a, false, now);
+
+        EXPECT_TRUE(s.isBackedOff(&a));
+        const int64_t delay = s.deadline(&a) - now;
+        EXPECT_GE(delay, base * 8 / 10);
+        EXPECT_LE(delay, base * 12 / 10);
+    }
+    EXPECT_EQ(s.failures(&a), 5);
+}
+
+// A backed-off device is probed; a probe answer triggers a full poll now
+TEST(PollSchedulerTest, ProbeAfterBackoff) {
+    PollScheduler::Config config = noJitter();
+    config.failuresBeforeBackoff = 1;
+    PollScheduler s(config);
+    s.add(&a, 500, 0);
+
+    due(s, 0);
+    s.complete(&a, false, 0);
+    ASSERT_TRUE(s.isBackedOff(&a));
+    EXPECT_EQ(s.deadline(&a), 1000);
+
+    auto tasks = due(s, 1000);
+    ASSERT_EQ(tasks.size(), 1u);
+    EXPECT_EQ(tasks[0].action, PollScheduler::Action::Probe);
+
+    s.complete(&a, true, 1010);
+    EXPECT_FALSE(s.isBackedOff(&a));
+    EXPECT_EQ(s.failures(&a), 0);
+
+    tasks = due(s, 1010);
+    ASSERT_EQ(tasks.size(), 1u);
+    EXPECT_EQ(tasks[0].action, PollScheduler::Action::Poll);
+}
+
+// Dead devices never shift the cadence of live ones
+TEST(PollSchedulerTest, DeadDeviceIsolation) {
+    PollScheduler s(noJitter());
+    s.add(&a, 100, 0);
+    s.add(&b, 100, 0);
+    s.add(&c, 100, 0);
+
+    int polledA = 0;
+    for (int64_t now = 0; now < 10000; now = s.nextDeadline()) {
+        for (const auto& task : due(s, now)) {
+            bool alive = task.key == &a;
+            polledA += alive;
+            s.complete(task.key, alive, now);
+        }
+    }
+
+    EXPECT_EQ(polledA, 100);
+    EXPECT_TRUE(s.isBackedOff(&b));
+    EXPECT_TRUE(s.isBackedOff(&c));
+
+    s.remove(&b);
+    EXPECT_FALSE(s.contains(&b));
+}
+
+// A poll lost with a closed connection doesn't stall the device
+TEST(PollSchedulerTest, ResetReleasesLostPoll) {
+    PollScheduler s(noJitter());
+    s.add(&a, 100, 0);
+    s.add(&b, 100, 0);
+
+    for (int i = 0; i < 3; ++i) {
+        for (const auto& task : due(s, s.nextDeadline())) {
+            s.complete(task.key, task.key == &a, s.deadline(task.key));
+        }
+    }
+    ASSERT_TRUE(s.isBackedOff(&b));
+
+    EXPECT_EQ(due(s, 1000).size(), 2u);     // Both in flight; no complete() will come
+    EXPECT_EQ(s.nextDeadline(), std::numeric_limits<int64_t>::max());
+
+    s.reset(&a, 1000);
+    s.reset(&b, 1000);
+    EXPECT_EQ(s.nextDeadline(), 1000);
+    EXPECT_EQ(s.failures(&b), 0);
+
+    auto tasks = due(s, 1000);
+    ASSERT_EQ(tasks.size(), 2u);
+    EXPECT_EQ(tasks[0].action, PollScheduler::Action::Poll);    // Not a probe
+    EXPECT_EQ(tasks[1].action, PollScheduler::Action::Poll);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
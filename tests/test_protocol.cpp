@@ -9,6 +9,7 @@
 #include <gtest/gtest.h>
 #include "emulator/Fazan19Emulator.h"
 #include "protocol/Fazan19Registers.h"
+#include "protocol/ReadPlan.h"
 #include "comm/CRC16.h"
 #include <cmath>
 
@@ -206,6 +207,61 @@ TEST_F(ProtocolTest, TimeoutBehavior) {
     EXPECT_TRUE(response.empty());  // Simulates timeout
 }
 
+// Read planner merges small gaps and keeps large ones as separate requests
+TEST_F(ProtocolTest, ReadPlanMerge) {
+    using fazan19::tiers::bit;
+    using fazan19::tiers::range;
+
+    EXPECT_TRUE(ReadPlan::build(0, 10).empty());
+
+    auto plan = ReadPlan::build(bit(0) | bit(2) | range(10, 3), 1);
+    ASSERT_EQ(plan.size, 2u);
+    EXPECT_EQ(plan[0].start, 0);
+    EXPECT_EQ(plan[0].count, 3);        // Register 1 read through
+    EXPECT_EQ(plan[1].start, 10);
+    EXPECT_EQ(plan[1].count, 3);
+
+    plan = ReadPlan::build(range(0, 32), 0);
+    ASSERT_EQ(plan.size, 1u);
+    EXPECT_EQ(plan[0].count, 32);
+}
+
+// Fast tier costs fewer wire bytes than a full read; tier reads
+// reassemble the same register image as one full read
+TEST_F(ProtocolTest, TieredPollingPlan) {
+    using namespace fazan19;
+
+    EXPECT_EQ(tiers::FAST & tiers::SLOW, 0u);
+    EXPECT_TRUE(tiers::FAST & tiers::bit(registers::DiagVUU + 3));
+
+    auto fast = ReadPlan::build(tiers::FAST, tiers::MERGE_GAP_REGISTERS);
+    auto full = ReadPlan::build(tiers::range(0, registers::TOTAL_REGISTERS), 0);
+    EXPECT_LT(fast.wireBytes(), full.wireBytes());
+
+    emulator.setFrequency(121.5);
+    emulator.setError(fazan19::errors::DV1_PLL_UNLOCK, 0, 0, 0);
+
+    std::vector<uint16_t> expected;
+    ASSERT_TRUE(parseReadResponse(
+        emulator.processRequest(buildReadRequest(1, 0, registers::TOTAL_REGISTERS)), expected));
+
+    std::vector<uint16_t> image(registers::TOTAL_REGISTERS, 0);
+    auto plan = ReadPlan::build(tiers::FAST | tiers::SLOW, tiers::MERGE_GAP_REGISTERS);
+    for (const ReadBlock& block : plan) {
+        std::vector<uint16_t> values;
+        ASSERT_TRUE(parseReadResponse(
+            emulator.processRequest(buildReadRequest(1, block.start, block.count)), values));
+        ASSERT_EQ(values.size(), block.count);
+        std::copy(values.begin(), values.end(), image.begin() + block.start);
+    }
+
+    for (uint16_t reg = 0; reg < registers::TOTAL_REGISTERS; ++reg) {
+        if ((tiers::FAST | tiers::SLOW) & tiers::bit(reg)) {
+            EXPECT_EQ(image[reg], expected[reg]) << "register " << reg;
+        }
+    }
+}
+
 int main(int argc, char** argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,232 @@
+/**
+ * @file test_telemetry_archive.cpp
+ * @brief Unit tests for the columnar telemetry archive
+ */
+
+#include <gtest/gtest.h>
+#include "core/TelemetryArchive.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace rcms;
+
+class TelemetryArchiveTest : public ::testing::Test {
+protected:
+    std::string path = ::testing::TempDir() + "rcms_telemetry_archive_test.rta";
+
+    static constexpr int64_t T0 = 1700000000000;
+
+    // Long enough that only SEGMENT_SAMPLES ends a segment
+    static constexpr int64_t COUNT_ONLY_MS = 2 * TelemetryArchive::SEGMENT_SAMPLES * 1000LL;
+
+    void SetUp() override { std::remove(path.c_str()); }
+    void TearDown() override { std::remove(path.c_str()); }
+
+    // 1 Hz with a little jitter, slowly drifting ADC values
+    static TelemetryArchive::Sample sample(int i) {
+        TelemetryArchive::Sample s;
+        s.timestampMs = T0 + i * 1000LL + (i % 3);
+        s.voltage = 24.0 + (i / 600) * 0.1;
+        s.temperature = 35.0 + (i % 100) * 0.25;
+        s.frequencyMHz = 31.250;
+        s.signalLevel = 100 + (i % 7) - 3;
+        s.transmitting = (i / 10) % 4 == 0;
+        return s;
+    }
+
+    void flipByte(size_t offset) {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(static_cast<std::streamoff>(offset));
+        char byte = 0;
+        file.read(&byte, 1);
+        byte = static_cast<char>(byte ^ 0x5A);
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(&byte, 1);
+    }
+
+    static void fill(TelemetryArchive& archive, const std::string& device, int count) {
+        for (int i = 0; i < count; ++i) {
+            archive.append(device, sample(i));
+        }
+    }
+};
+
+// Every field decodes bit-exact, across segments and the unsealed tail
+TEST_F(TelemetryArchiveTest, RoundTrip) {
+    const int count = 2 * TelemetryArchive::SEGMENT_SAMPLES + 500;
+    {
+        TelemetryArchive archive;
+        ASSERT_TRUE(archive.open(path)) << archive.lastError();
+        archive.setMaxPendingMs(COUNT_ONLY_MS);
+        fill(archive, "Fazan19_1", count);
+        ASSERT_TRUE(archive.flush());
+        EXPECT_EQ(archive.segmentCount(), 2u);
+
+        int i = 0;
+        archive.scan("Fazan19_1", T0, T0 + count * 1000LL, [&](const TelemetryArchive::Sample& s) {
+            const auto expected = sample(i++);
+            EXPECT_EQ(s.timestampMs, expected.timestampMs);
+            EXPECT_EQ(s.voltage, expected.voltage);
+            EXPECT_EQ(s.temperature, expected.temperature);
+            EXPECT_EQ(s.frequencyMHz, expected.frequencyMHz);
+            EXPECT_EQ(s.signalLevel, expected.signalLevel);
+            EXPECT_EQ(s.transmitting, expected.transmitting);
+        });
+        EXPECT_EQ(i, count);
+
+        // Far below the 41 bytes of a raw row per sample
+        EXPECT_LT(archive.fileSize(), 2u * TelemetryArchive::SEGMENT_SAMPLES * 8);
+    }
+
+    // Reopened: the tail was sealed on close
+    TelemetryArchive archive;
+    ASSERT_TRUE(archive.open(path)) << archive.lastError();
+    EXPECT_EQ(archive.segmentCount(), 3u);
+    size_t visited = archive.scan("Fazan19_1", T0, T0 + count * 1000LL,
+                                  [](const TelemetryArchive::Sample&) {});
+    EXPECT_EQ(visited, static_cast<size_t>(count));
+}
+
+// Range scans touch only overlapping segments; whole segments are
+// summarized from the index
+TEST_F(TelemetryArchiveTest, RangeUsesSegmentIndex) {
+    TelemetryArchive archive;
+    ASSERT_TRUE(archive.open(path)) << archive.lastError();
+    archive.setMaxPendingMs(COUNT_ONLY_MS);
+    fill(archive, "Fazan19_1", 4 * TelemetryArchive::SEGMENT_SAMPLES);
+    fill(archive, "Fazan19_2", TelemetryArchive::SEGMENT_SAMPLES);
+    ASSERT_TRUE(archive.flush());
+
+    const int64_t hour = TelemetryArchive::SEGMENT_SAMPLES * 1000LL;
+    auto third = archive.segments("Fazan19_1", T0 + 2 * hour + 10000, T0 + 2 * hour + 20000);
+    ASSERT_EQ(third.size(), 1u);
+    EXPECT_LE(third[0].firstMs, T0 + 2 * hour);
+
+    EXPECT_TRUE(archive.segments("Fazan19_1", T0 + 10 * hour, T0 + 11 * hour).empty());
+    EXPECT_TRUE(archive.segments("Unknown", T0, T0 + hour).empty());
+
+    // Second half of segment 0, segments 1-2 whole, start of segment 3
+    auto summary = archive.summarize("Fazan19_1", TelemetryArchive::Metric::Temperature,
+                                     T0 + hour / 2, T0 + 3 * hour + 60000);
+    EXPECT_EQ(summary.segmentsDecoded, 2u);
+    EXPECT_DOUBLE_EQ(summary.min, 35.0);
+    EXPECT_DOUBLE_EQ(summary.max, 35.0 + 99 * 0.25);
+
+    uint64_t expected = 0;
+    double sum = 0.0;
+    archive.scan("Fazan19_1", T0 + hour / 2, T0 + 3 * hour + 60000,
+                 [&](const TelemetryArchive::Sample& s) {
+        ++expected;
+        sum += s.temperature;
+    });
+    EXPECT_EQ(summary.count, expected);
+    EXPECT_NEAR(summary.avg, sum / expected, 1e-9);
+}
+
+// A segment cut short by a crash is dropped and appends continue after
+// the last good one
+TEST_F(TelemetryArchiveTest, TornTailIsTruncated) {
+    size_t goodSize = 0;
+    {
+        TelemetryArchive archive;
+        ASSERT_TRUE(archive.open(path)) << archive.lastError();
+        archive.setMaxPendingMs(COUNT_ONLY_MS);
+        fill(archive, "Fazan19_1", TelemetryArchive::SEGMENT_SAMPLES);
+        ASSERT_TRUE(archive.flush());
+        goodSize = archive.fileSize();
+    }
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        const char garbage[100] = {'R', 'T', 'A', 'S'};
+        out.write(garbage, sizeof(garbage));
+    }
+
+    TelemetryArchive archive;
+    ASSERT_TRUE(archive.open(path)) << archive.lastError();
+    EXPECT_EQ(archive.segmentCount(), 1u);
+    EXPECT_EQ(archive.fileSize(), goodSize);
+
+    archive.append("Fazan19_1", sample(TelemetryArchive::SEGMENT_SAMPLES));
+    ASSERT_TRUE(archive.sealAll());
+    archive.close();
+
+    ASSERT_TRUE(archive.open(path)) << archive.lastError();
+    EXPECT_EQ(archive.segmentCount(), 2u);
+}
+
+// One damaged segment in the middle is skipped; the ones after it stay
+TEST_F(TelemetryArchiveTest, CorruptSegmentIsSkipped) {
+    size_t firstSize = 0;
+    size_t totalSize = 0;
+    {
+        TelemetryArchive archive;
+        ASSERT_TRUE(archive.open(path)) << archive.lastError();
+        archive.setMaxPendingMs(COUNT_ONLY_MS);
+        fill(archive, "Fazan19_1", TelemetryArchive::SEGMENT_SAMPLES);
+        ASSERT_TRUE(archive.flush());
+        firstSize = archive.fileSize();
+        for (int i = 0; i < 2 * static_cast<int>(TelemetryArchive::SEGMENT_SAMPLES); ++i) {
+            archive.append("Fazan19_1", sample(TelemetryArchive::SEGMENT_SAMPLES + i));
+        }
+        ASSERT_TRUE(archive.flush());
+        totalSize = archive.fileSize();
+    }
+    flipByte(firstSize / 2);    // Inside the first segment's columns
+
+    TelemetryArchive archive;
+    ASSERT_TRUE(archive.open(path)) << archive.lastError();
+    EXPECT_EQ(archive.segmentCount(), 2u);
+    EXPECT_EQ(archive.corruptSegments(), 1u);
+    EXPECT_EQ(archive.fileSize(), totalSize);
+}
+
+// A header that can't be trusted fails the open instead of cutting the file
+TEST_F(TelemetryArchiveTest, CorruptHeaderFailsOpen) {
+    size_t totalSize = 0;
+    {
+        TelemetryArchive archive;
+        ASSERT_TRUE(archive.open(path)) << archive.lastError();
+        archive.setMaxPendingMs(COUNT_ONLY_MS);
+        fill(archive, "Fazan19_1", 2 * TelemetryArchive::SEGMENT_SAMPLES);
+        ASSERT_TRUE(archive.flush());
+        totalSize = archive.fileSize();
+    }
+    flipByte(0);                // First segment's magic
+
+    TelemetryArchive archive;
+    EXPECT_FALSE(archive.open(path));
+    EXPECT_NE(archive.lastError().find("offset 0"), std::string::npos);
+
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    EXPECT_EQ(static_cast<size_t>(in.tellg()), totalSize);
+}
+
+// Buffered data is bounded in time: long-lived devices get shorter
+// segments, a device that went quiet is sealed against the others' clock
+TEST_F(TelemetryArchiveTest, TimeLimitSealsShortSegments) {
+    TelemetryArchive archive;
+    ASSERT_TRUE(archive.open(path)) << archive.lastError();
+    archive.setMaxPendingMs(60000);
+
+    fill(archive, "Fazan19_2", 10);
+    fill(archive, "Fazan19_1", 300);
+    ASSERT_TRUE(archive.flush());
+
+    EXPECT_EQ(archive.segments("Fazan19_1", T0, T0 + 300000).size(), 4u);
+    EXPECT_EQ(archive.segments("Fazan19_2", T0, T0 + 300000).size(), 1u);
+    EXPECT_EQ(archive.segmentCount(), 5u);
+
+    // Sealed, in flight or buffered: every sample is visible
+    size_t visited = archive.scan("Fazan19_1", T0, T0 + 300000,
+                                  [](const TelemetryArchive::Sample&) {});
+    EXPECT_EQ(visited, 300u);
+    auto summary = archive.summarize("Fazan19_2", TelemetryArchive::Metric::Voltage,
+                                     T0, T0 + 300000);
+    EXPECT_EQ(summary.count, 10u);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
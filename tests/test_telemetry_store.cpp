@@ -0,0 +1,173 @@
+/**
+ * @file test_telemetry_store.cpp
+ * @brief Unit tests for the telemetry store and its rollups
+ */
+
+#include <gtest/gtest.h>
+#include "core/TelemetryStore.h"
+#include <sqlite3.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using namespace rcms;
+
+class TelemetryStoreTest : public ::testing::Test {
+protected:
+    std::string path = ::testing::TempDir() + "rcms_telemetry_test.db";
+
+    // Start of an hour, so minute and hour buckets line up with the samples
+    static constexpr int64_t T0 = 1700002800000;
+
+    void SetUp() override { removeFiles(); }
+    void TearDown() override { removeFiles(); }
+
+    void removeFiles() {
+        std::remove(path.c_str());
+        std::remove((path + "-wal").c_str());
+        std::remove((path + "-shm").c_str());
+    }
+
+    static TelemetryStore::Sample sample(int64_t timeMs, double voltage, bool tx = false) {
+        TelemetryStore::Sample s;
+        s.timestampMs = timeMs;
+        s.voltage = voltage;
+        s.temperature = 40.0;
+        s.frequencyMHz = 30.0;
+        s.signalLevel = 5;
+        s.transmitting = tx;
+        return s;
+    }
+};
+
+TEST_F(TelemetryStoreTest, RawSamplesRoundTrip) {
+    TelemetryStore store;
+    ASSERT_TRUE(store.open(path)) << store.lastError();
+
+    for (int i = 0; i < 10; ++i) {
+        store.ingest("Fazan19_1", sample(T0 + i * 1000, 24.0 + i));
+    }
+    store.flush();
+    EXPECT_EQ(store.samplesWritten(), 10u);
+
+    auto points = store.query("Fazan19_1", TelemetryStore::Metric::Voltage,
+                              T0 + 2000, T0 + 5000, TelemetryStore::Resolution::Raw);
+    ASSERT_EQ(points.size(), 4u);
+    EXPECT_EQ(points[0].timeMs, T0 + 2000);
+    EXPECT_DOUBLE_EQ(points[0].avg, 26.0);
+    EXPECT_DOUBLE_EQ(points[3].avg, 29.0);
+
+    EXPECT_TRUE(store.query("Unknown", TelemetryStore::Metric::Voltage,
+                            T0, T0 + 10000, TelemetryStore::Resolution::Raw).empty());
+}
+
+// Minute buckets: closed and still-open buckets are both queryable
+TEST_F(TelemetryStoreTest, MinuteRollups) {
+    TelemetryStore store;
+    ASSERT_TRUE(store.open(path)) << store.lastError();
+
+    // Two full minutes at 1 Hz and 10 s into the third
+    for (int i = 0; i < 130; ++i) {
+        store.ingest("Fazan19_1", sample(T0 + i * 1000, i % 60, i % 4 == 0));
+    }
+    store.flush();
+
+    auto voltage = store.query("Fazan19_1", TelemetryStore::Metric::Voltage,
+                               T0, T0 + 3 * 60000, TelemetryStore::Resolution::Minute);
+    ASSERT_EQ(voltage.size(), 3u);
+    EXPECT_EQ(voltage[0].timeMs, T0);
+    EXPECT_EQ(voltage[0].count, 60u);
+    EXPECT_DOUBLE_EQ(voltage[0].min, 0.0);
+    EXPECT_DOUBLE_EQ(voltage[0].max, 59.0);
+    EXPECT_DOUBLE_EQ(voltage[0].avg, 29.5);
+    EXPECT_EQ(voltage[2].count, 10u);
+    EXPECT_DOUBLE_EQ(voltage[2].max, 9.0);
+
+    // TX averages to the duty cycle
+    auto tx = store.query("Fazan19_1", TelemetryStore::Metric::Transmitting,
+                          T0, T0 + 60000, TelemetryStore::Resolution::Minute);
+    ASSERT_FALSE(tx.empty());
+    EXPECT_DOUBLE_EQ(tx[0].avg, 0.25);
+
+    auto hour = store.query("Fazan19_1", TelemetryStore::Metric::Voltage,
+                            T0, T0 + 3600000, TelemetryStore::Resolution::Hour);
+    ASSERT_EQ(hour.size(), 1u);
+    EXPECT_EQ(hour[0].count, 130u);
+}
+
+// An open bucket continues across a restart instead of being overwritten
+TEST_F(TelemetryStoreTest, OpenBucketSurvivesRestart) {
+    const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const int64_t hour = now - now % 3600000;
+
+    {
+        TelemetryStore store;
+        ASSERT_TRUE(store.open(path)) << store.lastError();
+        store.ingest("Fazan19_1", sample(hour, 10.0));
+        store.ingest("Fazan19_1", sample(hour + 1, 20.0));
+    }
+    {
+        TelemetryStore store;
+        ASSERT_TRUE(store.open(path)) << store.lastError();
+        store.ingest("Fazan19_1", sample(hour + 2, 30.0));
+        store.flush();
+
+        auto points = store.query("Fazan19_1", TelemetryStore::Metric::Voltage,
+                                  hour, hour + 3600000, TelemetryStore::Resolution::Hour);
+        ASSERT_EQ(points.size(), 1u);
+        EXPECT_EQ(points[0].count, 3u);
+        EXPECT_DOUBLE_EQ(points[0].min, 10.0);
+        EXPECT_DOUBLE_EQ(points[0].max, 30.0);
+        EXPECT_DOUBLE_EQ(points[0].avg, 20.0);
+    }
+}
+
+// Rows of a failed write are kept and written later, not counted as written
+TEST_F(TelemetryStoreTest, FailedWriteIsRetried) {
+    TelemetryStore::Config config;
+    config.flushIntervalMs = 20;
+    config.maxRetainedSamples = 8;
+
+    TelemetryStore store;
+    ASSERT_TRUE(store.open(path, config)) << store.lastError();
+    store.ingest("Fazan19_1", sample(T0, 24.0));
+    store.flush();
+    ASSERT_EQ(store.samplesWritten(), 1u);
+
+    // Another connection holds the write lock: the store's commit fails
+    sqlite3* blocker = nullptr;
+    ASSERT_EQ(sqlite3_open(path.c_str(), &blocker), SQLITE_OK);
+    ASSERT_EQ(sqlite3_exec(blocker, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr), SQLITE_OK);
+
+    for (int i = 1; i <= 10; ++i) {
+        store.ingest("Fazan19_1", sample(T0 + i * 1000, 24.0 + i));
+    }
+    store.flush();
+    EXPECT_GE(store.writeFailures(), 1u);
+    EXPECT_EQ(store.samplesWritten(), 1u);
+    EXPECT_EQ(store.samplesDropped(), 2u);     // 10 pending, 8 retained
+
+    sqlite3_exec(blocker, "COMMIT", nullptr, nullptr, nullptr);
+    sqlite3_close(blocker);
+
+    store.flush();
+    EXPECT_EQ(store.samplesWritten(), 9u);
+    EXPECT_EQ(store.samplesWritten() + store.samplesDropped(), store.ingested());
+
+    auto points = store.query("Fazan19_1", TelemetryStore::Metric::Voltage,
+                              T0, T0 + 10000, TelemetryStore::Resolution::Raw);
+    ASSERT_EQ(points.size(), 9u);
+    EXPECT_DOUBLE_EQ(points[1].avg, 27.0);     // Oldest unwritten ones dropped
+}
+
+TEST(TelemetryResolution, PicksCoarserForLongSpans) {
+    EXPECT_EQ(TelemetryStore::resolutionFor(3600000), TelemetryStore::Resolution::Raw);
+    EXPECT_EQ(TelemetryStore::resolutionFor(24LL * 3600000), TelemetryStore::Resolution::Minute);
+    EXPECT_EQ(TelemetryStore::resolutionFor(90LL * 24 * 3600000), TelemetryStore::Resolution::Hour);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,160 @@
+/**
+ * @file test_trace.cpp
+ * @brief Unit tests for binary event tracing
+ */
+
+#include <gtest/gtest.h>
+#include "core/Trace.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rcms;
+
+class TraceTest : public ::testing::Test {
+protected:
+    std::string path = ::testing::TempDir() + "rcms_trace_test.bin";
+
+    void TearDown() override {
+        Trace::stop();
+        std::remove(path.c_str());
+        for (int n = 1; n <= 4; ++n) {
+            std::remove((path + "." + std::to_string(n)).c_str());
+        }
+    }
+
+    void produce(uint32_t count) {
+        std::thread producer([count]() {
+            for (uint32_t i = 0; i < count; ++i) {
+                Trace::record(TraceEvent::DevicePoll, 1, 2, 40, i, 1);
+                if (i % 1000 == 999) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(Trace::DRAIN_INTERVAL_MS));
+                }
+            }
+        });
+        producer.join();
+    }
+};
+
+// Events from several threads come back complete and in time order
+TEST_F(TraceTest, RecordsFromThreads) {
+    ASSERT_TRUE(Trace::start(path));
+
+    constexpr uint32_t PER_THREAD = 1000;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < 3; ++t) {
+        threads.emplace_back([t]() {
+            for (uint32_t i = 0; i < PER_THREAD; ++i) {
+                Trace::record(TraceEvent::ModbusTransaction, t + 1, 0x03, 0x10, i, 0);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    Trace::stop();
+
+    EXPECT_EQ(Trace::dropped(), 0u);
+    EXPECT_EQ(Trace::written(), 3 * PER_THREAD);
+
+    Trace::FileHeader header;
+    std::vector<TraceRecord> records;
+    ASSERT_TRUE(Trace::readFile(path, header, records));
+    ASSERT_EQ(records.size(), 3 * PER_THREAD);
+
+    std::vector<uint32_t> nextSeq(4, 0);
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (i > 0) {
+            EXPECT_LE(records[i - 1].timeNs, records[i].timeNs);
+        }
+        const uint32_t device = records[i].args[0];
+        ASSERT_GE(device, 1u);
+        ASSERT_LE(device, 3u);
+        EXPECT_EQ(records[i].args[3], nextSeq[device]++);   // Per-thread order kept
+    }
+}
+
+// A full ring drops and counts instead of blocking the caller
+TEST_F(TraceTest, FullRingDrops) {
+    ASSERT_TRUE(Trace::start(path));
+
+    const uint32_t burst = trace_detail::RING_RECORDS * 3;
+    std::thread producer([burst]() {
+        for (uint32_t i = 0; i < burst; ++i) {
+            Trace::record(TraceEvent::DevicePoll, 1, 2, 40, 0, 1);
+        }
+    });
+    producer.join();
+    Trace::stop();
+
+    EXPECT_GT(Trace::dropped(), 0u);
+    EXPECT_EQ(Trace::written() + Trace::dropped(), burst);
+}
+
+// A new session keeps the previous file instead of truncating it
+TEST_F(TraceTest, PreviousSessionKept) {
+    ASSERT_TRUE(Trace::start(path));
+    produce(10);
+    Trace::stop();
+    ASSERT_TRUE(Trace::start(path));
+    produce(20);
+    Trace::stop();
+
+    Trace::FileHeader header;
+    std::vector<TraceRecord> records;
+    ASSERT_TRUE(Trace::readFile(path, header, records));
+    EXPECT_EQ(records.size(), 20u);
+    ASSERT_TRUE(Trace::readFile(path + ".1", header, records));
+    EXPECT_EQ(records.size(), 10u);
+}
+
+// Past maxFileSize the trace moves to a new file; at most maxFiles old ones stay
+TEST_F(TraceTest, RotatesAtSizeCap) {
+    Trace::Config config;
+    config.file = path;
+    config.maxFileSize = sizeof(Trace::FileHeader) + 1000 * sizeof(TraceRecord);
+    config.maxFiles = 2;
+    ASSERT_TRUE(Trace::start(config));
+    produce(8000);
+    Trace::stop();
+    ASSERT_EQ(Trace::dropped(), 0u);
+
+    Trace::FileHeader header;
+    std::vector<TraceRecord> records;
+    ASSERT_TRUE(Trace::readFile(path + ".2", header, records));
+    ASSERT_FALSE(records.empty());
+    EXPECT_GT(records.front().args[3], 0u);             // The oldest files were removed
+    uint32_t lastSeq = records.back().args[3];
+    for (const std::string& file : {path + ".1", path}) {
+        ASSERT_TRUE(Trace::readFile(file, header, records)) << file;
+        ASSERT_FALSE(records.empty());
+        EXPECT_EQ(records.front().args[3], lastSeq + 1);    // Nothing lost at a rotation
+        lastSeq = records.back().args[3];
+    }
+    EXPECT_EQ(lastSeq, 7999u);
+    EXPECT_FALSE(Trace::readFile(path + ".3", header, records));
+}
+
+TEST_F(TraceTest, Render) {
+    TraceRecord r{};
+    r.timeNs = 1500000000;
+    r.event = static_cast<uint16_t>(TraceEvent::ModbusTransaction);
+    r.thread = 2;
+    r.args[0] = 5;
+    r.args[1] = 3;
+    r.args[2] = 0x1A;
+    r.args[3] = 1234;
+    r.args[4] = 1;
+    EXPECT_EQ(Trace::render(r),
+              "    1.500000 [2] modbus.transaction: addr=5 fc=0x3 reg=0x1A latency_us=1234 result=1");
+
+    r.event = 999;
+    EXPECT_NE(Trace::render(r).find("event#999"), std::string::npos);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
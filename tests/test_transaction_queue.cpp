@@ -0,0 +1,93 @@
+/**
+ * @file test_transaction_queue.cpp
+ * @brief Unit tests for the priority transaction queue and latency stats
+ */
+
+#include <gtest/gtest.h>
+#include "protocol/TransactionQueue.h"
+#include "core/LatencyStats.h"
+
+using namespace rcms;
+
+// Control commands jump ahead of queued polls; FIFO within a class
+TEST(TransactionQueueTest, PriorityOrder) {
+    TransactionQueue<int> queue;
+    queue.push(1, TransactionPriority::Poll);
+    queue.push(2, TransactionPriority::Poll);
+    queue.push(3, TransactionPriority::Alarm);
+    queue.push(4, TransactionPriority::Control);
+    queue.push(5, TransactionPriority::Control);
+
+    EXPECT_EQ(queue.size(), 5u);
+    EXPECT_EQ(queue.size(TransactionPriority::Control), 2u);
+    EXPECT_EQ(queue.nextPriority(), TransactionPriority::Control);
+
+    EXPECT_EQ(queue.pop(), 4);
+    EXPECT_EQ(queue.pop(), 5);
+    EXPECT_EQ(queue.pop(), 3);
+
+    // Late control command still preempts remaining polls
+    queue.push(6, TransactionPriority::Control);
+    EXPECT_EQ(queue.pop(), 6);
+    EXPECT_EQ(queue.pop(), 1);
+    EXPECT_EQ(queue.pop(), 2);
+    EXPECT_TRUE(queue.empty());
+}
+
+// Cancelling one owner removes its items from every class
+TEST(TransactionQueueTest, RemoveIf) {
+    TransactionQueue<int> queue;
+    for (int i = 0; i < 10; ++i) {
+        queue.push(i, static_cast<TransactionPriority>(i % 3));
+    }
+
+    EXPECT_EQ(queue.removeIf([](int v) { return v % 2 == 0; }), 5u);
+    EXPECT_EQ(queue.size(), 5u);
+
+    while (!queue.empty()) {
+        EXPECT_EQ(queue.pop() % 2, 1);
+    }
+}
+
+// Nearest-rank percentiles over the window
+TEST(LatencyStatsTest, Percentiles) {
+    LatencyStats stats(1000);
+    EXPECT_EQ(stats.percentile(50), 0);
+
+    for (int i = 1; i <= 100; ++i) {
+        stats.record(i);
+    }
+
+    EXPECT_EQ(stats.percentile(50), 50);
+    EXPECT_EQ(stats.percentile(90), 90);
+    EXPECT_EQ(stats.percentile(99), 99);
+    EXPECT_EQ(stats.percentile(100), 100);
+
+    auto summary = stats.summary();
+    EXPECT_EQ(summary.count, 100u);
+    EXPECT_EQ(summary.p50, 50);
+    EXPECT_EQ(summary.p99, 99);
+    EXPECT_EQ(summary.max, 100);
+}
+
+// Window keeps only recent samples; max covers everything since reset
+TEST(LatencyStatsTest, SlidingWindow) {
+    LatencyStats stats(10);
+    stats.record(5000);
+    for (int i = 0; i < 10; ++i) {
+        stats.record(10);
+    }
+
+    EXPECT_EQ(stats.percentile(99), 10);
+    EXPECT_EQ(stats.summary().max, 5000);
+    EXPECT_EQ(stats.count(), 11u);
+
+    stats.reset();
+    EXPECT_EQ(stats.count(), 0u);
+    EXPECT_EQ(stats.summary().max, 0);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
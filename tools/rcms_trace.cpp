@@ -0,0 +1,69 @@
+/**
+ * @file rcms_trace.cpp
+ * @brief Offline decoder for binary trace files (Trace)
+ *
+ * Usage: rcms-trace [--event NAME] FILE
+ * Prints one line per record in time order; --event keeps only records
+ * whose name starts with NAME (e.g. "modbus.").
+ */
+
+#include "core/Trace.h"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+using namespace rcms;
+
+namespace {
+
+void usage() {
+    std::fprintf(stderr, "usage: rcms-trace [--event NAME] FILE\n");
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    std::string path;
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--event") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (argv[i][0] == '-') {
+            usage();
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path.empty()) {
+        usage();
+        return 2;
+    }
+
+    Trace::FileHeader header;
+    std::vector<TraceRecord> records;
+    std::string error;
+    if (!Trace::readFile(path, header, records, &error)) {
+        std::fprintf(stderr, "rcms-trace: %s\n", error.c_str());
+        return 1;
+    }
+
+    const std::time_t start = static_cast<std::time_t>(header.startEpochNs / 1000000000);
+    char started[32];
+    std::strftime(started, sizeof(started), "%Y-%m-%d %H:%M:%S", std::localtime(&start));
+    std::printf("# started %s, %zu records\n", started, records.size());
+
+    for (const TraceRecord& r : records) {
+        if (!filter.empty()) {
+            const Trace::EventInfo* info = Trace::eventInfo(r.event);
+            if (!info || std::strncmp(info->name, filter.c_str(), filter.size()) != 0) {
+                continue;
+            }
+        }
+        std::printf("%s\n", Trace::render(r).c_str());
+    }
+    return 0;
+}